@@ -20,6 +20,31 @@ def print_indented(str, indent=0):
         print(indent_str + line)
 
 
+def read_checkpoint_field(snapshot_dir, name):
+    """Memory map a 2D field from the checkpoint.bin container of a snapshot.
+
+    Returns an array of shape (rings, azimuthal cells) or None if the
+    container does not contain the field.
+    """
+    filename = joinpath(snapshot_dir, "checkpoint.bin")
+    header = np.dtype([("magic", "S8"), ("version", "u4"), ("n_fields", "u4"),
+                       ("n_radial", "u8"), ("n_azimuthal", "u8"),
+                       ("misc", "V48")])
+    entry = np.dtype([("name", "S32"), ("offset", "u8"), ("n_rings", "u8"),
+                      ("checksum", "u8")])
+    head = np.fromfile(filename, dtype=header, count=1)[0]
+    if head["magic"] != b"FCPTCKPT":
+        raise ValueError(f"'{filename}' is not a checkpoint file")
+    table = np.fromfile(filename, dtype=entry, count=head["n_fields"],
+                        offset=header.itemsize)
+    for e in table:
+        if e["name"].decode() == name:
+            return np.memmap(filename, dtype=np.float64, mode="r",
+                             offset=int(e["offset"]),
+                             shape=(int(e["n_rings"]), int(head["n_azimuthal"])))
+    return None
+
+
 def interp_vr(r_data, vr, r_new, kind="cubic"):
     from scipy.interpolate import interp1d
     hu = hasattr(vr, "unit")
@@ -260,14 +285,66 @@ def load_data(filepath):
     return _load_data(filepath, os.path.getmtime(filepath))
 
 
+def monitor_series_filename(filepath):
+    """ Name of the binary monitor series belonging to a text monitor file."""
+    return os.path.splitext(filepath)[0] + ".bin"
+
+
+_monitor_series_header = np.dtype([("magic", "S8"), ("version", "u4"),
+                                   ("n_columns", "u4"), ("header_size", "u8")])
+_monitor_series_column = np.dtype([("name", "S64"), ("unit", "S64")])
+
+
+@lru_cache(20)
+def _load_monitor_series_variables(filepath, timestamp):
+    head = np.fromfile(filepath, dtype=_monitor_series_header, count=1)[0]
+    if head["magic"] != b"FCPTSERI":
+        raise ValueError(f"'{filepath}' is not a monitor series file")
+    columns = np.fromfile(filepath, dtype=_monitor_series_column,
+                          count=head["n_columns"],
+                          offset=_monitor_series_header.itemsize)
+    found_variables = {}
+    for col, c in enumerate(columns):
+        found_variables[c["name"].decode()] = (col, c["unit"].decode())
+    return found_variables, int(head["header_size"]), int(head["n_columns"])
+
+
+@lru_cache(20)
+def _load_monitor_series(filepath, timestamp, size):
+    _, header_size, n_columns = _load_monitor_series_variables(filepath, timestamp)
+    # an incomplete last row is still being written
+    n_rows = (size - header_size) // (8 * n_columns)
+    if n_rows == 0:
+        return np.zeros((n_columns, 0))
+    return np.memmap(filepath, dtype=np.float64, mode="r", offset=header_size,
+                     shape=(n_rows, n_columns)).T
+
+
+def load_monitor_series(filepath):
+    """ Memory map a binary monitor series, one array per column.
+    The map is renewed once the file grows."""
+    return _load_monitor_series(filepath, os.path.getmtime(filepath),
+                                os.path.getsize(filepath))
+
+
 def load_text_data_file(filepath, varname, Nmax=np.inf):
-    # get data
-    variables = load_text_data_variables(filepath)
+    # use the binary monitor series only if there is no text file, i.e. for
+    # MonitorFormat = binary. With MonitorFormat = both the binary series is
+    # written in blocks of MonitorFlushRows rows and lags behind the text file
+    # for a running or crashed simulation.
+    series_filepath = monitor_series_filename(filepath)
+    if (filepath != series_filepath and not os.path.exists(filepath)
+            and os.path.exists(series_filepath)):
+        variables = _load_monitor_series_variables(
+            series_filepath, os.path.getmtime(series_filepath))[0]
+        file_data = load_monitor_series(series_filepath)
+    else:
+        variables = load_text_data_variables(filepath)
+        file_data = load_data(filepath)
     col = int(variables[varname][0])
     unit_str = variables[varname][1]
     unit_str = unit_str.replace("1/s", "s-1")
     unit = Unit(unit_str)
-    file_data = load_data(filepath)
     data = file_data[col] * unit
     if data.isscalar:
         data = Quantity([data])
@@ -730,8 +807,13 @@ class Vars2D:
 
         Nr = info["Nrad"]
         Naz = info["Nazi"]
-        filepath = joinpath(self.output_dir, "snapshots", f"{Nsnapshot}", info["filename"])
-        rv = np.fromfile(filepath).reshape(Nr, Naz) * unit
+        snapshot_dir = joinpath(self.output_dir, "snapshots", f"{Nsnapshot}")
+        filepath = joinpath(snapshot_dir, info["filename"])
+        if os.path.exists(filepath):
+            rv = np.fromfile(filepath).reshape(Nr, Naz) * unit
+        else:
+            field_name = os.path.splitext(info["filename"])[0]
+            rv = np.array(read_checkpoint_field(snapshot_dir, field_name)).reshape(Nr, Naz) * unit
 
         if centered:
             if varname == "vrad":
@@ -1060,7 +1142,7 @@ class Loader:
     def _load_nbody(self):
         for n in range(0,100):
             path = joinpath(self.output_dir, 'monitor', f'nbody{n}.dat')
-            if os.path.exists(path):
+            if os.path.exists(path) or os.path.exists(monitor_series_filename(path)):
                 nbody = Nbody(n, filepath=path)
                 self.nbody.append(nbody)
             else:
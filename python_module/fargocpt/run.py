@@ -35,6 +35,7 @@ Help string from the fargo executable:
 | -n |                   Disable simulation. The program just reads parameters file
 | -m |                   estimate memory usage and print out
 |-N <N> |                Perform N hydro steps
+| --ensemble             Run one simulation per configfile listed in the last argument (one per line)
 
 
 Following are the additional options available through this wrapper, refered to as [wrapper options] in the usage string:
@@ -284,6 +285,25 @@ def run(fargo_args, np=None, nt=None, mpi_verbose=False, stdout=None, stderr=Non
 
     return p.returncode
 
+def run_ensemble(configs, mode="start", np_per_member=1, nt=None, fargo_args=[], **kwargs):
+    """Run several independent simulations inside one MPI job.
+
+    The processes are split evenly among the simulations, each of which needs its own output directory.
+
+    Args:
+        configs (list of str): Paths to the config files, one per simulation.
+        mode (str, optional): Start mode passed to fargo, e.g. 'start', 'restart' or 'auto'. Defaults to "start".
+        np_per_member (int, optional): Number of MPI processes per simulation. Defaults to 1.
+        nt (int, optional): Number of OpenMP threads to start per process.
+        fargo_args (list of str, optional): Additional arguments to be passed to the fargo executable.
+        kwargs: Passed on to `run`.
+    """
+    with tempfile.NamedTemporaryFile(mode="w", suffix=".txt", delete=False) as listfile:
+        for config in configs:
+            print(os.path.abspath(config), file=listfile)
+    args = ["--ensemble"] + fargo_args + [mode, listfile.name]
+    return run(args, np=np_per_member*len(configs), nt=nt, **kwargs)
+
 def print_wrapper(stdout, *args, **kwargs):
     if stdout != subprocess.PIPE:
         print(*args, file=stdout, **kwargs)
@@ -8,55 +8,68 @@ cutoff in the case of the Hill sphere avoidance. The force returned is a
 specific force. It has therefore the dimension of an acceleration (LT^-2).
 **/
 
+#include <array>
 #include <cmath>
 #include <float.h>
 #include <stdio.h>
+#include <vector>
 
 #include "Force.h"
 #include "constants.h"
 #include "global.h"
 #include "parameters.h"
+#include "reduction.h"
 
 /**
-	Computes the acceleration due to the disk on an object at position (x,y)
+	Computes the accelerations due to the disk on all planets at once. Every
+	cell is read once and contributes to all planets, the sums of all
+	planets are combined with a single reduction.
 */
-Pair ComputeDiskOnPlanetAccel(t_data &data, const unsigned int nb)
+std::vector<Pair> ComputeDiskOnPlanetsAccel(t_data &data)
 {
-
 	t_planetary_system & psys = data.get_planetary_system();
-	t_planet & planet = psys.get_planet(nb);
-	const double x = planet.get_x();
-	const double y = planet.get_y();
-	const double a = planet.get_r();
-
-	const double klahr_smoothing_constant = planet.get_cubic_smoothing_factor();
-
+	const unsigned int N_planets = psys.get_number_of_planets();
+
+	// everything that does not depend on the cell
+	struct t_body {
+		double x, y, a;
+		// radius of the Klahr & Kley 2005 smoothing, 0 if disabled
+		double r_sm_klahr;
+		// smoothing length if it does not depend on the cell
+		bool constant_smoothing;
+		double smoothing;
+	};
+	std::vector<t_body> bodies(N_planets);
+	for (unsigned int k = 0; k < N_planets; ++k) {
+		t_planet & planet = psys.get_planet(k);
+		t_body &body = bodies[k];
+		body.x = planet.get_x();
+		body.y = planet.get_y();
+		body.a = planet.get_r();
+
+		body.r_sm_klahr = 0.0;
+		const double klahr_smoothing_constant = planet.get_cubic_smoothing_factor();
+		if (klahr_smoothing_constant > 0.0) {
+			const double l1 = planet.get_dimensionless_roche_radius() *
+				planet.get_distance_to_primary();
+			body.r_sm_klahr = l1 * klahr_smoothing_constant;
+		}
 
-    Pair acceleration;
-    double localaccel[4] = {0., 0., 0., 0.};
-    double globalaccel[4] = {0., 0., 0., 0.};
-    double axi, ayi, axo, ayo;
+		body.constant_smoothing = (parameters::compatibility_no_star_smoothing && k == 0) ||
+			parameters::compatibility_smoothing_planetloc;
+		body.smoothing = body.constant_smoothing ? compute_smoothing(data, 0, 0, k) : 0.0;
+	}
 
-    const unsigned int ns = data[t_data::SIGMA].Nsec;
-	const auto & sigma = data[t_data::SIGMA];
+    const auto & sigma = data[t_data::SIGMA];
 	const auto & sigma1d = data[t_data::SIGMA_1D];
+	const auto & scale_height = data[t_data::SCALE_HEIGHT];
     const double *cell_center_x = CellCenterX->Field;
     const double *cell_center_y = CellCenterY->Field;
-    axi = ayi = axo = ayo = 0.0;
-
-	#pragma omp parallel for collapse(2) reduction(+ : axi, ayi, axo, ayo)
-    for (unsigned int n_rad = radial_first_active; n_rad < radial_active_size;
-	 ++n_rad) {
-	for (unsigned int n_az = 0; n_az < ns; ++n_az) {
-	    // calculate smoothing length if dependend on radius
-	    // i.e. for thickness smoothing with scale height at cell location
-		double smooth = compute_smoothing(data, n_rad, n_az, nb);
-
-
-		// Phi = GMm / r_sm
-		// r_sm = sqrt(r**2 + (eps * H)**2)
 
-	    const int cell_id = n_az + n_rad * ns;
+	// accelerations from inside (0, 1) and outside (2, 3) of each planet's orbit
+	const std::vector<double> accel = reduction::sum_vector(4 * N_planets,
+	[&](const unsigned int n_rad, const unsigned int n_az, double *a_sum) {
+	    const int cell_id = n_az + n_rad * sigma.Nsec;
 	    const double xc = cell_center_x[cell_id];
 	    const double yc = cell_center_y[cell_id];
 
@@ -66,8 +79,18 @@ Pair ComputeDiskOnPlanetAccel(t_data &data, const unsigned int nb)
 		}
 	    const double cellmass = Surf[n_rad] * cell_sigma;
 
-	    const double dx = xc - x;
-	    const double dy = yc - y;
+		// thickness smoothing with scale height at cell location
+		const double smooth_cell = parameters::thickness_smoothing * scale_height(n_rad, n_az);
+
+		for (unsigned int k = 0; k < N_planets; ++k) {
+		const t_body &body = bodies[k];
+
+		// Phi = GMm / r_sm
+		// r_sm = sqrt(r**2 + (eps * H)**2)
+		const double smooth = body.constant_smoothing ? body.smoothing : smooth_cell;
+
+	    const double dx = xc - body.x;
+	    const double dy = yc - body.y;
 	    const double dist_2 = std::pow(dx, 2) + std::pow(dy, 2);
 		const double dist_sm_2 = dist_2 + std::pow(smooth, 2);
 		const double dist_sm = std::sqrt(dist_sm_2);
@@ -77,48 +100,33 @@ Pair ComputeDiskOnPlanetAccel(t_data &data, const unsigned int nb)
 	    // just to be consistent with the force the gas feels from the
 	    // planets
 	    double smooth_factor_klahr = 1.0;
-	    if (klahr_smoothing_constant > 0.0) {
 		/// scale height is reduced by the planets and can cause the
 		/// epsilon smoothing be not sufficient for numerical stability.
 		/// Thus we add the gravitational potential smoothing proposed
 		/// by Klahr & Kley 2005; but the derivative of it, since we
 		/// apply it directly on the force
-			const double l1 = planet.get_dimensionless_roche_radius() *
-				planet.get_distance_to_primary();
-			const double r_sm = l1 * klahr_smoothing_constant;
-
-			if (dist_sm < r_sm) {
+		if (dist_sm < body.r_sm_klahr) {
+			const double r_sm = body.r_sm_klahr;
 			smooth_factor_klahr =
 				-(3.0 * std::pow(dist_sm / r_sm, 4.0) -
 				  4.0 * std::pow(dist_sm / r_sm, 3.0));
-		    }
 		}
 
-	    if (Rmed[n_rad] < a) {
-		axi += constants::G * cellmass * dx * inv_dist_sm_3 *
-			   smooth_factor_klahr;
-		ayi += constants::G * cellmass * dy * inv_dist_sm_3 *
+	    const unsigned int offset = 4 * k + (Rmed[n_rad] < body.a ? 0 : 2);
+		a_sum[offset] += constants::G * cellmass * dx * inv_dist_sm_3 *
 			   smooth_factor_klahr;
-	    } else {
-		axo += constants::G * cellmass * dx * inv_dist_sm_3 *
+		a_sum[offset + 1] += constants::G * cellmass * dy * inv_dist_sm_3 *
 			   smooth_factor_klahr;
-		ayo += constants::G * cellmass * dy * inv_dist_sm_3 *
-			   smooth_factor_klahr;
-	    }
-	}
-    }
-
-    localaccel[0] = axi;
-    localaccel[1] = ayi;
-    localaccel[2] = axo;
-    localaccel[3] = ayo;
-    MPI_Allreduce(&localaccel, &globalaccel, 4, MPI_DOUBLE, MPI_SUM,
-		  MPI_COMM_WORLD);
+		}
+	});
 
-    acceleration.x = globalaccel[0] + globalaccel[2];
-    acceleration.y = globalaccel[1] + globalaccel[3];
+	std::vector<Pair> accelerations(N_planets);
+	for (unsigned int k = 0; k < N_planets; ++k) {
+		accelerations[k].x = accel[4 * k] + accel[4 * k + 2];
+		accelerations[k].y = accel[4 * k + 1] + accel[4 * k + 3];
+	}
 
-    return acceleration;
+    return accelerations;
 }
 
 inline static double compute_smoothing_scaleheight(t_data &data, const int n_radial,
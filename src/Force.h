@@ -2,8 +2,9 @@
 
 #include "types.h"
 #include "data.h"
+#include <vector>
 
-Pair ComputeDiskOnPlanetAccel(t_data &data, const unsigned nb);
+std::vector<Pair> ComputeDiskOnPlanetsAccel(t_data &data);
 double compute_smoothing(t_data &data, const int n_radial,
 			 const int n_azimuthal, const unsigned nb);
 double compute_smoothing_iso_planet(const double Rp);
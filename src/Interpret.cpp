@@ -99,14 +99,14 @@ void ReadVariables(const std::string &filename, t_data &data, int argc, char **a
 	}
     
     ensure_directory_exists(output::outdir);
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 
     start_mode::configure_start_mode();
 
     ensure_directory_exists(output::outdir + "snapshots/");
     ensure_directory_exists(output::outdir + "parameters/");
 	ensure_directory_exists(output::outdir + "monitor/");
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 	logging::init_logfiles(output::outdir);
 	// set up logfiles
 
@@ -153,7 +153,7 @@ void ReadVariables(const std::string &filename, t_data &data, int argc, char **a
 	old_par_file.close();
 
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 
     switch (cfg.get_first_letter_lowercase("Transport", "Fast")) {
     case 'f':
@@ -249,8 +249,16 @@ void ReadVariables(const std::string &filename, t_data &data, int argc, char **a
 		"The grid has (Nrad, Naz) = (%u, %u) cells with (%f, %f) cps.\n",
 		NRadial, NAzimuthal, cpsrad, cpsaz);
 
-    if ((parameters::radial_grid_type == parameters::logarithmic_spacing) ||
-	(parameters::radial_grid_type == parameters::exponential_spacing)) {
+    parameters::axisymmetric = (NAzimuthal == 1);
+    if (parameters::axisymmetric) {
+	logging::print_master(
+	    LOG_INFO
+	    "Single azimuthal cell, using the axisymmetric (1D) fast path.\n");
+    }
+
+    if (!parameters::axisymmetric &&
+	((parameters::radial_grid_type == parameters::logarithmic_spacing) ||
+	 (parameters::radial_grid_type == parameters::exponential_spacing))) {
 	double c = log(RMAX / RMIN);
 	double optimal_N_azimuthal = M_PI / ((std::exp(c / NRadial) - 1.0) /
 					     (std::exp(c / NRadial) + 1.0));
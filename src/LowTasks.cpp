@@ -60,7 +60,9 @@ void delete_directory_if_exists(const std::string &dirname)
 }
 
 /**
-	Finalize MPI and terminate program.
+	Finalize MPI and terminate program. On errors the communicator of this
+	simulation is aborted, so other ensemble members are not taken down
+	as long as the MPI library supports aborting a subset of processes.
 
 	\param returncode returncode to return
 */
@@ -73,7 +75,7 @@ void PersonalExit(int returncode)
     if (returncode != 0) {
 	PrintTrace();
     if (is_MPI_initialized) {
-        MPI_Abort(MPI_COMM_WORLD, returncode);
+        MPI_Abort(CPU_Comm, returncode);
     }
     }
     if (is_MPI_initialized){
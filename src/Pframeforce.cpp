@@ -10,31 +10,67 @@
 #include "constants.h"
 #include "global.h"
 #include "parameters.h"
+#include "radial_profile.h"
 #include "util.h"
 #include "frame_of_reference.h"
 
-/* Below : work in non-rotating frame */
 /**
- * @brief CalculatePotential: Nbody Potential caused by stars and planets
- * @param data
- */
-void CalculateNbodyPotential(t_data &data, const double current_time)
+	Smoothing length of body k at cell (n_rad, n_az) as computed by
+	compute_smoothing(), with the smoothing mode fixed at compile time.
+	per_body_smoothing uses the precomputed smoothing of each body (planet
+	location mode), otherwise the scale height of the cell is used.
+*/
+template <bool per_body_smoothing, bool no_star_smoothing>
+static inline double smoothing(const t_polargrid &scale_height,
+			       const std::vector<double> &body_smoothing,
+			       const unsigned int n_rad,
+			       const unsigned int n_az, const unsigned int k)
 {
-    static const unsigned int N_planets =
-	data.get_planetary_system().get_number_of_planets();
+    if (per_body_smoothing) {
+	return body_smoothing[k];
+    }
+    if (no_star_smoothing && k == 0) {
+	return 0.0;
+    }
+    return parameters::thickness_smoothing * scale_height(n_rad, n_az);
+}
 
-    // setup planet data
-    for (unsigned int k = 0; k < N_planets; k++) {
-	t_planet &planet = data.get_planetary_system().get_planet(k);
-	g_mpl[k] = planet.get_rampup_mass(current_time);
-	g_xpl[k] = planet.get_x();
-	g_ypl[k] = planet.get_y();
+/**
+	Smoothing of every body for the planet location smoothing mode, which
+	does not depend on the cell.
+*/
+static std::vector<double> body_smoothing(t_data &data,
+					  const unsigned int N_planets)
+{
+    std::vector<double> rv;
+    if (parameters::compatibility_smoothing_planetloc) {
+	rv.resize(N_planets);
+	for (unsigned int k = 0; k < N_planets; k++) {
+	    rv[k] = compute_smoothing(data, 0, 0, k);
+	}
+    }
+    return rv;
+}
 
-	g_cubic_smoothing_radius[k] = planet.get_dimensionless_roche_radius() *
-		      planet.get_distance_to_primary() * planet.get_cubic_smoothing_factor();
+typedef void (*t_gas_gravity_kernel)(t_data &data,
+				     const unsigned int N_planets,
+				     const std::vector<double> &body_smoothing);
 
-    }
+/**
+	Selects the instance of kernel for the smoothing mode. The table is
+	indexed with [per_body_smoothing][no_star_smoothing].
+*/
+static t_gas_gravity_kernel select_kernel(const t_gas_gravity_kernel table[2][2])
+{
+    return table[parameters::compatibility_smoothing_planetloc ? 1 : 0]
+		[parameters::compatibility_no_star_smoothing ? 1 : 0];
+}
 
+template <bool per_body_smoothing, bool no_star_smoothing>
+static void nbody_potential_kernel(t_data &data, const unsigned int N_planets,
+				   const std::vector<double> &body_smoothing)
+{
+    const t_polargrid &scale_height = data[t_data::SCALE_HEIGHT];
     auto &pot = data[t_data::POTENTIAL];
     pot.clear();
 
@@ -50,7 +86,9 @@ void CalculateNbodyPotential(t_data &data, const double current_time)
 
 	    for (unsigned int k = 0; k < N_planets; k++) {
 
-		const double smooth = compute_smoothing(data, n_rad, n_az, k);
+		const double smooth =
+		    smoothing<per_body_smoothing, no_star_smoothing>(
+			scale_height, body_smoothing, n_rad, n_az, k);
 		const double dx = x - g_xpl[k];
 		const double dy = y - g_ypl[k];
 		const double dist_2 = std::pow(dx, 2) + std::pow(dy, 2);
@@ -85,23 +123,11 @@ void CalculateNbodyPotential(t_data &data, const double current_time)
     }
 }
 
-void CalculateAccelOnGas(t_data &data, const double current_time)
+template <bool per_body_smoothing, bool no_star_smoothing>
+static void accel_on_gas_kernel(t_data &data, const unsigned int N_planets,
+				const std::vector<double> &body_smoothing)
 {
-
-    static const unsigned int N_planets =
-	data.get_planetary_system().get_number_of_planets();
-
-    // setup planet data
-    for (unsigned int k = 0; k < N_planets; k++) {
-	t_planet &planet = data.get_planetary_system().get_planet(k);
-	g_mpl[k] = planet.get_rampup_mass(current_time);
-	g_xpl[k] = planet.get_x();
-	g_ypl[k] = planet.get_y();
-
-	g_cubic_smoothing_radius[k] = planet.get_dimensionless_roche_radius() *
-				     planet.get_distance_to_primary() * planet.get_cubic_smoothing_factor();
-    }
-
+    const t_polargrid &scale_height = data[t_data::SCALE_HEIGHT];
     double *acc_r = data[t_data::ACCEL_RADIAL].Field;
     double *acc_az = data[t_data::ACCEL_AZIMUTHAL].Field;
 
@@ -124,7 +150,9 @@ void CalculateAccelOnGas(t_data &data, const double current_time)
 	    pair accel_cart = refframe::IndirectTerm;
 	    for (unsigned int k = 0; k < N_planets; k++) {
 
-		const double smooth = compute_smoothing(data, n_rad, n_az, k);
+		const double smooth =
+		    smoothing<per_body_smoothing, no_star_smoothing>(
+			scale_height, body_smoothing, n_rad, n_az, k);
 
 		const double dx = x - g_xpl[k];
 		const double dy = y - g_ypl[k];
@@ -170,21 +198,75 @@ void CalculateAccelOnGas(t_data &data, const double current_time)
     }
 }
 
+static const t_gas_gravity_kernel nbody_potential_kernels[2][2] = {
+    {&nbody_potential_kernel<false, false>,
+     &nbody_potential_kernel<false, true>},
+    {&nbody_potential_kernel<true, false>,
+     &nbody_potential_kernel<true, true>}};
+
+static const t_gas_gravity_kernel accel_on_gas_kernels[2][2] = {
+    {&accel_on_gas_kernel<false, false>, &accel_on_gas_kernel<false, true>},
+    {&accel_on_gas_kernel<true, false>, &accel_on_gas_kernel<true, true>}};
+
+/* Below : work in non-rotating frame */
+/**
+ * @brief CalculatePotential: Nbody Potential caused by stars and planets
+ * @param data
+ */
+void CalculateNbodyPotential(t_data &data, const double current_time)
+{
+    static const unsigned int N_planets =
+	data.get_planetary_system().get_number_of_planets();
+    // the smoothing mode is fixed after startup
+    static const t_gas_gravity_kernel kernel =
+	select_kernel(nbody_potential_kernels);
+
+    // setup planet data
+    for (unsigned int k = 0; k < N_planets; k++) {
+	t_planet &planet = data.get_planetary_system().get_planet(k);
+	g_mpl[k] = planet.get_rampup_mass(current_time);
+	g_xpl[k] = planet.get_x();
+	g_ypl[k] = planet.get_y();
+
+	g_cubic_smoothing_radius[k] = planet.get_dimensionless_roche_radius() *
+		      planet.get_distance_to_primary() * planet.get_cubic_smoothing_factor();
+
+    }
+
+    kernel(data, N_planets, body_smoothing(data, N_planets));
+}
+
+void CalculateAccelOnGas(t_data &data, const double current_time)
+{
+
+    static const unsigned int N_planets =
+	data.get_planetary_system().get_number_of_planets();
+    // the smoothing mode is fixed after startup
+    static const t_gas_gravity_kernel kernel =
+	select_kernel(accel_on_gas_kernels);
+
+    // setup planet data
+    for (unsigned int k = 0; k < N_planets; k++) {
+	t_planet &planet = data.get_planetary_system().get_planet(k);
+	g_mpl[k] = planet.get_rampup_mass(current_time);
+	g_xpl[k] = planet.get_x();
+	g_ypl[k] = planet.get_y();
+
+	g_cubic_smoothing_radius[k] = planet.get_dimensionless_roche_radius() *
+				     planet.get_distance_to_primary() * planet.get_cubic_smoothing_factor();
+    }
+
+    kernel(data, N_planets, body_smoothing(data, N_planets));
+}
+
 
 void ComputeAverageDensity(t_data &data) {
 	const auto & sigma = data[t_data::SIGMA];
-	const unsigned int ns = sigma.Nsec;
     auto & sigma1d = data[t_data::SIGMA_1D];
 
-	#pragma omp parallel for
-    for (unsigned int n_rad = radial_first_active; n_rad < radial_active_size;
-	 ++n_rad) {
-		double sum = 0;
-		for (unsigned int n_az = 0; n_az < ns; ++n_az) {
-			sum += sigma(n_rad, n_az);
-		}
-		sigma1d(n_rad) = sum/ns;
-	}
+    radial_profile::reduce(sigma, radial_profile::reduction_mean,
+			   radial_first_active, radial_active_size,
+			   &sigma1d(radial_first_active));
 }
 
 
@@ -193,7 +275,12 @@ void ComputeAverageDensity(t_data &data) {
 */
 void ComputeDiskOnNbodyAccel(t_data &data, const bool add_torqe_and_average)
 {
-    Pair accel;
+    if (parameters::correct_disk_selfgravity) {
+	ComputeAverageDensity(data);
+    }
+
+    const std::vector<Pair> accelerations = ComputeDiskOnPlanetsAccel(data);
+
     for (unsigned int k = 0;
 	 k < data.get_planetary_system().get_number_of_planets(); k++) {
 	t_planet &planet = data.get_planetary_system().get_planet(k);
@@ -204,11 +291,7 @@ void ComputeDiskOnNbodyAccel(t_data &data, const bool add_torqe_and_average)
 		continue;
 	}
 
-	if (parameters::correct_disk_selfgravity) {
-		ComputeAverageDensity(data);
-	}
-
-	accel = ComputeDiskOnPlanetAccel(data, k);
+	const Pair accel = accelerations[k];
 	planet.set_disk_on_planet_acceleration(accel);
 
 	const double torque =
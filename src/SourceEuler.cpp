@@ -28,15 +28,18 @@
 #include "parameters.h"
 #include "pvte_law.h"
 #include "quantities.h"
+#include "reduction.h"
 #include "selfgravity.h"
 #include "units.h"
 #include "util.h"
+#include "velocity_gradient.h"
 #include "viscosity/viscosity.h"
 #include "simulation.h"
 #include "frame_of_reference.h"
 #include "simulation.h"
 #include "fld.h"
 #include "compute.h"
+#include "derived_fields.h"
 
 #include <cstring>
 
@@ -91,6 +94,8 @@ void SetTemperatureFloorCeilValues(t_data &data, std::string filename, int line)
 	    parameters::minimum_temperature, parameters::maximum_temperature,
 	    units::temperature.get_cgs_symbol(), filename.c_str(), line);
     }
+    // called after every update of the energy
+    derived_fields::changed(derived_fields::input_hydro);
 }
 
 /**
@@ -107,17 +112,19 @@ bool assure_minimum_value(t_polargrid &dst, double minimum_value)
 	const unsigned int Nr = dst.get_size_radial();
 	const unsigned int Nphi = dst.get_size_azimuthal();
 
+	if (is_dens) {
+	MassDelta.FloorMassCreation += reduction::sum_local(
+		[&](const unsigned int nr, const unsigned int naz) {
+		return dst(nr, naz) < minimum_value
+			   ? (minimum_value - dst(nr, naz)) * Surf[nr]
+			   : 0.0;
+		});
+	}
+
 	#pragma omp parallel for collapse(2)
 	for (unsigned int nr = 0; nr < Nr; ++nr) {
 	for (unsigned int naz = 0; naz < Nphi; ++naz) {
 		if (dst(nr, naz) < minimum_value) {
-		if (is_dens) {
-		    double mass_delta =
-			(minimum_value - dst(nr, naz)) *
-			Surf[nr];
-		    sum_without_ghost_cells(MassDelta.FloorMassCreation, mass_delta,
-						nr);
-		}
 		dst(nr, naz) = minimum_value;
 #ifndef NDEBUG
 		logging::print(LOG_DEBUG
@@ -250,6 +257,8 @@ void recalculate_derived_disk_quantities(t_data &data, const double current_time
 
 void init_euler(t_data &data, const double current_time)
 {
+    // the initial conditions write the derived grids directly
+    derived_fields::invalidate();
     InitCellCenterCoordinates();
     InitTransport();
 
@@ -443,6 +452,7 @@ void update_with_sourceterms(t_data &data, const double dt)
 	// Momentum update due to 
 	momentum_update_radial(data, dt);
 	momentum_update_azimuthal(data, dt);
+	velocity_gradient::invalidate();
 	compression_heating(data, dt);
 
 	if(ECC_GROWTH_MONITOR){
@@ -463,18 +473,13 @@ void compression_heating(t_data &data, const double dt){
 
 	// Calculate the energy update due to div_v
 	if (parameters::Adiabatic) {
+	const velocity_gradient::t_strain_rate &strain_rate =
+		velocity_gradient::get(data);
+
 	#pragma omp parallel for collapse(2)
 	for (unsigned int nr = 0; nr < Nr; ++nr) {
 		for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		const unsigned int naz_next = (naz == Nphi-1 ? 0 : naz + 1);
-		// div(v) = 1/r d(r*v_r)/dr + 1/r d(v_phi)/dphi
-		const double DIV_V =
-			(data[t_data::V_RADIAL](nr+1, naz)*Ra[nr+1] -
-				data[t_data::V_RADIAL](nr, naz)*Ra[nr]) *
-			InvDiffRsupRb[nr] +
-			(data[t_data::V_AZIMUTHAL](nr, naz_next) -
-			 data[t_data::V_AZIMUTHAL](nr, naz)) *
-			invdphi * InvRb[nr];
+		const double DIV_V = strain_rate.div_v[strain_rate.id(nr, naz)];
 
 		const double gamma =
 			pvte::get_gamma_eff(data, nr, naz);
@@ -489,6 +494,7 @@ void compression_heating(t_data &data, const double dt){
 		
 	    } // end azimuthal loop
 	} // end radial loop
+	derived_fields::changed(derived_fields::input_hydro);
     } // end if adiabatic
 }
 
@@ -853,63 +859,27 @@ void calculate_qminus(t_data &data, const double current_time)
 }
 
 /**
-	In this substep we take into account the source part of energy equation.
-   We evolve internal energy with compression/dilatation and heating terms
+	Energy update with the heating and cooling rates in QPLUS and QMINUS.
+	variable_gamma selects at compile time whether gamma and mu are read
+	from the PVTE grids or are the constants from the parameters.
 */
-void SubStep3(t_data &data, const double current_time, const double dt)
+template <bool variable_gamma>
+static void energy_source_kernel(t_data &data, const double dt)
 {
-	compute_temperature(data);
-	calculate_qminus(data, current_time); // first to calculate teff
-	calculate_qplus(data);
-
 	const unsigned int Nr = data[t_data::TAU_COOL].get_size_radial();
 	const unsigned int Nphi = data[t_data::TAU_COOL].get_size_azimuthal();
 
-    // calculate tau_cool if needed for output
-    if (data[t_data::TAU_COOL].get_write_1D() ||
-	data[t_data::TAU_COOL].get_write_2D()) {
-	#pragma omp parallel for collapse(2)
-	for (unsigned int nr = 1; nr < Nr-1; ++nr) { // Q_plus / Q_minus are not computed for nr = 1 or nr = Nr-1 (check max_radial usage there)
-		for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		data[t_data::TAU_COOL](nr, naz) =
-			data[t_data::ENERGY](nr, naz) /
-			data[t_data::QMINUS](nr, naz);
-	    }
-	}
-    }
-
-    // calculate pDV for write out
-    if (data[t_data::P_DIVV].get_write_1D() ||
-	data[t_data::P_DIVV].get_write_2D() ||
-	fld::radiative_diffusion_enabled) {
-
-	data.pdivv_total = 0;
-	double &pdivv_tmp = data.pdivv_total;
-
-	#pragma omp parallel for collapse(2)
-	for (unsigned int nr = 1; nr < Nr-1; ++nr) {
-		for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		double pdivv =
-			(pvte::get_gamma_eff(data, nr, naz) - 1.0) *
-			dt * data[t_data::DIV_V](nr, naz) *
-			data[t_data::ENERGY](nr, naz);
-		data[t_data::P_DIVV](nr, naz) = pdivv;
-
-		sum_without_ghost_cells(pdivv_tmp, pdivv, nr);
-	    }
-	}
-    }
-
-    // Now we can update energy with source terms
 	#pragma omp parallel for collapse(2)
 	for (unsigned int nr = 1; nr < Nr-1; ++nr) {// Don't update ghost cells
 	for (unsigned int naz = 0; naz < Nphi; ++naz) {
 
 	    const double sigma_sb = constants::sigma;
 	    const double c = constants::c;
-		const double mu = pvte::get_mu(data, nr, naz);
-	    const double gamma =
-		pvte::get_gamma_eff(data, nr, naz);
+		const double mu =
+		variable_gamma ? data[t_data::MU](nr, naz) : parameters::MU;
+	    const double gamma = variable_gamma
+				     ? data[t_data::GAMMAEFF](nr, naz)
+				     : parameters::ADIABATICINDEX;
 
 	    const double Rgas = constants::R;
 
@@ -949,6 +919,75 @@ void SubStep3(t_data &data, const double current_time, const double dt)
 		data[t_data::ENERGY](nr, naz) = energy_new;
 	}
     }
+}
+
+typedef void (*t_energy_source_kernel)(t_data &data, const double dt);
+
+static const t_energy_source_kernel energy_source_kernels[2] = {
+    &energy_source_kernel<false>, &energy_source_kernel<true>};
+
+/**
+	In this substep we take into account the source part of energy equation.
+   We evolve internal energy with compression/dilatation and heating terms
+*/
+void SubStep3(t_data &data, const double current_time, const double dt)
+{
+	if (parameters::cooling_surface_enabled ||
+		(parameters::heating_star_enabled &&
+		 !parameters::cooling_scurve_enabled)) {
+		// the cooling and heating below need the midplane density and
+		// opacity as well
+		compute::thermodynamics(data, sim::time, true);
+	} else {
+		compute_temperature(data);
+	}
+	calculate_qminus(data, current_time); // first to calculate teff
+	calculate_qplus(data);
+
+	const unsigned int Nr = data[t_data::TAU_COOL].get_size_radial();
+	const unsigned int Nphi = data[t_data::TAU_COOL].get_size_azimuthal();
+
+    // calculate tau_cool if needed for output
+    if (data[t_data::TAU_COOL].get_write_1D() ||
+	data[t_data::TAU_COOL].get_write_2D()) {
+	#pragma omp parallel for collapse(2)
+	for (unsigned int nr = 1; nr < Nr-1; ++nr) { // Q_plus / Q_minus are not computed for nr = 1 or nr = Nr-1 (check max_radial usage there)
+		for (unsigned int naz = 0; naz < Nphi; ++naz) {
+		data[t_data::TAU_COOL](nr, naz) =
+			data[t_data::ENERGY](nr, naz) /
+			data[t_data::QMINUS](nr, naz);
+	    }
+	}
+    }
+
+    // calculate pDV for write out
+    if (data[t_data::P_DIVV].get_write_1D() ||
+	data[t_data::P_DIVV].get_write_2D() ||
+	fld::radiative_diffusion_enabled) {
+
+	#pragma omp parallel for collapse(2)
+	for (unsigned int nr = 1; nr < Nr-1; ++nr) {
+		for (unsigned int naz = 0; naz < Nphi; ++naz) {
+		double pdivv =
+			(pvte::get_gamma_eff(data, nr, naz) - 1.0) *
+			dt * data[t_data::DIV_V](nr, naz) *
+			data[t_data::ENERGY](nr, naz);
+		data[t_data::P_DIVV](nr, naz) = pdivv;
+	    }
+	}
+
+	const t_polargrid &p_divv = data[t_data::P_DIVV];
+	data.pdivv_total = reduction::sum(
+		[&](const unsigned int nr, const unsigned int naz) {
+		return p_divv(nr, naz);
+		});
+    }
+
+    // Now we can update energy with source terms
+	// variableGamma is fixed after startup
+	static const t_energy_source_kernel kernel =
+	energy_source_kernels[parameters::variableGamma ? 1 : 0];
+	kernel(data, dt);
 
 	SetTemperatureFloorCeilValues(data, __FILE__, __LINE__);
 }
@@ -1097,6 +1136,11 @@ static void compute_iso_sound_speed_nbody(t_data &data, const double current_tim
 
 void compute_sound_speed(t_data &data, const double current_time)
 {
+    if (derived_fields::up_to_date(derived_fields::field_sound_speed,
+				   current_time)) {
+	return;
+    }
+
     if (parameters::Adiabatic || parameters::Polytropic) {
 	compute_sound_speed_normal(data);
     }
@@ -1116,6 +1160,8 @@ void compute_sound_speed(t_data &data, const double current_time)
 		compute_sound_speed_normal(data);
 	}
     }
+
+    derived_fields::computed(derived_fields::field_sound_speed, current_time);
 }
 
 void compute_scale_height_old(t_data &data)
@@ -1153,20 +1199,15 @@ void compute_scale_height_old(t_data &data)
     }
 }
 
-void compute_scale_height_nbody(t_data &data, const double current_time)
+/**
+	Scale height in the nbody mode. energy_equation selects the adiabatic
+	or polytropic sound speed conversion, write_aspectratio whether the
+	aspect ratio is needed as well; both are fixed at compile time to keep
+	them out of the loop over the bodies.
+*/
+template <bool energy_equation, bool write_aspectratio>
+static void scale_height_nbody_kernel(t_data &data, const unsigned int N_planets)
 {
-
-    static const unsigned int N_planets =
-	data.get_planetary_system().get_number_of_planets();
-    // setup planet data
-    for (unsigned int k = 0; k < N_planets; k++) {
-	const t_planet &planet = data.get_planetary_system().get_planet(k);
-	g_mpl[k] = planet.get_rampup_mass(current_time);
-	g_xpl[k] = planet.get_x();
-	g_ypl[k] = planet.get_y();
-	g_rpl[k] = planet.get_planet_radial_extend();
-    }
-
 	const unsigned int Nr = data[t_data::SCALE_HEIGHT].get_size_radial();
 	const unsigned int Nphi = data[t_data::SCALE_HEIGHT].get_size_azimuthal();
 
@@ -1184,6 +1225,8 @@ void compute_scale_height_nbody(t_data &data, const double current_time)
 	    const double y = CellCenterY->Field[cell];
 	    const double cs2 =
 		std::pow(data[t_data::SOUNDSPEED](n_rad, n_az), 2);
+	    const double gamma1 =
+		energy_equation ? pvte::get_gamma1(data, n_rad, n_az) : 1.0;
 
 		double inv_H2 = 0.0; // inverse scale height squared
 		double inv_h2 = 0.0; // inverse aspectratio squared
@@ -1208,13 +1251,12 @@ void compute_scale_height_nbody(t_data &data, const double current_time)
 		const double dist3 = std::pow(dist, 3);
 
 		// H^2 = (GM / dist^3 / Cs_iso^2)^-1
-		if (parameters::Adiabatic || parameters::Polytropic) {
-		    const double gamma1 = pvte::get_gamma1(data, n_rad, n_az);
+		if (energy_equation) {
 			const double tmp_inv_H2 =
 			constants::G * g_mpl[k] * gamma1 / (dist3 * cs2);
 		    inv_H2 += tmp_inv_H2;
 
-			if(parameters::heating_star_enabled || parameters::self_gravity || parameters::disk_feedback || parameters::body_force_from_potential){
+			if(write_aspectratio){
 			const double tmp_inv_h2 =
 			constants::G * g_mpl[k] * gamma1 / (dist * cs2);
 			inv_h2 += tmp_inv_h2;
@@ -1225,7 +1267,7 @@ void compute_scale_height_nbody(t_data &data, const double current_time)
 			constants::G * g_mpl[k] / (dist3 * cs2);
 		    inv_H2 += tmp_inv_H2;
 
-			if(parameters::heating_star_enabled || parameters::self_gravity || parameters::disk_feedback || parameters::body_force_from_potential){
+			if(write_aspectratio){
 			const double tmp_inv_h2 =
 			constants::G * g_mpl[k] / (dist * cs2);
 			inv_h2 += tmp_inv_h2;
@@ -1236,7 +1278,7 @@ void compute_scale_height_nbody(t_data &data, const double current_time)
 	    const double H = std::sqrt(1.0 / inv_H2);
 	    data[t_data::SCALE_HEIGHT](n_rad, n_az) = H;
 
-		if(parameters::heating_star_enabled || parameters::self_gravity || parameters::disk_feedback || parameters::body_force_from_potential){
+		if(write_aspectratio){
 			const double h = std::sqrt(1.0 / inv_h2);
 			data[t_data::ASPECTRATIO](n_rad, n_az) = h;
 		}
@@ -1244,6 +1286,44 @@ void compute_scale_height_nbody(t_data &data, const double current_time)
     }
 }
 
+typedef void (*t_scale_height_nbody_kernel)(t_data &data,
+					    const unsigned int N_planets);
+
+// indexed with [energy_equation][write_aspectratio]
+static const t_scale_height_nbody_kernel scale_height_nbody_kernels[2][2] = {
+    {&scale_height_nbody_kernel<false, false>,
+     &scale_height_nbody_kernel<false, true>},
+    {&scale_height_nbody_kernel<true, false>,
+     &scale_height_nbody_kernel<true, true>}};
+
+void compute_scale_height_nbody(t_data &data, const double current_time)
+{
+
+    static const unsigned int N_planets =
+	data.get_planetary_system().get_number_of_planets();
+    // the equation of state and the consumers of the aspect ratio are
+    // fixed after startup
+    static const t_scale_height_nbody_kernel kernel =
+	scale_height_nbody_kernels
+	    [(parameters::Adiabatic || parameters::Polytropic) ? 1 : 0]
+	    [(parameters::heating_star_enabled || parameters::self_gravity ||
+	      parameters::disk_feedback ||
+	      parameters::body_force_from_potential)
+		 ? 1
+		 : 0];
+
+    // setup planet data
+    for (unsigned int k = 0; k < N_planets; k++) {
+	const t_planet &planet = data.get_planetary_system().get_planet(k);
+	g_mpl[k] = planet.get_rampup_mass(current_time);
+	g_xpl[k] = planet.get_x();
+	g_ypl[k] = planet.get_y();
+	g_rpl[k] = planet.get_planet_radial_extend();
+    }
+
+    kernel(data, N_planets);
+}
+
 void compute_scale_height_center_of_mass(t_data &data)
 {
 
@@ -1321,6 +1401,11 @@ static void adjust_scale_height_for_sg(t_data &data) {
 
 void compute_scale_height(t_data &data, const double current_time)
 {
+    if (derived_fields::up_to_date(derived_fields::field_scale_height,
+				   current_time)) {
+	return;
+    }
+
     switch (parameters::aspectratio_mode) {
     case 0:
 	compute_scale_height_old(data);
@@ -1340,10 +1425,15 @@ void compute_scale_height(t_data &data, const double current_time)
         compute::toomreQ(data);
         adjust_scale_height_for_sg(data);
     }
+
+    derived_fields::computed(derived_fields::field_scale_height, current_time);
 }
 
 void compute_pressure(t_data &data)
 {
+    if (derived_fields::up_to_date(derived_fields::field_pressure)) {
+	return;
+    }
 
 	const unsigned int Nr = data[t_data::PRESSURE].get_size_radial();
 	const unsigned int Nphi = data[t_data::PRESSURE].get_size_azimuthal();
@@ -1373,10 +1463,16 @@ void compute_pressure(t_data &data)
 	    }
 	}
     }
+
+    derived_fields::computed(derived_fields::field_pressure);
 }
 
 void compute_temperature(t_data &data)
 {
+    if (derived_fields::up_to_date(derived_fields::field_temperature)) {
+	return;
+    }
+
 	auto &T = data[t_data::TEMPERATURE];
 	auto &Sig = data[t_data::SIGMA];
 	auto &E = data[t_data::ENERGY];
@@ -1405,12 +1501,16 @@ void compute_temperature(t_data &data)
 	    }
 	}
     }
+
+    derived_fields::computed(derived_fields::field_temperature);
 }
 
 void compute_heating_cooling_for_CFL(t_data &data, const double current_time)
 {
     if (parameters::Adiabatic) {
 
+	// called outside of the hydro step, e.g. after reading a snapshot
+	velocity_gradient::invalidate();
 	viscosity::update_viscosity(data);
 	viscosity::compute_viscous_stress_tensor(data);
 
@@ -4,24 +4,13 @@
 #include "parameters.h"
 #include "constants.h"
 #include "global.h"
+#include "radial_profile.h"
 
 
 static void compute_azimuthal_avg(t_polargrid &X, t_radialarray &Xavg) {
-	unsigned int Imax_az = X.get_max_azimuthal();
-	unsigned int Imax_rad = X.get_max_radial();
-
-	unsigned int Naz = X.Nsec;
-
 	// Compute the azimuthal mean of X
-	#pragma omp parallel for
-    for (unsigned int nr = 0; nr <= Imax_rad; ++nr) {
-		double mean = 0.0;
-		for (unsigned int naz = 0; naz <= Imax_az; ++naz) {
-			mean += X(nr, naz);
-		}
-		mean /= (double)(Naz);
-		Xavg[nr] = mean;
-    }
+	radial_profile::reduce(X, radial_profile::reduction_mean, 0,
+			       X.get_max_radial() + 1, Xavg);
 }
 
 /**
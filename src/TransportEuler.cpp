@@ -22,6 +22,7 @@ velocity in each zone by a proper averaging).
 #include "SourceEuler.h"
 #include "TransportEuler.h"
 #include "boundary_conditions/boundary_conditions.h"
+#include "derived_fields.h"
 #include "global.h"
 #include "parameters.h"
 #include "util.h"
@@ -51,6 +52,11 @@ static boolean NoSplitAdvection[MAX1D];
 static boolean UniformTransport;
 extern boolean OpenInner;
 
+// slope kernels of the selected flux limiter, set by InitTransport
+static void (*radial_slopes_kernel)(const t_polargrid *Qbase) = nullptr;
+static void (*azimuthal_slopes_kernel)(const t_polargrid *Qbase) = nullptr;
+static void select_slope_kernels();
+
 /**
 	Initializes (allocates) all variables needed.
 */
@@ -93,6 +99,8 @@ void InitTransport()
     TempShift = (double *)malloc(NRadial * NAzimuthal * sizeof(double));
 
     dq = (double *)malloc(NRadial * NAzimuthal * sizeof(double));
+
+    select_slope_kernels();
 }
 
 /**
@@ -116,7 +124,11 @@ void Transport(t_data &data, PolarGrid *Density, PolarGrid *VRadial,
 
     /* No-Alternate Directionnal Splitting */
     OneWindRad(data, Density, VRadial, Energy, dt);
-    OneWindTheta(data, Density, VAzimuthal, Energy, dt);
+    // with a single azimuthal cell, every azimuthal flux leaves and enters
+    // the same cell and the shift is the identity
+    if (!parameters::axisymmetric) {
+	OneWindTheta(data, Density, VAzimuthal, Energy, dt);
+    }
 
     compute_velocities_from_momenta(*Density, *VRadial, *VAzimuthal);
 
@@ -129,6 +141,7 @@ void Transport(t_data &data, PolarGrid *Density, PolarGrid *VRadial,
 	// is crucial the check minimum density before!
 	SetTemperatureFloorCeilValues(data, __FILE__, __LINE__);
 	}
+	derived_fields::changed(derived_fields::input_hydro);
 
 	if(ECC_GROWTH_MONITOR){
 		quantities::calculate_disk_delta_ecc_peri(data, delta_ecc_transport, delta_peri_transport);
@@ -322,17 +335,16 @@ static double MC_lim(const double a, const double b){
 	return minmod(0.5*(a+b), 2.0*minmod(a, b));
 }
 
-static double flux_limiter(const double a, const double b){
-	switch(flux_limiter_type){
-		case 0:
-			return van_leer_lim(a, b);
-			break;
-		case 1:
-			return MC_lim(a, b);
-			break;
-		default:
-			return van_leer_lim(a, b);
-			break;
+/**
+	Flux limiter selected at compile time, limiter_type follows
+	flux_limiter_type (0: van Leer, 1: MC).
+*/
+template <int limiter_type>
+static inline double flux_limiter(const double a, const double b){
+	if (limiter_type == 1) {
+		return MC_lim(a, b);
+	} else {
+		return van_leer_lim(a, b);
 	}
 }
 
@@ -343,13 +355,11 @@ static inline unsigned int cell_number(const unsigned int nrad,
 }
 
 /**
+	Limited radial slopes of Qbase, stored in dq.
 */
-// void compute_star_radial(t_polargrid* base, t_polargrid* V_Radial,
-// t_polargrid* star, double dt)
-void compute_star_radial(t_polargrid *Qbase, t_polargrid *VRadial,
-			 t_polargrid *QStar, double dt)
+template <int limiter_type>
+static void radial_slopes(const t_polargrid *Qbase)
 {
-
 	const unsigned int Nr = Qbase->Nrad;
 	const unsigned int Nphi = Qbase->Nsec;
 	#pragma omp parallel for collapse(2)
@@ -365,10 +375,71 @@ void compute_star_radial(t_polargrid *Qbase, t_polargrid *VRadial,
 		      InvDiffRmed[nRadial];
 		const double dqp = (Qbase->Field[cellNextRadial] - Qbase->Field[cell]) *
 		      InvDiffRmed[nRadial + 1];
-		dq[cell] = flux_limiter(dqp, dqm);
+		dq[cell] = flux_limiter<limiter_type>(dqp, dqm);
 		}
 	}
     }
+}
+
+/**
+	Limited azimuthal slopes of Qbase divided by the cell width, stored
+	in dq.
+*/
+template <int limiter_type>
+static void azimuthal_slopes(const t_polargrid *Qbase)
+{
+	const unsigned int Nr = Qbase->Nrad;
+	const unsigned int Nphi = Qbase->Nsec;
+
+	#pragma omp parallel for
+	for (unsigned int nRadial = 0; nRadial < Nr; ++nRadial) {
+	const double dxtheta = dphi * Rmed[nRadial];
+	const double invdxtheta = 1.0 / dxtheta;
+	for (unsigned int nAzimuthal = 0; nAzimuthal < Nphi; ++nAzimuthal) {
+		const unsigned int cell = cell_number(nRadial, nAzimuthal, Nphi);
+
+		unsigned int ljp = cell + 1;
+		unsigned int ljm = cell - 1;
+	    if (nAzimuthal == 0) {
+		ljm = nRadial * Nphi + Nphi - 1;
+	    }
+		if (nAzimuthal == Nphi - 1) {
+		ljp = nRadial * Nphi;
+	    }
+		const double dqm = (Qbase->Field[cell] - Qbase->Field[ljm]);
+		const double dqp = (Qbase->Field[ljp] - Qbase->Field[cell]);
+		dq[cell] = 0.5*flux_limiter<limiter_type>(dqp, dqm) * invdxtheta;
+	}
+	}
+}
+
+typedef void (*t_slopes)(const t_polargrid *Qbase);
+
+// slope kernels for every flux limiter, indexed by flux_limiter_type
+static const t_slopes radial_slopes_table[] = {&radial_slopes<0>,
+					       &radial_slopes<1>};
+static const t_slopes azimuthal_slopes_table[] = {&azimuthal_slopes<0>,
+						  &azimuthal_slopes<1>};
+
+static void select_slope_kernels()
+{
+    const unsigned int limiter = flux_limiter_type == 1 ? 1 : 0;
+    radial_slopes_kernel = radial_slopes_table[limiter];
+    azimuthal_slopes_kernel = azimuthal_slopes_table[limiter];
+}
+
+/**
+*/
+// void compute_star_radial(t_polargrid* base, t_polargrid* V_Radial,
+// t_polargrid* star, double dt)
+void compute_star_radial(t_polargrid *Qbase, t_polargrid *VRadial,
+			 t_polargrid *QStar, double dt)
+{
+
+	const unsigned int Nr = Qbase->Nrad;
+	const unsigned int Nphi = Qbase->Nsec;
+	radial_slopes_kernel(Qbase);
+
     // TODO: changed to nRadial =1 because of nRadial-1
     // TODO: potential problem: Using Rmed[nRadial] - Rmed[nRadial-1] for
     // a-mesh Qties (v_rad,..) as well as for b-mesh Qties (Density,...)
@@ -420,26 +491,7 @@ void ComputeStarTheta(PolarGrid *Qbase, PolarGrid *VAzimuthal, PolarGrid *QStar,
 	const unsigned int Nr = Qbase->Nrad;
 	const unsigned int Nphi = Qbase->Nsec;
 
-	#pragma omp parallel for
-	for (unsigned int nRadial = 0; nRadial < Nr; ++nRadial) {
-	const double dxtheta = dphi * Rmed[nRadial];
-	const double invdxtheta = 1.0 / dxtheta;
-	for (unsigned int nAzimuthal = 0; nAzimuthal < Nphi; ++nAzimuthal) {
-		const unsigned int cell = cell_number(nRadial, nAzimuthal, Nphi);
-
-		unsigned int ljp = cell + 1;
-		unsigned int ljm = cell - 1;
-	    if (nAzimuthal == 0) {
-		ljm = nRadial * Nphi + Nphi - 1;
-	    }
-		if (nAzimuthal == Nphi - 1) {
-		ljp = nRadial * Nphi;
-	    }
-		const double dqm = (Qbase->Field[cell] - Qbase->Field[ljm]);
-		const double dqp = (Qbase->Field[ljp] - Qbase->Field[cell]);
-		dq[cell] = 0.5*flux_limiter(dqp, dqm) * invdxtheta;
-	}
-	}
+	azimuthal_slopes_kernel(Qbase);
 
 	#pragma omp parallel for
 	for (unsigned int nRadial = 0; nRadial < Nr; ++nRadial) {
@@ -10,6 +10,7 @@
 #include <iostream>
 
 #include "accretion.h"
+#include "derived_fields.h"
 #include "find_cell_id.h"
 #include "global.h"
 #include "parameters.h"
@@ -18,45 +19,6 @@
 
 namespace accretion
 {
-static std::tuple<unsigned int, unsigned int>
-hill_radial_index(const double Rplanet, const double RHill)
-{
-
-    const bool is_vector = false;
-    /* Calculate the indeces in radial direction where
-       the Hill sphere starts and stops */
-    unsigned i_min;
-    if (Rplanet - RHill < RMIN) {
-	i_min = 0;
-    } else {
-	i_min =
-	    clamp_r_id_to_radii_grid(get_rinf_id(Rplanet - RHill), is_vector);
-    }
-    unsigned i_max =
-	clamp_r_id_to_radii_grid(get_rinf_id(Rplanet + RHill) + 1, is_vector);
-    std::tuple<unsigned int, unsigned int> ids(i_min, i_max);
-    return ids;
-}
-
-static std::tuple<int, int> hill_azimuthal_index(const double angle,
-						 const double Rplanet,
-						 const double RHill)
-{
-    /* Calculate the index in azimuthal direction
-       where the Hill sphere starts and stops */
-    double max_angle;
-    if(Rplanet == 0.0){
-	max_angle = 2.0*M_PI;
-    } else {
-	max_angle = std::min(2.0*M_PI, 2.0 * RHill / Rplanet);
-    }
-	const int j_min = get_med_azimuthal_id(angle - max_angle);
-	int j_max = get_med_azimuthal_id(angle + max_angle) + 1;
-	j_max = j_min + std::min(j_max - j_min, (int)NAzimuthal - 1);
-	std::tuple<int, int> ids(j_min, j_max);
-	return ids;
-}
-
 static void update_planet(t_planet &planet, const double dMplanet,
 			  const double dPxPlanet, const double dPyPlanet)
 {
@@ -194,7 +156,7 @@ static bool AccreteOntoSinglePlanet(t_data &data, t_planet &planet, double dt)
 
     // MPI reduce
     double temp;
-    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
     dMplanet = temp;
 
     // monitoring purpose only
@@ -203,10 +165,10 @@ static bool AccreteOntoSinglePlanet(t_data &data, t_planet &planet, double dt)
     if (parameters::disk_feedback || parameters::accrete_without_disk_feedback) { // only update planets if they feel the
 				     // disk
 	MPI_Allreduce(&dPxPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPxPlanet = temp;
 	MPI_Allreduce(&dPyPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPyPlanet = temp;
 
 	// update planet momentum
@@ -306,7 +268,7 @@ static bool SinkHoleSinglePlanet(t_data &data, t_planet &planet, double dt)
 
     // MPI reduce
     double temp;
-    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
     dMplanet = temp;
 
     // monitoring purpose only
@@ -315,10 +277,10 @@ static bool SinkHoleSinglePlanet(t_data &data, t_planet &planet, double dt)
     if (parameters::disk_feedback || parameters::accrete_without_disk_feedback) { // only update planets if they feel the
 				     // disk
 	MPI_Allreduce(&dPxPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPxPlanet = temp;
 	MPI_Allreduce(&dPyPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPyPlanet = temp;
 
 	// update planet momentum
@@ -453,7 +415,7 @@ static bool AccreteOntoSinglePlanetViscous(t_data &data, t_planet &planet,
 
     // MPI reduce
     double temp;
-    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&dMplanet, &temp, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
     dMplanet = temp;
 
     // monitoring purpose only
@@ -462,10 +424,10 @@ static bool AccreteOntoSinglePlanetViscous(t_data &data, t_planet &planet,
     if (parameters::disk_feedback || parameters::accrete_without_disk_feedback) { // only update planets if they feel the
 				     // disk
 	MPI_Allreduce(&dPxPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPxPlanet = temp;
 	MPI_Allreduce(&dPyPlanet, &temp, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 	dPyPlanet = temp;
 
 	// update planet momentum
@@ -507,7 +469,9 @@ void AccreteOntoPlanets(t_data &data, const double dt)
     if (masses_changed) {
 	planetary_system.update_global_hydro_frame_center_mass();
 	planetary_system.update_roche_radii();
+	derived_fields::changed(derived_fields::input_nbody);
     }
+    derived_fields::changed(derived_fields::input_hydro);
 }
 }
 
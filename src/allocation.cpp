@@ -0,0 +1,86 @@
+/**
+	\file allocation.cpp
+
+	Memory for polargrids is page aligned and initialized in parallel with
+	the same static partition of the cells that the collapsed OpenMP loops
+	over the grid use. With bound threads (OMP_PROC_BIND) the first touch
+	places every page on the NUMA node of the thread working on it.
+*/
+
+#include "allocation.h"
+#include "LowTasks.h"
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+namespace allocation
+{
+
+static bool huge_pages = false;
+
+/**
+	Use transparent huge pages for grids allocated afterwards.
+*/
+void set_huge_pages(const bool value) { huge_pages = value; }
+
+static double *allocate_aligned(const size_t size, const size_t alignment)
+{
+    void *ptr = nullptr;
+    // allocate at least one element so that the pointer is valid
+    const size_t bytes = (size > 0 ? size : 1) * sizeof(double);
+    if (posix_memalign(&ptr, alignment, bytes) != 0) {
+	die("Could not allocate %lu bytes!\n", bytes);
+    }
+    return static_cast<double *>(ptr);
+}
+
+/**
+	Allocate size doubles for a polargrid and set them to zero from the
+	threads that will work on them. With transparent huge pages, grids of at
+	least one huge page are aligned to and padded to whole huge pages, since
+	the kernel only backs aligned 2 MiB regions with huge pages.
+*/
+double *allocate_grid(const size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    const size_t bytes = size * sizeof(double);
+    if (huge_pages && bytes >= huge_page_size) {
+	const size_t padded_bytes =
+	    (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+	double *ptr =
+	    allocate_aligned(padded_bytes / sizeof(double), huge_page_size);
+	madvise(ptr, padded_bytes, MADV_HUGEPAGE);
+	clear_grid(ptr, size);
+	return ptr;
+    }
+#endif
+
+    double *ptr = allocate_aligned(size, page_size);
+    clear_grid(ptr, size);
+    return ptr;
+}
+
+/**
+	Allocate size doubles for a radial array and set them to zero.
+*/
+double *allocate_array(const size_t size)
+{
+    double *ptr = allocate_aligned(size, cache_line_size);
+    memset(ptr, 0, size * sizeof(double));
+    return ptr;
+}
+
+void deallocate(double *ptr) { std::free(ptr); }
+
+/**
+	Set a grid to zero, using the static OpenMP partition of the grid cells.
+*/
+void clear_grid(double *ptr, const size_t size)
+{
+	#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < size; ++i) {
+	ptr[i] = 0.0;
+    }
+}
+
+} // namespace allocation
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+// Aligned allocation of grid data with first-touch initialization.
+
+namespace allocation
+{
+
+// alignment of radial arrays (one cache line)
+const size_t cache_line_size = 64;
+// alignment of polargrids, needed to place whole pages
+const size_t page_size = 4096;
+// alignment of polargrids with transparent huge pages
+const size_t huge_page_size = 2 * 1024 * 1024;
+
+double *allocate_grid(const size_t size);
+double *allocate_array(const size_t size);
+void deallocate(double *ptr);
+void clear_grid(double *ptr, const size_t size);
+
+void set_huge_pages(const bool value);
+
+} // namespace allocation
@@ -10,6 +10,7 @@
 #include "boundary_conditions.h"
 
 #include "../global.h"
+#include "../derived_fields.h"
 #include "../quantities.h"
 
 
@@ -111,6 +112,7 @@ void apply_boundary_condition(t_data &data, const double current_time, const dou
 		rochelobe_overflow_boundary(data, nullptr, false);
 	}
 
+	derived_fields::changed(derived_fields::input_hydro);
 }
 
 
@@ -92,6 +92,9 @@ extern double damping_outer_limit;
 /// damping time factor
 extern double damping_time_factor;
 extern double damping_time_radius_outer;
+/// relative center of mass shift before the cached disk model profiles of
+/// the center of mass boundaries are recomputed
+extern double boundary_profile_tolerance;
 /// vector to handle damping structs
 extern std::vector<t_DampingType> damping_vector;
 
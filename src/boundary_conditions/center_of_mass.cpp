@@ -16,6 +16,8 @@
 #include "../frame_of_reference.h"
 #include "../find_cell_id.h"
 #include "../constants.h"
+#include <cmath>
+#include <vector>
 
 
 
@@ -26,201 +28,315 @@ void init_center_of_mass(t_data& data) {
 	viscous_speed::init_vr_table_boundary(data);
 }
 
-
 /**
- * @brief initial_center_of_mass_boundary: sets the outer boundary
- *  to the initial profile in the center of mass and then shifts it to the
- * primary center. Lucas thinks this is important when simulating a circumbinary
- * disk when the coordination system is centered on the primary.
- * @param data
- */
-void diskmodel_center_of_mass_boundary_outer(t_data &data)
+	Cached reference state of the disk model around the center of mass.
+
+	The boundaries and damping zones below set or relax the gas towards the
+	disk model in the center of mass frame. Evaluating the model needs the
+	cell positions and the disk profile at the distance to the center of mass
+	of every cell. Both are kept per ring range and only recomputed when the
+	rings change or the center of mass moves by more than
+	BoundaryProfileTolerance times the inner radius RMIN of the grid. The
+	center of mass velocity and the frame rotation are applied on every call.
+*/
+struct t_velocity_profile {
+    // true: radial interfaces Rinf at phi = naz*dphi,
+    // false: cell centers Rmed at phi = (naz - 0.5)*dphi
+    bool interface;
+    // outer disk model (quadropole support and outer vr table)
+    bool outer;
+    // honour InitializeVradialZero, only done in the damping zones
+    bool allow_vr_zero;
+
+    unsigned int first = 0;
+    unsigned int end = 0;
+    // IMIN of the local rings, they move with the domain decomposition
+    unsigned int imin = 0;
+    bool valid = false;
+    Pair com_pos;
+    double com_mass = 0.0;
+
+    // cell positions and disk model velocity in the center of mass frame
+    std::vector<double> x, y;
+    std::vector<double> vx, vy;
+
+    t_velocity_profile(const bool interface, const bool outer,
+		       const bool allow_vr_zero)
+	: interface(interface), outer(outer), allow_vr_zero(allow_vr_zero)
+    {
+    }
+};
+
+struct t_scalar_profile {
+    unsigned int first = 0;
+    unsigned int end = 0;
+    // IMIN of the local rings, they move with the domain decomposition
+    unsigned int imin = 0;
+    bool valid = false;
+    Pair com_pos;
+    double com_mass = 0.0;
+
+    // disk model surface density and energy without floor
+    std::vector<double> sigma, energy;
+};
+
+static t_velocity_profile outer_boundary_vazi(false, true, false);
+static t_velocity_profile outer_boundary_vrad(true, true, false);
+static t_velocity_profile inner_boundary_vazi(false, false, false);
+static t_velocity_profile inner_boundary_vrad(true, false, false);
+static t_velocity_profile outer_damping_vazi(false, true, true);
+static t_velocity_profile outer_damping_vrad(true, true, true);
+static t_velocity_profile inner_damping_vazi(false, false, true);
+static t_velocity_profile inner_damping_vrad(true, false, true);
+
+static t_scalar_profile outer_boundary_scalar;
+static t_scalar_profile inner_boundary_scalar;
+static t_scalar_profile outer_damping_scalar;
+static t_scalar_profile inner_damping_scalar;
+
+static bool com_moved(const bool valid, const Pair &cached_pos,
+		      const double cached_mass, const Pair &com_pos,
+		      const double com_mass, const double radius)
 {
+    if (!valid) {
+	return true;
+    }
+    const double dx = com_pos.x - cached_pos.x;
+    const double dy = com_pos.y - cached_pos.y;
+    const double tolerance = boundary_profile_tolerance;
+    return std::sqrt(dx * dx + dy * dy) > tolerance * radius ||
+	   std::fabs(com_mass - cached_mass) > tolerance * cached_mass;
+}
 
-    if (CPU_Rank != CPU_Highest) {
-		return;
+/**
+	Disk model velocities at distance r_com from the center of mass.
+*/
+static void disk_model_velocity(const t_velocity_profile &profile,
+				const double r_com, const double com_mass,
+				double &vazi0, double &vr0)
+{
+    if (parameters::initialize_pure_keplerian) {
+	vazi0 = compute_v_kepler(r_com, com_mass);
+	if (profile.allow_vr_zero && parameters::initialize_vradial_zero) {
+	    vr0 = 0.0;
+	} else {
+	    vr0 = initial_viscous_radial_speed(r_com, com_mass);
 	}
+    } else {
+	if (profile.outer && parameters::v_azimuthal_with_quadropole_support) {
+	    vazi0 = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(
+		r_com, com_mass);
+	} else { // no quadropole support
+	    vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
+	}
+	if (profile.outer) {
+	    vr0 = viscous_speed::lookup_initial_vr_outer(r_com);
+	} else {
+	    vr0 = viscous_speed::lookup_initial_vr_inner(r_com);
+	}
+    }
+}
 
-    const unsigned int np = data.get_planetary_system().get_number_of_planets();
-    const Pair com_pos = data.get_planetary_system().get_center_of_mass(np);
-    const Pair com_vel = data.get_planetary_system().get_center_of_mass_velocity(np);
-    const double com_mass = data.get_planetary_system().get_mass(np);
+static void update_profile(t_velocity_profile &profile,
+			   const unsigned int first, const unsigned int end,
+			   const Pair &com_pos, const double com_mass)
+{
+    const unsigned int Nphi = NAzimuthal;
+    const double *radii = profile.interface ? (const double *)Rinf
+					    : (const double *)Rmed;
+
+    if (first != profile.first || end != profile.end ||
+	IMIN != profile.imin || profile.x.empty()) {
+	profile.first = first;
+	profile.end = end;
+	profile.imin = IMIN;
+	profile.valid = false;
+	profile.x.resize((end - first) * Nphi);
+	profile.y.resize((end - first) * Nphi);
+	profile.vx.resize((end - first) * Nphi);
+	profile.vy.resize((end - first) * Nphi);
+
+	const double phase = profile.interface ? 0.0 : -0.5;
+	std::vector<double> cos_phi(Nphi), sin_phi(Nphi);
+	for (unsigned int naz = 0; naz < Nphi; ++naz) {
+	    const double phi = ((double)naz + phase) * dphi;
+	    cos_phi[naz] = std::cos(phi);
+	    sin_phi[naz] = std::sin(phi);
+	}
 
-    auto &sigma = data[t_data::SIGMA];
-    auto &energy = data[t_data::ENERGY];
-    auto &vrad = data[t_data::V_RADIAL];
-    auto &vaz = data[t_data::V_AZIMUTHAL];
+	for (unsigned int nr = first; nr < end; ++nr) {
+	    for (unsigned int naz = 0; naz < Nphi; ++naz) {
+		const unsigned int i = (nr - first) * Nphi + naz;
+		profile.x[i] = radii[nr] * cos_phi[naz];
+		profile.y[i] = radii[nr] * sin_phi[naz];
+	    }
+	}
+    }
 
+    if (first >= end ||
+	!com_moved(profile.valid, profile.com_pos, profile.com_mass, com_pos,
+		   com_mass, RMIN)) {
+	return;
+    }
 
-	const unsigned int Naz = data[t_data::SIGMA].get_max_azimuthal();
-    const unsigned int nr = data[t_data::SIGMA].get_max_radial();
 	#pragma omp parallel for
-    for (unsigned int naz = 0; naz <= Naz; ++naz) {
-
-	{ /// V_PHI
-	    const double phi = ((double)naz - 0.5) * dphi;
-	    const double rmed = Rmed[nr];
-
-	    const double cell_x = rmed * std::cos(phi);
-	    const double cell_y = rmed * std::sin(phi);
-
-	    // Position in center of mass frame
-	    const double x_com = cell_x - com_pos.x;
-	    const double y_com = cell_y - com_pos.y;
-	    const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-	    // pressure support correction
-		double vazi0;
-	    double vr0;
-	    if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-	    } else {
-            if(parameters::v_azimuthal_with_quadropole_support){
-            vazi0 = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(r_com, com_mass);
-            } else { // no quadropole support
-            vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-            }
-			vr0 = viscous_speed::lookup_initial_vr_outer(r_com);
-	    }
+    for (unsigned int i = 0; i < (end - first) * Nphi; ++i) {
+	// Position in center of mass frame
+	const double x_com = profile.x[i] - com_pos.x;
+	const double y_com = profile.y[i] - com_pos.y;
+	const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
 
-	    // Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
+	double vazi0, vr0;
+	disk_model_velocity(profile, r_com, com_mass, vazi0, vr0);
 
-	    const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-	    const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
+	// Velocity in center of mass frame
+	profile.vx[i] = (vr0 * x_com - vazi0 * y_com) / r_com;
+	profile.vy[i] = (vr0 * y_com + vazi0 * x_com) / r_com;
+    }
 
-	    // shift velocity from center of mass frame to primary frame
-	    const double cell_vx = cell_vx_com + com_vel.x;
-	    const double cell_vy = cell_vy_com + com_vel.y;
+    profile.valid = true;
+    profile.com_pos = com_pos;
+    profile.com_mass = com_mass;
+}
 
-	    const double cell_vazi =
-		(cell_x * cell_vy - cell_vx * cell_y) / rmed;
-		vaz(nr, naz) = cell_vazi - refframe::OmegaFrame * rmed;
-	} /// END V_PHI
+static void update_profile(t_scalar_profile &profile, const unsigned int first,
+			   const unsigned int end, const Pair &com_pos,
+			   const double com_mass)
+{
+    const unsigned int Nphi = NAzimuthal;
+
+    if (first != profile.first || end != profile.end ||
+	IMIN != profile.imin || profile.sigma.empty()) {
+	profile.first = first;
+	profile.end = end;
+	profile.imin = IMIN;
+	profile.valid = false;
+	profile.sigma.resize((end - first) * Nphi);
+	profile.energy.resize((end - first) * Nphi);
+    }
 
-	{ /// V_R
-	    const double phi = (double)naz * dphi;
-	    const double rinf = Rinf[nr];
+    if (first >= end ||
+	!com_moved(profile.valid, profile.com_pos, profile.com_mass, com_pos,
+		   com_mass, RMIN)) {
+	return;
+    }
 
-	    const double cell_x = rinf * std::cos(phi);
-	    const double cell_y = rinf * std::sin(phi);
+	#pragma omp parallel for collapse(2)
+    for (unsigned int nr = first; nr < end; ++nr) {
+	for (unsigned int naz = 0; naz < Nphi; ++naz) {
+	    const unsigned int i = (nr - first) * Nphi + naz;
+	    const double cell_x = (*CellCenterX)(nr, naz);
+	    const double cell_y = (*CellCenterY)(nr, naz);
 
 	    // Position in center of mass frame
 	    const double x_com = cell_x - com_pos.x;
 	    const double y_com = cell_y - com_pos.y;
 	    const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
 
-	    // pressure support correction
-		double vazi0;
-	    double vr0;
-	    if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-		} else {
-            if(parameters::v_azimuthal_with_quadropole_support){
-            vazi0 = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(r_com, com_mass);
-            } else { // no quadropole support
-            vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-            }
-            vr0 = viscous_speed::lookup_initial_vr_outer(r_com);
-	    }
-
-	    // Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-	    const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-	    const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-	    // shift velocity from center of mass frame to primary frame
-	    const double cell_vx = cell_vx_com + com_vel.x;
-	    const double cell_vy = cell_vy_com + com_vel.y;
-
-	    const double cell_vr = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
-	    vrad(nr, naz) = cell_vr;
-	} /// END V_R
-
-	{ /// V_R GHOST CELL
-	    const double phi = (double)naz * dphi;
-	    const double rinf = Rsup[nr];
+	    // we assume the floor is not reached.
+	    profile.sigma[i] =
+		parameters::sigma0 * std::pow(r_com, -parameters::sigma_slope);
+	    /// Initial profile temperature
+	    profile.energy[i] = initial_energy(r_com, com_mass);
+	}
+    }
 
-	    const double cell_x = rinf * std::cos(phi);
-	    const double cell_y = rinf * std::sin(phi);
+    profile.valid = true;
+    profile.com_pos = com_pos;
+    profile.com_mass = com_mass;
+}
 
-	    // Position in center of mass frame
-	    const double x_com = cell_x - com_pos.x;
-	    const double y_com = cell_y - com_pos.y;
-	    const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
+/**
+	Disk model radial velocity of cell (nr, naz) in the primary frame.
+*/
+static inline double profile_vrad(const t_velocity_profile &profile,
+				  const unsigned int nr, const unsigned int naz,
+				  const Pair &com_vel)
+{
+    const unsigned int i = (nr - profile.first) * NAzimuthal + naz;
+    // shift velocity from center of mass frame to primary frame
+    const double cell_vx = profile.vx[i] + com_vel.x;
+    const double cell_vy = profile.vy[i] + com_vel.y;
+    return (profile.x[i] * cell_vx + profile.y[i] * cell_vy) / Rinf[nr];
+}
 
-	    // pressure support correction
-		double vazi0;
-	    double vr0;
-	    if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-		} else {
-            if(parameters::v_azimuthal_with_quadropole_support){
-            vazi0 = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(r_com, com_mass);
-            } else { // no quadropole support
-            vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-            }
-			vr0 = viscous_speed::lookup_initial_vr_outer(r_com);
-	    }
+/**
+	Disk model azimuthal velocity of cell (nr, naz) in the primary frame,
+	relative to the rotating frame.
+*/
+static inline double profile_vazi(const t_velocity_profile &profile,
+				  const unsigned int nr, const unsigned int naz,
+				  const Pair &com_vel)
+{
+    const unsigned int i = (nr - profile.first) * NAzimuthal + naz;
+    // shift velocity from center of mass frame to primary frame
+    const double cell_vx = profile.vx[i] + com_vel.x;
+    const double cell_vy = profile.vy[i] + com_vel.y;
+    const double rmed = Rmed[nr];
+    return (profile.x[i] * cell_vy - cell_vx * profile.y[i]) / rmed -
+	   refframe::OmegaFrame * rmed;
+}
 
-	    // Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
+static inline double energy_with_floor(const double cell_energy,
+				       const double cell_sigma)
+{
+    const double temperature_floor =
+	parameters::minimum_temperature *
+	units::temperature.get_cgs_to_code_factor();
 
-	    const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-	    const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
+    const double energy_floor = temperature_floor * cell_sigma /
+				parameters::MU * constants::R /
+				(parameters::ADIABATICINDEX - 1.0);
 
-	    // shift velocity from center of mass frame to primary frame
-	    const double cell_vx = cell_vx_com + com_vel.x;
-	    const double cell_vy = cell_vy_com + com_vel.y;
+    return std::max(cell_energy, energy_floor);
+}
 
-	    const double cell_vr = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
-	    vrad(nr + 1, naz) = cell_vr;
-	} /// END V_R GHOST CELL
 
-	{ /// DENSITY and ENERGY
-	    const double cell_x = (*CellCenterX)(nr, naz);
-	    const double cell_y = (*CellCenterY)(nr, naz);
+/**
+ * @brief initial_center_of_mass_boundary: sets the outer boundary
+ *  to the initial profile in the center of mass and then shifts it to the
+ * primary center. Lucas thinks this is important when simulating a circumbinary
+ * disk when the coordination system is centered on the primary.
+ * @param data
+ */
+void diskmodel_center_of_mass_boundary_outer(t_data &data)
+{
 
-	    // Position in center of mass frame
-	    const double x_com = cell_x - com_pos.x;
-	    const double y_com = cell_y - com_pos.y;
-	    const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
+    if (CPU_Rank != CPU_Highest) {
+		return;
+	}
 
-	    const double cell_sigma =
-		parameters::sigma0 *
-		std::pow(r_com,
-			 -parameters::sigma_slope); // we assume the floor is not reached.
-	    sigma(nr, naz) = cell_sigma;
+    const unsigned int np = data.get_planetary_system().get_number_of_planets();
+    const Pair com_pos = data.get_planetary_system().get_center_of_mass(np);
+    const Pair com_vel = data.get_planetary_system().get_center_of_mass_velocity(np);
+    const double com_mass = data.get_planetary_system().get_mass(np);
 
-	    /// Initial profile temperature
-	const double cell_energy = initial_energy(r_com, com_mass);
+    auto &sigma = data[t_data::SIGMA];
+    auto &energy = data[t_data::ENERGY];
+    auto &vrad = data[t_data::V_RADIAL];
+    auto &vaz = data[t_data::V_AZIMUTHAL];
 
-	const double temperature_floor =
-	    parameters::minimum_temperature *
-	    units::temperature.get_cgs_to_code_factor();
 
-	const double energy_floor = temperature_floor * cell_sigma /
-				    parameters::MU * constants::R /
-				    (parameters::ADIABATICINDEX - 1.0);
+	const unsigned int Naz = data[t_data::SIGMA].get_max_azimuthal();
+    const unsigned int nr = data[t_data::SIGMA].get_max_radial();
 
-	energy(nr, naz) = std::max(cell_energy, energy_floor);
+    // the ghost cell interface Rsup[nr] is Rinf[nr + 1]
+    update_profile(outer_boundary_vazi, nr, nr + 1, com_pos, com_mass);
+    update_profile(outer_boundary_vrad, nr, nr + 2, com_pos, com_mass);
+    update_profile(outer_boundary_scalar, nr, nr + 1, com_pos, com_mass);
 
-	    /// dP / dr = 0
-		/// energy(nr, naz) = energy(nr - 1, naz);
-	} /// END DENSITY and ENERGY
+	#pragma omp parallel for
+    for (unsigned int naz = 0; naz <= Naz; ++naz) {
+	vaz(nr, naz) = profile_vazi(outer_boundary_vazi, nr, naz, com_vel);
+	vrad(nr, naz) = profile_vrad(outer_boundary_vrad, nr, naz, com_vel);
+	vrad(nr + 1, naz) =
+	    profile_vrad(outer_boundary_vrad, nr + 1, naz, com_vel);
+
+	const unsigned int i = (nr - outer_boundary_scalar.first) * NAzimuthal + naz;
+	const double cell_sigma = outer_boundary_scalar.sigma[i];
+	sigma(nr, naz) = cell_sigma;
+	energy(nr, naz) =
+	    energy_with_floor(outer_boundary_scalar.energy[i], cell_sigma);
     }
 }
 
@@ -243,162 +359,24 @@ void diskmodel_center_of_mass_boundary_inner(t_data &data)
 	auto &vaz = data[t_data::V_AZIMUTHAL];
 
 	const unsigned int nr = 0;
+
+	update_profile(inner_boundary_vazi, nr, nr + 1, com_pos, com_mass);
+	update_profile(inner_boundary_vrad, nr, nr + 2, com_pos, com_mass);
+	update_profile(inner_boundary_scalar, nr, nr + 1, com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int naz = 0; naz <= data[t_data::SIGMA].get_max_azimuthal();
 	 ++naz) {
-
-	{ /// V_PHI
-		const double phi = ((double)naz - 0.5) * dphi;
-		const double rmed = Rmed[nr];
-
-		const double cell_x = rmed * std::cos(phi);
-		const double cell_y = rmed * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vazi0;
-		double vr0;
-		if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-		} else {
-			vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-			vr0 = viscous_speed::lookup_initial_vr_inner(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-		const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double cell_vazi =
-		(cell_x * cell_vy - cell_vx * cell_y) / rmed;
-		vaz(nr, naz) = cell_vazi - refframe::OmegaFrame * rmed;
-	} /// END V_PHI
-
-	{ /// V_R GHOST CELL
-		const double phi = (double)naz * dphi;
-		const double rinf = Rinf[nr];
-
-		const double cell_x = rinf * std::cos(phi);
-		const double cell_y = rinf * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vazi0;
-		double vr0;
-		if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-		} else {
-			vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-			vr0 = viscous_speed::lookup_initial_vr_inner(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-		const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double cell_vr = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
-		vrad(nr, naz) = cell_vr;
-	} /// END V_R
-
-	{ /// V_R
-		const double phi = (double)naz * dphi;
-		const double rinf = Rsup[nr];
-
-		const double cell_x = rinf * std::cos(phi);
-		const double cell_y = rinf * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vazi0;
-		double vr0;
-		if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-		} else {
-			vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-			vr0 = viscous_speed::lookup_initial_vr_inner(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-		const double cell_vx_com =
-		(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-		(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double cell_vr = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
-		vrad(nr + 1, naz) = cell_vr;
-	} /// END V_R GHOST CELL
-
-	{ /// DENSITY and ENERGY
-		const double cell_x = (*CellCenterX)(nr, naz);
-		const double cell_y = (*CellCenterY)(nr, naz);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		const double cell_sigma =
-		parameters::sigma0 *
-		std::pow(r_com,
-			 -parameters::sigma_slope); // we assume the floor is not reached.
-		sigma(nr, naz) = cell_sigma;
-
-		/// Initial profile temperature
-	const double cell_energy = initial_energy(r_com, com_mass);
-
-	const double temperature_floor =
-		parameters::minimum_temperature *
-		units::temperature.get_cgs_to_code_factor();
-
-	const double energy_floor = temperature_floor * cell_sigma /
-					parameters::MU * constants::R /
-					(parameters::ADIABATICINDEX - 1.0);
-
-	energy(nr, naz) = std::max(cell_energy, energy_floor);
-
-		/// dP / dr = 0
-		/// energy(nr, naz) = energy(nr - 1, naz);
-	} /// END DENSITY and ENERGY
+	vaz(nr, naz) = profile_vazi(inner_boundary_vazi, nr, naz, com_vel);
+	vrad(nr, naz) = profile_vrad(inner_boundary_vrad, nr, naz, com_vel);
+	vrad(nr + 1, naz) =
+	    profile_vrad(inner_boundary_vrad, nr + 1, naz, com_vel);
+
+	const unsigned int i = naz;
+	const double cell_sigma = inner_boundary_scalar.sigma[i];
+	sigma(nr, naz) = cell_sigma;
+	energy(nr, naz) =
+	    energy_with_floor(inner_boundary_scalar.energy[i], cell_sigma);
 	}
 }
 
@@ -427,6 +405,9 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
     const double tau = damping_time_factor * 2.0 * M_PI /
 			 calculate_omega_kepler(damping_time_radius_outer);
 
+	update_profile(outer_damping_vrad, clamped_vrad_id, MaxMo_no_ghost_vr,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int n_radial = clamped_vrad_id;
 		 n_radial < MaxMo_no_ghost_vr; ++n_radial) {
@@ -438,51 +419,8 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
 
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < vrad_arr.get_size_azimuthal(); ++n_azimuthal) {
-
-		const double phi = (double)n_azimuthal * dphi;
-		const double rinf = Rinf[n_radial];
-
-		const double cell_x = rinf * std::cos(phi);
-		const double cell_y = rinf * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vr_init;
-		double vazi_init;
-		if (parameters::initialize_pure_keplerian) {
-			vazi_init = compute_v_kepler(r_com, com_mass);
-			if(parameters::initialize_vradial_zero){
-				vr_init = 0.0;
-			} else {
-			vr_init = initial_viscous_radial_speed(r_com, com_mass);
-			}
-		} else {
-            if(parameters::v_azimuthal_with_quadropole_support){
-            vazi_init = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(r_com, com_mass);
-            } else { // no quadropole support
-            vazi_init = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-            }
-			vr_init = viscous_speed::lookup_initial_vr_outer(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi_init;
-		const double cell_vr_com = vr_init;
-
-		const double cell_vx_com =
-		    (cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-		    (cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double vr0 = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
+		const double vr0 = profile_vrad(outer_damping_vrad, n_radial,
+						n_azimuthal, com_vel);
 
 		const double vr = vrad_arr(n_radial, n_azimuthal);
 		const double vr_new = (vr - vr0) * exp_factor + vr0;
@@ -494,6 +432,9 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
 		get_rmed_id(RMAX * damping_outer_limit),
 		vazi_arr.is_vector()) + 1;
 
+	update_profile(outer_damping_vazi, clamped_vazi_id, Max_no_ghost,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int n_radial = clamped_vazi_id;
 		 n_radial < Max_no_ghost; ++n_radial) {
@@ -505,52 +446,8 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
 
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < vazi_arr.get_size_azimuthal(); ++n_azimuthal) {
-
-		const double phi = ((double)n_azimuthal - 0.5) * dphi;
-		const double rmed = Rmed[n_radial];
-
-		const double cell_x = rmed * std::cos(phi);
-		const double cell_y = rmed * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vazi0;
-		double vr0;
-		if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			if(parameters::initialize_vradial_zero){
-				vr0 = 0.0;
-			} else {
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-			}
-		} else {
-            if(parameters::v_azimuthal_with_quadropole_support){
-            vazi0 = initial_locally_isothermal_smoothed_v_az_with_quadropole_moment(r_com, com_mass);
-            } else { // no quadropole support
-            vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-            }
-			vr0 = viscous_speed::lookup_initial_vr_outer(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-		const double cell_vx_com =
-		    (cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-		    (cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double vp0 = (cell_x * cell_vy - cell_vx * cell_y) / rmed -
-				refframe::OmegaFrame * rmed;
+		const double vp0 = profile_vazi(outer_damping_vazi, n_radial,
+						n_azimuthal, com_vel);
 
 		const double vp = vazi_arr(n_radial, n_azimuthal);
 		const double vp_new = (vp - vp0) * exp_factor + vp0;
@@ -560,7 +457,9 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
 
 	if (parameters::Adiabatic){
 	t_polargrid &energy = data[t_data::ENERGY];
-	//t_polargrid &sigma = data[t_data::DENSITY];
+	update_profile(outer_damping_scalar, clamped_vazi_id, Max_no_ghost,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int nr = clamped_vazi_id;
 		 nr < Max_no_ghost; ++nr) {
@@ -572,18 +471,9 @@ void damping_diskmodel_center_of_mass_outer(t_data &data, double dt)
 
 		for (unsigned int naz = 0;
 		 naz < energy.get_size_azimuthal(); ++naz) {
-	const double cell_x = (*CellCenterX)(nr, naz);
-	const double cell_y = (*CellCenterY)(nr, naz);
-
-	// Position in center of mass frame
-	const double x_com = cell_x - com_pos.x;
-	const double y_com = cell_y - com_pos.y;
-	const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-	/// Initial profile temperature
-	const double cell_energy_profile = initial_energy(r_com, com_mass);
-
-	const double cell_energy0 = cell_energy_profile;
+	const double cell_energy0 =
+	    outer_damping_scalar
+		.energy[(nr - outer_damping_scalar.first) * NAzimuthal + naz];
 
 	const double cell_energy = energy(nr, naz);
 	const double energy_new = (cell_energy - cell_energy0) * exp_factor + cell_energy0;
@@ -618,6 +508,9 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 	double tau = damping_time_factor * 2.0 * M_PI /
 			 calculate_omega_kepler(RMIN);
 
+	update_profile(inner_damping_vrad, One_no_ghost_vr, clamped_vrad_id + 1,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int n_radial = One_no_ghost_vr;
 		 n_radial <= clamped_vrad_id; ++n_radial) {
@@ -629,47 +522,8 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 
 		for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < vrad_arr.get_size_azimuthal(); ++n_azimuthal) {
-
-		const double phi = (double)n_azimuthal * dphi;
-		const double rinf = Rinf[n_radial];
-
-		const double cell_x = rinf * std::cos(phi);
-		const double cell_y = rinf * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vr_init;
-		double vazi_init;
-		if (parameters::initialize_pure_keplerian) {
-			vazi_init = compute_v_kepler(r_com, com_mass);
-			if(parameters::initialize_vradial_zero){
-				vr_init = 0.0;
-			} else {
-			vr_init = initial_viscous_radial_speed(r_com, com_mass);
-			}
-		} else {
-			vazi_init = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-			vr_init = viscous_speed::lookup_initial_vr_inner(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi_init;
-		const double cell_vr_com = vr_init;
-
-		const double cell_vx_com =
-			(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-			(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double vr0 = (cell_x * cell_vx + cell_y * cell_vy) / rinf;
+		const double vr0 = profile_vrad(inner_damping_vrad, n_radial,
+						n_azimuthal, com_vel);
 
 		const double vr = vrad_arr(n_radial, n_azimuthal);
 		const double vr_new = (vr - vr0) * exp_factor + vr0;
@@ -681,6 +535,9 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 		get_rmed_id(RMIN * damping_inner_limit),
 		vazi_arr.is_vector());
 
+	update_profile(inner_damping_vazi, Zero_no_ghost, clamped_vazi_id + 1,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int n_radial = Zero_no_ghost;
 		 n_radial <= clamped_vazi_id; ++n_radial) {
@@ -692,48 +549,8 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 
 		for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < vazi_arr.get_size_azimuthal(); ++n_azimuthal) {
-
-		const double phi = ((double)n_azimuthal - 0.5) * dphi;
-		const double rmed = Rmed[n_radial];
-
-		const double cell_x = rmed * std::cos(phi);
-		const double cell_y = rmed * std::sin(phi);
-
-		// Position in center of mass frame
-		const double x_com = cell_x - com_pos.x;
-		const double y_com = cell_y - com_pos.y;
-		const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-		// pressure support correction
-		double vazi0;
-		double vr0;
-		if (parameters::initialize_pure_keplerian) {
-			vazi0 = compute_v_kepler(r_com, com_mass);
-			if(parameters::initialize_vradial_zero){
-				vr0 = 0.0;
-			} else {
-			vr0 = initial_viscous_radial_speed(r_com, com_mass);
-			}
-		} else {
-			vazi0 = initial_locally_isothermal_smoothed_v_az(r_com, com_mass);
-			vr0 = viscous_speed::lookup_initial_vr_inner(r_com);
-		}
-
-		// Velocity in center of mass frame
-		const double cell_vazi_com = vazi0;
-		const double cell_vr_com = vr0;
-
-		const double cell_vx_com =
-			(cell_vr_com * x_com - cell_vazi_com * y_com) / r_com;
-		const double cell_vy_com =
-			(cell_vr_com * y_com + cell_vazi_com * x_com) / r_com;
-
-		// shift velocity from center of mass frame to primary frame
-		const double cell_vx = cell_vx_com + com_vel.x;
-		const double cell_vy = cell_vy_com + com_vel.y;
-
-		const double vp0 = (cell_x * cell_vy - cell_vx * cell_y) / rmed -
-				refframe::OmegaFrame * rmed;
+		const double vp0 = profile_vazi(inner_damping_vazi, n_radial,
+						n_azimuthal, com_vel);
 
 		const double vp = vazi_arr(n_radial, n_azimuthal);
 		const double vp_new = (vp - vp0) * exp_factor + vp0;
@@ -743,7 +560,9 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 
 	if (parameters::Adiabatic){
 	t_polargrid &energy = data[t_data::ENERGY];
-	//t_polargrid &sigma = data[t_data::DENSITY];
+	update_profile(inner_damping_scalar, Zero_no_ghost, clamped_vazi_id + 1,
+		       com_pos, com_mass);
+
 	#pragma omp parallel for
 	for (unsigned int nr = Zero_no_ghost;
 		 nr <= clamped_vazi_id; ++nr) {
@@ -755,18 +574,9 @@ void damping_diskmodel_center_of_mass_inner(t_data &data, double dt)
 
 		for (unsigned int naz = 0;
 		 naz < energy.get_size_azimuthal(); ++naz) {
-	const double cell_x = (*CellCenterX)(nr, naz);
-	const double cell_y = (*CellCenterY)(nr, naz);
-
-	// Position in center of mass frame
-	const double x_com = cell_x - com_pos.x;
-	const double y_com = cell_y - com_pos.y;
-	const double r_com = std::sqrt(x_com * x_com + y_com * y_com);
-
-	/// Initial profile temperature
-	const double cell_energy_profile = initial_energy(r_com, com_mass);
-
-	const double cell_energy0 = cell_energy_profile;
+	const double cell_energy0 =
+	    inner_damping_scalar
+		.energy[(nr - inner_damping_scalar.first) * NAzimuthal + naz];
 
 	const double cell_energy = energy(nr, naz);
 	const double energy_new = (cell_energy - cell_energy0) * exp_factor + cell_energy0;
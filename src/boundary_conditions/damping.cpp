@@ -11,6 +11,8 @@
 #include "../parameters.h"
 #include "../find_cell_id.h"
 #include "../global.h"
+#include "../radial_profile.h"
+#include "../reduction.h"
 #include "../Theo.h"
 #include "../util.h"
 #include "../SourceEuler.h"
@@ -31,6 +33,7 @@ double damping_inner_limit;
 double damping_outer_limit;
 double damping_time_factor;
 double damping_time_radius_outer;
+double boundary_profile_tolerance;
 
 int damping_energy_id;
 
@@ -199,6 +202,9 @@ void damping_config() {
     damping_time_radius_outer =
 	config::cfg.get<double>("DampingTimeRadiusOuter", RMAX);
 
+    boundary_profile_tolerance =
+	config::cfg.get<double>("BoundaryProfileTolerance", 1.0e-3);
+
     if(damping_enabled){
     logging::print_master(
 	"DampingTimeFactor: %.3e Outer damping time is computed at radius of %.3e\n",
@@ -308,6 +314,39 @@ void copy_initial_values(t_data &data) {
     }
 }
 
+/**
+	Buffer for the mass created and removed by the wave damping in every
+	local ring. Each ring is summed by one thread in azimuthal order and the
+	rings are combined in radial order, as in reduction::sum_local, so the
+	totals do not depend on the number of threads.
+*/
+static std::vector<double> &damping_ring_sums()
+{
+    static std::vector<double> ring_sums;
+    ring_sums.assign(2 * radial_active_size, 0.0);
+    return ring_sums;
+}
+
+static void store_damping_ring_sums(std::vector<double> &ring_sums,
+				    const unsigned int n_radial,
+				    const double created, const double removed)
+{
+    // only active cells count, ghost rings are summed by their owner
+    if (radial_first_active <= n_radial && n_radial < radial_active_size) {
+	ring_sums[2 * n_radial] = created;
+	ring_sums[2 * n_radial + 1] = removed;
+    }
+}
+
+static void add_damping_mass(const std::vector<double> &ring_sums,
+			     double &creation, double &removal)
+{
+    double result[2];
+    reduction::combine_local_ring_sums(ring_sums, 2, result);
+    creation += result[0];
+    removal += result[1];
+}
+
 void damping_single_inner(t_polargrid &quantity, t_polargrid &quantity0,
 			  double dt)
 {
@@ -331,11 +370,9 @@ void damping_single_inner(t_polargrid &quantity, t_polargrid &quantity0,
     const double tau = damping_time_factor * 2.0 * M_PI /
 		     calculate_omega_kepler(RMIN);
 
-	// Needed for OpenMP to work
-	double &InnerWaveDampingMassCreation = MassDelta.InnerWaveDampingMassCreation;
-	double &InnerWaveDampingMassRemoval = MassDelta.InnerWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : InnerWaveDampingMassCreation, InnerWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = 0; n_radial <= limit; ++n_radial) {
 	    double factor = std::pow(
 		(radius[n_radial] - RMIN * damping_inner_limit) /
@@ -343,6 +380,8 @@ void damping_single_inner(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
 	    double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
         const double X = quantity(n_radial, n_azimuthal);
@@ -352,16 +391,18 @@ void damping_single_inner(t_polargrid &quantity, t_polargrid &quantity0,
         const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(InnerWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(InnerWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.InnerWaveDampingMassCreation,
+			     MassDelta.InnerWaveDampingMassRemoval);
 	}
     }
 }
@@ -390,11 +431,9 @@ void damping_single_outer(t_polargrid &quantity, t_polargrid &quantity0,
 	double tau = damping_time_factor * 2.0 * M_PI /
 			 calculate_omega_kepler(damping_time_radius_outer);
 
-	// Needed for OpenMP to work
-	double &OuterWaveDampingMassCreation = MassDelta.OuterWaveDampingMassCreation;
-	double &OuterWaveDampingMassRemoval = MassDelta.OuterWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : OuterWaveDampingMassCreation, OuterWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = limit;
 	     n_radial < quantity.get_size_radial(); ++n_radial) {
 	    double factor = std::pow(
@@ -403,6 +442,8 @@ void damping_single_outer(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
 	    double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
         const double X = quantity(n_radial, n_azimuthal);
@@ -412,16 +453,18 @@ void damping_single_outer(t_polargrid &quantity, t_polargrid &quantity0,
         const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(OuterWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(OuterWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.OuterWaveDampingMassCreation,
+			     MassDelta.OuterWaveDampingMassRemoval);
 	}
     }
 }
@@ -450,11 +493,9 @@ void damping_single_inner_zero(t_polargrid &quantity, t_polargrid &quantity0,
     const double tau = damping_time_factor * 2.0 * M_PI /
 		     calculate_omega_kepler(RMIN);
 
-	// Needed for OpenMP to work
-	double &InnerWaveDampingMassCreation = MassDelta.InnerWaveDampingMassCreation;
-	double &InnerWaveDampingMassRemoval = MassDelta.InnerWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : InnerWaveDampingMassCreation, InnerWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = 0; n_radial <= limit; ++n_radial) {
 	    double factor = std::pow(
 		(radius[n_radial] - RMIN * damping_inner_limit) /
@@ -462,6 +503,8 @@ void damping_single_inner_zero(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
 	    double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
 		const double X = quantity(n_radial, n_azimuthal);
@@ -476,16 +519,18 @@ void damping_single_inner_zero(t_polargrid &quantity, t_polargrid &quantity0,
 		const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(InnerWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(InnerWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.InnerWaveDampingMassCreation,
+			     MassDelta.InnerWaveDampingMassRemoval);
 	}
     }
 }
@@ -516,11 +561,9 @@ void damping_single_outer_zero(t_polargrid &quantity, t_polargrid &quantity0,
     const double tau = damping_time_factor * 2.0 * M_PI /
 			 calculate_omega_kepler(damping_time_radius_outer);
 
-	// Needed for OpenMP to work
-	double &OuterWaveDampingMassCreation = MassDelta.OuterWaveDampingMassCreation;
-	double &OuterWaveDampingMassRemoval = MassDelta.OuterWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : OuterWaveDampingMassCreation, OuterWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = limit;
 	     n_radial < quantity.get_size_radial(); ++n_radial) {
 	    double factor = std::pow(
@@ -529,6 +572,8 @@ void damping_single_outer_zero(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
 	    double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
 		const double X = quantity(n_radial, n_azimuthal);
@@ -538,16 +583,18 @@ void damping_single_outer_zero(t_polargrid &quantity, t_polargrid &quantity0,
 		const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(OuterWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(OuterWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.OuterWaveDampingMassCreation,
+			     MassDelta.OuterWaveDampingMassRemoval);
 	}
     }
 }
@@ -576,20 +623,16 @@ void damping_single_inner_mean(t_polargrid &quantity, t_polargrid &quantity0,
 		     calculate_omega_kepler(RMIN);
 
 	// get mean quantity
+	std::vector<double> mean(limit + 1);
+	radial_profile::reduce(quantity, radial_profile::reduction_mean, 0,
+			       limit + 1, mean.data());
 	for (unsigned int n_radial = 0; n_radial <= limit; ++n_radial) {
-	    quantity0(n_radial, 0) = 0.0;
-	    for (unsigned int n_azimuthal = 0;
-		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
-		quantity0(n_radial, 0) += quantity(n_radial, n_azimuthal);
-	    }
-	    quantity0(n_radial, 0) /= quantity.get_size_azimuthal();
+	    quantity0(n_radial, 0) = mean[n_radial];
 	}
 
-	// Needed for OpenMP to work, OpenMP want a local variable for reduction
-	double &InnerWaveDampingMassCreation = MassDelta.InnerWaveDampingMassCreation;
-	double &InnerWaveDampingMassRemoval = MassDelta.InnerWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : InnerWaveDampingMassCreation, InnerWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = 0; n_radial <= limit; ++n_radial) {
 	    double factor = std::pow(
 		(radius[n_radial] - RMIN * damping_inner_limit) /
@@ -597,6 +640,8 @@ void damping_single_inner_mean(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
         const double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
         const double X = quantity(n_radial, n_azimuthal);
@@ -606,16 +651,18 @@ void damping_single_inner_mean(t_polargrid &quantity, t_polargrid &quantity0,
         const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(InnerWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(InnerWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.InnerWaveDampingMassCreation,
+			     MassDelta.InnerWaveDampingMassRemoval);
 	}
     }
 }
@@ -634,8 +681,7 @@ void damping_vradial_inner_visc(t_polargrid &vrad, t_polargrid &viscosity,
 	(rinf[0] < RMIN * damping_inner_limit)) {
 	// find range
 
-	const static unsigned int limit =
-	    get_rinf_id(RMIN * damping_inner_limit);
+	const unsigned int limit = get_rinf_id(RMIN * damping_inner_limit);
 
 	const double tau = damping_time_factor * 2.0 * M_PI /
 			   calculate_omega_kepler(RMIN);
@@ -701,21 +747,17 @@ void damping_single_outer_mean(t_polargrid &quantity, t_polargrid &quantity0,
     const double tau = damping_time_factor * 2.0 * M_PI /
 			 calculate_omega_kepler(damping_time_radius_outer);
 
+	std::vector<double> mean(quantity.get_size_radial() - limit);
+	radial_profile::reduce(quantity, radial_profile::reduction_mean, limit,
+			       quantity.get_size_radial(), mean.data());
 	for (unsigned int n_radial = limit;
 	     n_radial < quantity.get_size_radial(); ++n_radial) {
-	    quantity0(n_radial, 0) = 0.0;
-	    for (unsigned int n_azimuthal = 0;
-		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
-		quantity0(n_radial, 0) += quantity(n_radial, n_azimuthal);
-	    }
-	    quantity0(n_radial, 0) /= quantity.get_size_azimuthal();
+	    quantity0(n_radial, 0) = mean[n_radial - limit];
 	}
 
-	// Needed for OpenMP to work
-	double &OuterWaveDampingMassCreation = MassDelta.OuterWaveDampingMassCreation;
-	double &OuterWaveDampingMassRemoval = MassDelta.OuterWaveDampingMassRemoval;
+	std::vector<double> &ring_sums = damping_ring_sums();
 
-	#pragma omp parallel for reduction (+ : OuterWaveDampingMassCreation, OuterWaveDampingMassRemoval)
+	#pragma omp parallel for
 	for (unsigned int n_radial = limit;
 	     n_radial < quantity.get_size_radial(); ++n_radial) {
         const double factor = std::pow(
@@ -724,6 +766,8 @@ void damping_single_outer_mean(t_polargrid &quantity, t_polargrid &quantity0,
 		2);
         const double exp_factor = std::exp(-dt * factor / tau);
 
+	    double created = 0.0;
+	    double removed = 0.0;
 	    for (unsigned int n_azimuthal = 0;
 		 n_azimuthal < quantity.get_size_azimuthal(); ++n_azimuthal) {
         const double X = quantity(n_radial, n_azimuthal);
@@ -733,16 +777,18 @@ void damping_single_outer_mean(t_polargrid &quantity, t_polargrid &quantity0,
         const double delta = Xnew - X;
 		if (is_density) {
 		    if (delta > 0) {
-			sum_without_ghost_cells(OuterWaveDampingMassCreation,
-						delta * Surf[n_radial],
-						n_radial);
+			created += delta * Surf[n_radial];
 		    } else {
-			sum_without_ghost_cells(OuterWaveDampingMassRemoval,
-						-delta * Surf[n_radial],
-						n_radial);
+			removed += -delta * Surf[n_radial];
 		    }
 		}
 	    }
+	    store_damping_ring_sums(ring_sums, n_radial, created, removed);
+	}
+
+	if (is_density) {
+	    add_damping_mass(ring_sums, MassDelta.OuterWaveDampingMassCreation,
+			     MassDelta.OuterWaveDampingMassRemoval);
 	}
     }
 }
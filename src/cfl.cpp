@@ -205,7 +205,7 @@ double condition_cfl(t_data &data, const double dt_global_input)
 	}
 
 	const double denom = fabs(v_mean[0]*InvRmed[0] - v_mean[1]*InvRmed[1]) + 1.0e-100;
-	double dt_core = parameters::CFL * dphi / denom;
+	double dt_core = parameters::axisymmetric ? std::numeric_limits<double>::max() : parameters::CFL * dphi / denom;
 
 	#pragma omp parallel for reduction(min : dt_core, dt_parabolic_local)
 	for (unsigned int nr = radial_first_active;
@@ -215,6 +215,11 @@ double condition_cfl(t_data &data, const double dt_global_input)
 							 v_mean[nr + 1] * InvRmed[nr + 1]) + 1.0e-100;
 		double shear_dt = parameters::CFL * dphi / denom;
 
+		// there is no azimuthal transport with a single azimuthal cell
+		if (parameters::axisymmetric) {
+			shear_dt = std::numeric_limits<double>::max();
+		}
+
 		if (shear_dt < dt_core){
 			dt_core = shear_dt;
 		}
@@ -249,7 +254,7 @@ double condition_cfl(t_data &data, const double dt_global_input)
 
 		// residual circular motion limit
 		// we do not need abs() because only square of it is used later
-		const double invdt3 = v_residual[cell_number(nr, naz, v_azimuthal.get_size_azimuthal())] / dxAzimuthal;
+		const double invdt3 = parameters::axisymmetric ? 0.0 : v_residual[cell_number(nr, naz, v_azimuthal.get_size_azimuthal())] / dxAzimuthal;
 
 		double leapfrog_cfl_factor;
 		if (parameters::hydro_integrator == LEAPFROG_INTEGRATOR){
@@ -376,7 +381,7 @@ double condition_cfl(t_data &data, const double dt_global_input)
 	}
 
 	double dt_global;
-	MPI_Allreduce(&dt_core, &dt_global, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+	MPI_Allreduce(&dt_core, &dt_global, 1, MPI_DOUBLE, MPI_MIN, CPU_Comm);
 
 	return dt_global;
 }
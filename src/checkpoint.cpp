@@ -0,0 +1,419 @@
+/**
+	\file checkpoint.cpp
+
+	Single file container for the 2D polargrids of a snapshot.
+
+	Layout of checkpoint.bin (native byte order):
+	  t_header       magic, version, grid size, number of fields, misc data
+	  t_field_entry  name, byte offset, number of rings and checksum of
+	                 every field
+	  field data     global (n_rings x NAzimuthal) arrays of doubles, each
+	                 starting at a multiple of 4096 bytes so they can be
+	                 memory mapped directly
+
+	The field data is stored in global ring order, so the file can be read
+	with any number of processes. All fields are written with one collective
+	MPI-IO call, every process reads only the rings it needs.
+
+	The checksum of a field is the XOR of the FNV-1a hashes of its rings,
+	seeded with the ring index. It does not depend on the domain
+	decomposition.
+*/
+
+#include "checkpoint.h"
+#include "LowTasks.h"
+#include "global.h"
+#include "logging.h"
+#include "mpi_utils.h"
+#include "output.h"
+#include "snapshot_writer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <mpi.h>
+
+namespace checkpoint
+{
+
+static const char file_magic[8] = {'F', 'C', 'P', 'T', 'C', 'K', 'P', 'T'};
+static const std::uint32_t file_version = 1;
+static const std::uint64_t data_alignment = 4096;
+
+struct t_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_fields;
+    std::uint64_t n_radial;
+    std::uint64_t n_azimuthal;
+    output::misc_entry misc;
+};
+
+struct t_field_entry {
+    char name[32];
+    std::uint64_t offset;
+    std::uint64_t n_rings;
+    std::uint64_t checksum;
+};
+
+static std::string filename(const std::string &directory)
+{
+    return directory + "/checkpoint.bin";
+}
+
+bool exists(const std::string &directory)
+{
+    return std::filesystem::exists(filename(directory));
+}
+
+/**
+	Local rings [first, end) of grid written by this process. Every global
+	ring is written by exactly one process, as in t_polargrid::write2D.
+*/
+static void owned_rings(const t_polargrid &grid, unsigned int &first,
+			unsigned int &end)
+{
+    first = Zero_or_active;
+    end = Max_or_active;
+    if (grid.is_vector() && CPU_Rank == CPU_Highest) {
+	end += 1;
+    }
+}
+
+static std::uint64_t ring_checksum(const double *values,
+				   const unsigned int count,
+				   const std::uint64_t ring)
+{
+    std::uint64_t hash =
+	14695981039346656037ULL ^ (ring * 0x9E3779B97F4A7C15ULL);
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(values);
+    for (std::size_t i = 0; i < count * sizeof(double); ++i) {
+	hash ^= bytes[i];
+	hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+	Checksums of all grids, combined over all processes.
+*/
+static std::vector<std::uint64_t>
+compute_checksums(const std::vector<t_polargrid *> &grids)
+{
+    std::vector<std::uint64_t> checksums(grids.size(), 0);
+
+    for (unsigned int i = 0; i < grids.size(); ++i) {
+	const t_polargrid &grid = *grids[i];
+	unsigned int first, end;
+	owned_rings(grid, first, end);
+
+	std::uint64_t checksum = 0;
+	#pragma omp parallel for reduction(^ : checksum)
+	for (unsigned int nr = first; nr < end; ++nr) {
+	    checksum ^= ring_checksum(&grid.Field[nr * grid.Nsec], grid.Nsec,
+				      IMIN + nr);
+	}
+	checksums[i] = checksum;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, checksums.data(), checksums.size(),
+		  MPI_UINT64_T, MPI_BXOR, CPU_Comm);
+
+    return checksums;
+}
+
+/**
+	Write or read the local rings [first[i], end[i]) of all grids with a
+	single collective call. file_offsets must be increasing.
+*/
+static void transfer(MPI_File fh, const std::vector<t_polargrid *> &grids,
+		     const std::vector<std::uint64_t> &file_offsets,
+		     const std::vector<unsigned int> &first,
+		     const std::vector<unsigned int> &end, const bool write)
+{
+    const unsigned int n = grids.size();
+    std::vector<int> lengths(n);
+    std::vector<MPI_Aint> file_displacements(n);
+    std::vector<MPI_Aint> memory_displacements(n);
+
+    for (unsigned int i = 0; i < n; ++i) {
+	const t_polargrid &grid = *grids[i];
+	lengths[i] = (end[i] - first[i]) * grid.Nsec;
+	file_displacements[i] =
+	    file_offsets[i] + (IMIN + first[i]) * grid.Nsec * sizeof(double);
+	MPI_Get_address(&grid.Field[first[i] * grid.Nsec],
+			&memory_displacements[i]);
+    }
+
+    MPI_Datatype file_type, memory_type;
+    MPI_Type_create_hindexed(n, lengths.data(), file_displacements.data(),
+			     MPI_DOUBLE, &file_type);
+    MPI_Type_commit(&file_type);
+    MPI_Type_create_hindexed(n, lengths.data(), memory_displacements.data(),
+			     MPI_DOUBLE, &memory_type);
+    MPI_Type_commit(&memory_type);
+
+    MPI_File_set_view(fh, 0, MPI_DOUBLE, file_type,
+		      const_cast<char *>("native"), MPI_INFO_NULL);
+
+    MPI_Status status;
+    if (write) {
+	MPI_File_write_all(fh, MPI_BOTTOM, 1, memory_type, &status);
+    } else {
+	MPI_File_read_all(fh, MPI_BOTTOM, 1, memory_type, &status);
+    }
+
+    MPI_Type_free(&file_type);
+    MPI_Type_free(&memory_type);
+}
+
+void write(t_data &data, const std::string &directory)
+{
+    std::vector<t_polargrid *> grids;
+    for (unsigned int i = 0; i < t_data::N_POLARGRID_TYPES; ++i) {
+	t_polargrid &grid = data[(t_data::t_polargrid_type)i];
+	if (grid.get_write_2D()) {
+	    grids.push_back(&grid);
+	}
+    }
+
+    const std::vector<std::uint64_t> checksums = compute_checksums(grids);
+
+    t_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.n_fields = grids.size();
+    header.n_radial = GlobalNRadial;
+    header.n_azimuthal = NAzimuthal;
+    header.misc = output::get_misc();
+
+    std::vector<t_field_entry> table(grids.size());
+    std::vector<std::uint64_t> offsets(grids.size());
+    std::vector<unsigned int> first(grids.size()), end(grids.size());
+
+    std::uint64_t offset =
+	sizeof(t_header) + grids.size() * sizeof(t_field_entry);
+    for (unsigned int i = 0; i < grids.size(); ++i) {
+	offset = (offset + data_alignment - 1) / data_alignment * data_alignment;
+
+	memset(&table[i], 0, sizeof(t_field_entry));
+	strncpy(table[i].name, grids[i]->get_name(), sizeof(table[i].name) - 1);
+	table[i].offset = offset;
+	table[i].n_rings = grids[i]->is_scalar() ? GlobalNRadial : GlobalNRadial + 1;
+	table[i].checksum = checksums[i];
+
+	offsets[i] = offset;
+	owned_rings(*grids[i], first[i], end[i]);
+
+	offset += table[i].n_rings * NAzimuthal * sizeof(double);
+    }
+
+    const std::string file = filename(directory);
+    MPI_File fh;
+    mpi_error_check_file_write(MPI_File_open(CPU_Comm, file.c_str(),
+					     MPI_MODE_WRONLY | MPI_MODE_CREATE,
+					     snapshot_writer::get_info(), &fh),
+			       file);
+    MPI_File_set_size(fh, 0);
+
+    if (CPU_Master) {
+	MPI_Status status;
+	MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, &status);
+	MPI_File_write_at(fh, sizeof(header), table.data(),
+			  table.size() * sizeof(t_field_entry), MPI_BYTE,
+			  &status);
+    }
+
+    transfer(fh, grids, offsets, first, end, true);
+
+    MPI_File_close(&fh);
+}
+
+static void open_for_reading(const std::string &file, MPI_File &fh)
+{
+    mpi_error_check_file_read(MPI_File_open(CPU_Comm, file.c_str(),
+					    MPI_MODE_RDONLY, MPI_INFO_NULL,
+					    &fh),
+			      file);
+}
+
+/**
+	Read and check header and field table of an opened container. If
+	check_size is set, the container has to have the size of the current
+	grid.
+*/
+static void read_table(MPI_File fh, const std::string &file,
+		       t_header &header, std::vector<t_field_entry> &table,
+		       const bool check_size = true)
+{
+    MPI_Status status;
+
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, &status);
+
+    if (memcmp(header.magic, file_magic, sizeof(file_magic)) != 0) {
+	die("'%s' is not a checkpoint file!\n", file.c_str());
+    }
+    if (header.version != file_version) {
+	die("Checkpoint file '%s' has version %u, expected %u!\n",
+	    file.c_str(), header.version, file_version);
+    }
+    if (check_size &&
+	(header.n_radial != GlobalNRadial || header.n_azimuthal != NAzimuthal)) {
+	die("Checkpoint file '%s' has %lu x %lu cells, but the grid has %u x %u cells!\n",
+	    file.c_str(), header.n_radial, header.n_azimuthal, GlobalNRadial,
+	    NAzimuthal);
+    }
+
+    table.resize(header.n_fields);
+    MPI_File_read_at_all(fh, sizeof(header), table.data(),
+			 table.size() * sizeof(t_field_entry), MPI_BYTE,
+			 &status);
+}
+
+/**
+	Read header and field table of a container that is not read further.
+*/
+static void read_table(const std::string &file, t_header &header,
+		       std::vector<t_field_entry> &table,
+		       const bool check_size = true)
+{
+    MPI_File fh;
+    open_for_reading(file, fh);
+    read_table(fh, file, header, table, check_size);
+    MPI_File_close(&fh);
+}
+
+static const t_field_entry *find_entry(const std::vector<t_field_entry> &table,
+				       const t_polargrid &grid)
+{
+    for (const t_field_entry &entry : table) {
+	if (strncmp(entry.name, grid.get_name(), sizeof(entry.name)) == 0) {
+	    return &entry;
+	}
+    }
+    return nullptr;
+}
+
+/**
+	Restore the misc data of the container and return its timestep.
+	field_names receives the names of all fields in the container.
+*/
+unsigned int read_misc(const std::string &directory,
+		       std::vector<std::string> &field_names)
+{
+    t_header header;
+    std::vector<t_field_entry> table;
+    read_table(filename(directory), header, table, false);
+
+    field_names.clear();
+    for (const t_field_entry &entry : table) {
+	field_names.emplace_back(
+	    entry.name, strnlen(entry.name, sizeof(entry.name)));
+    }
+
+    output::set_misc(header.misc);
+    return header.misc.timestep;
+}
+
+void grid_size(const std::string &directory, unsigned int &n_radial,
+	       unsigned int &n_azimuthal)
+{
+    t_header header;
+    std::vector<t_field_entry> table;
+    read_table(filename(directory), header, table, false);
+
+    n_radial = header.n_radial;
+    n_azimuthal = header.n_azimuthal;
+}
+
+void read(const std::string &directory, const std::vector<t_polargrid *> &grids)
+{
+    const std::string file = filename(directory);
+
+    MPI_File fh;
+    open_for_reading(file, fh);
+
+    t_header header;
+    std::vector<t_field_entry> table;
+    read_table(fh, file, header, table);
+
+    // the file view has to be ordered by offset
+    std::vector<std::pair<const t_field_entry *, t_polargrid *>> fields;
+    for (t_polargrid *grid : grids) {
+	const t_field_entry *entry = find_entry(table, *grid);
+	if (entry == nullptr) {
+	    die("Checkpoint file '%s' does not contain '%s'!\n", file.c_str(),
+		grid->get_name());
+	}
+	fields.emplace_back(entry, grid);
+    }
+    std::sort(fields.begin(), fields.end(),
+	      [](const auto &a, const auto &b) {
+		  return a.first->offset < b.first->offset;
+	      });
+
+    std::vector<t_polargrid *> sorted_grids;
+    std::vector<std::uint64_t> offsets;
+    std::vector<unsigned int> first, end;
+    for (const auto &field : fields) {
+	sorted_grids.push_back(field.second);
+	offsets.push_back(field.first->offset);
+	first.push_back(0);
+	end.push_back(field.second->get_size_radial());
+    }
+
+    logging::print_master(LOG_INFO "Reading %u polargrids from '%s'.\n",
+			  (unsigned int)sorted_grids.size(), file.c_str());
+
+    transfer(fh, sorted_grids, offsets, first, end, false);
+    MPI_File_close(&fh);
+
+    const std::vector<std::uint64_t> checksums = compute_checksums(sorted_grids);
+    for (unsigned int i = 0; i < fields.size(); ++i) {
+	if (checksums[i] != fields[i].first->checksum) {
+	    die("Checksum mismatch for '%s' in checkpoint file '%s'!\n",
+		sorted_grids[i]->get_name(), file.c_str());
+	}
+    }
+}
+
+/**
+	Read a whole field of the container on all processes, regardless of the
+	size of the current grid. values holds n_rings x n_azimuthal doubles.
+*/
+void read_global(const std::string &directory, const std::string &name,
+		 std::vector<double> &values, unsigned int &n_rings,
+		 unsigned int &n_azimuthal)
+{
+    const std::string file = filename(directory);
+
+    MPI_File fh;
+    open_for_reading(file, fh);
+
+    t_header header;
+    std::vector<t_field_entry> table;
+    read_table(fh, file, header, table, false);
+
+    const t_field_entry *entry = nullptr;
+    for (const t_field_entry &e : table) {
+	if (strncmp(e.name, name.c_str(), sizeof(e.name)) == 0) {
+	    entry = &e;
+	}
+    }
+    if (entry == nullptr) {
+	die("Checkpoint file '%s' does not contain '%s'!\n", file.c_str(),
+	    name.c_str());
+    }
+
+    n_rings = entry->n_rings;
+    n_azimuthal = header.n_azimuthal;
+    values.resize((std::size_t)n_rings * n_azimuthal);
+
+    MPI_Status status;
+    MPI_File_read_at_all(fh, entry->offset, values.data(), values.size(),
+			 MPI_DOUBLE, &status);
+    MPI_File_close(&fh);
+}
+
+} // namespace checkpoint
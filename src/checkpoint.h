@@ -0,0 +1,24 @@
+#pragma once
+
+#include "data.h"
+#include <string>
+#include <vector>
+
+// Single file container holding all 2D polargrids of a snapshot.
+
+namespace checkpoint
+{
+
+bool exists(const std::string &directory);
+void write(t_data &data, const std::string &directory);
+unsigned int read_misc(const std::string &directory,
+		       std::vector<std::string> &field_names);
+void grid_size(const std::string &directory, unsigned int &n_radial,
+	       unsigned int &n_azimuthal);
+void read(const std::string &directory,
+	  const std::vector<t_polargrid *> &grids);
+void read_global(const std::string &directory, const std::string &name,
+		 std::vector<double> &values, unsigned int &n_rings,
+		 unsigned int &n_azimuthal);
+
+} // namespace checkpoint
@@ -1,22 +1,35 @@
 #include "mpi.h"
 #include "circumplanetary_mass.h"
+#include "find_cell_id.h"
 #include "global.h"
 #include "data.h"
 #include "util.h"
+#include <algorithm>
+#include <vector>
 
 
 /**
 	Calculates the gas mass inside the planets Roche lobe
+
+	Only the cells in the index window around each Roche sphere are visited,
+	the masses of all planets are combined with a single MPI_Allreduce.
 */
 void ComputeCircumPlanetaryMasses(t_data &data)
 {
-    for (unsigned int k = 1;
-	 k < data.get_planetary_system().get_number_of_planets(); ++k) {
+    const unsigned int N_planets =
+	data.get_planetary_system().get_number_of_planets();
+    if (N_planets <= 1) {
+	return;
+    }
 
-	// TODO: non global
-	const double *cell_center_x = CellCenterX->Field;
-	const double *cell_center_y = CellCenterY->Field;
+    // TODO: non global
+    const double *cell_center_x = CellCenterX->Field;
+    const double *cell_center_y = CellCenterY->Field;
+    const t_polargrid &sigma = data[t_data::SIGMA];
 
+    std::vector<double> mdcp(N_planets, 0.0);
+
+    for (unsigned int k = 1; k < N_planets; ++k) {
 	auto &planet = data.get_planetary_system().get_planet(k);
 	const double planet_to_prim_dist = planet.get_distance_to_primary();
 	const double roche_radius =
@@ -24,28 +37,44 @@ void ComputeCircumPlanetaryMasses(t_data &data)
 
 	const double xpl = planet.get_x();
 	const double ypl = planet.get_y();
+	const double rpl = planet.get_r();
+
+	// window of cells around the Roche sphere, restricted to active cells
+	const auto iminmax = hill_radial_index(rpl, roche_radius);
+	const unsigned int i_min =
+	    std::max(std::get<0>(iminmax), radial_first_active);
+	const unsigned int i_max =
+	    std::min(std::get<1>(iminmax) + 1, radial_active_size);
+
+	const auto jminmax =
+	    hill_azimuthal_index(planet.get_phi(), rpl, roche_radius);
+	const int j_min = std::get<0>(jminmax);
+	const int j_max = std::get<1>(jminmax);
 
 	double mdcplocal = 0.0;
-	const unsigned int Nphi = data[t_data::SIGMA].get_size_azimuthal();
 
-	#pragma omp parallel for reduction(+ : mdcplocal)
-	for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
-		for (unsigned int naz = 0; naz < Nphi; ++naz) {
+	#pragma omp parallel for collapse(2) reduction(+ : mdcplocal)
+	for (unsigned int nr = i_min; nr < i_max; ++nr) {
+		for (int j = j_min; j <= j_max; ++j) {
+		const unsigned int naz = clamp_phi_id_to_grid(j);
 		unsigned int cell = get_cell_id(nr, naz);
 		const double dist = std::sqrt(
 		    (cell_center_x[cell] - xpl) * (cell_center_x[cell] - xpl) +
 		    (cell_center_y[cell] - ypl) * (cell_center_y[cell] - ypl));
 		if (dist < roche_radius) {
-			mdcplocal += Surf[nr] *
-				 data[t_data::SIGMA](nr, naz);
+			mdcplocal += Surf[nr] * sigma(nr, naz);
 		}
 	    }
 	}
 
-	double mdcptotal = 0.0;
-	MPI_Allreduce(&mdcplocal, &mdcptotal, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+	mdcp[k] = mdcplocal;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, mdcp.data(), N_planets, MPI_DOUBLE, MPI_SUM,
+		  CPU_Comm);
 
-	planet.set_circumplanetary_mass(mdcptotal);
+    for (unsigned int k = 1; k < N_planets; ++k) {
+	data.get_planetary_system().get_planet(k).set_circumplanetary_mass(
+	    mdcp[k]);
     }
-}
\ No newline at end of file
+}
@@ -9,6 +9,7 @@
 #include "LowTasks.h"
 #include "commbound.h"
 #include "constants.h"
+#include "derived_fields.h"
 #include "global.h"
 #include "logging.h"
 #include "parameters.h"
@@ -130,30 +131,30 @@ void CommunicateBoundaries(t_polargrid *Density, t_polargrid *Vrad,
     if (CPU_Rank % 2 == 0) {
 	if (CPU_Rank != 0) {
 	    MPI_Isend(SendInnerBoundary, bufferSize, MPI_DOUBLE, CPU_Prev, 0,
-		      MPI_COMM_WORLD, &req1);
+		      CPU_Comm, &req1);
 	    MPI_Irecv(RecvInnerBoundary, bufferSize, MPI_DOUBLE, CPU_Prev, 0,
-		      MPI_COMM_WORLD, &req2);
+		      CPU_Comm, &req2);
 	}
 
 	if (CPU_Rank != CPU_Highest) {
 	    MPI_Isend(SendOuterBoundary, bufferSize, MPI_DOUBLE, CPU_Next, 0,
-		      MPI_COMM_WORLD, &req3);
+		      CPU_Comm, &req3);
 	    MPI_Irecv(RecvOuterBoundary, bufferSize, MPI_DOUBLE, CPU_Next, 0,
-		      MPI_COMM_WORLD, &req4);
+		      CPU_Comm, &req4);
 	}
     } else {
 	if (CPU_Rank != CPU_Highest) {
 	    MPI_Irecv(RecvOuterBoundary, bufferSize, MPI_DOUBLE, CPU_Next, 0,
-		      MPI_COMM_WORLD, &req3);
+		      CPU_Comm, &req3);
 	    MPI_Isend(SendOuterBoundary, bufferSize, MPI_DOUBLE, CPU_Next, 0,
-		      MPI_COMM_WORLD, &req4);
+		      CPU_Comm, &req4);
 	}
 
 	if (CPU_Rank != 0) {
 	    MPI_Irecv(RecvInnerBoundary, bufferSize, MPI_DOUBLE, CPU_Prev, 0,
-		      MPI_COMM_WORLD, &req1);
+		      CPU_Comm, &req1);
 	    MPI_Isend(SendInnerBoundary, bufferSize, MPI_DOUBLE, CPU_Prev, 0,
-		      MPI_COMM_WORLD, &req2);
+		      CPU_Comm, &req2);
 	}
     }
 
@@ -179,4 +180,6 @@ void CommunicateBoundaries(t_polargrid *Density, t_polargrid *Vrad,
 	    memcpy(Energy->Field + oo, RecvOuterBoundary + 3 * l,
 		   l * sizeof(double));
     }
+
+    derived_fields::changed(derived_fields::input_hydro);
 }
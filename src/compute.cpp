@@ -5,8 +5,10 @@
 #include "opacity.h"
 #include "frame_of_reference.h"
 #include "constants.h"
+#include "derived_fields.h"
 #include "global.h"
 #include "Theo.h"
+#include "util.h"
 
 namespace compute {
 
@@ -18,6 +20,10 @@ void midplane_density(t_data &data, const double current_time)
 {
 	compute_scale_height(data, current_time);
 
+	if (derived_fields::up_to_date(derived_fields::field_rho)) {
+		return;
+	}
+
 	auto &rho = data[t_data::RHO];
 	auto &Sig = data[t_data::SIGMA];
 	auto &H = data[t_data::SCALE_HEIGHT];
@@ -32,6 +38,8 @@ void midplane_density(t_data &data, const double current_time)
 			rho(nr, naz) = Sig(nr, naz) / (factor * H(nr, naz));
 		}
     }
+
+	derived_fields::computed(derived_fields::field_rho);
 }
 
 /**
@@ -39,6 +47,10 @@ void midplane_density(t_data &data, const double current_time)
  * Store the values in data[KAPPA]
 */
 void kappa_eff(t_data &data) {
+    if (derived_fields::up_to_date(derived_fields::field_kappa)) {
+	return;
+    }
+
     auto &rho = data[t_data::RHO];
     auto &T = data[t_data::TEMPERATURE];
     auto &kappa = data[t_data::KAPPA];
@@ -84,6 +96,188 @@ void kappa_eff(t_data &data) {
 
     }
     }
+
+    derived_fields::computed(derived_fields::field_kappa);
+}
+
+/**
+	Whether thermodynamics() can compute all fields cell by cell. The scale
+	height of the nbody mode sums over all bodies, the self-gravity
+	correction needs the Toomre parameter and the locally isothermal
+	temperature is derived from the pressure.
+*/
+static bool thermodynamics_fused()
+{
+    return (parameters::Adiabatic || parameters::Polytropic) &&
+	   parameters::aspectratio_mode != 1 &&
+	   !(parameters::self_gravity &&
+	     parameters::self_gravity_mode == parameters::t_sg::sg_BK);
+}
+
+/**
+	Computes temperature, sound speed, scale height, midplane density and,
+	if with_opacity is set, opacity and optical depths.
+
+	For the single star and center of mass scale height modes all fields
+	are computed in a single sweep over the grid, row by row, instead of
+	one pass per field. The results are the same as calling
+	compute_temperature(), compute_sound_speed(), midplane_density() and
+	kappa_eff() in this order, which is done for all other modes.
+*/
+void thermodynamics(t_data &data, const double current_time,
+		    const bool with_opacity)
+{
+    if (!thermodynamics_fused()) {
+	compute_temperature(data);
+	compute_sound_speed(data, current_time);
+	midplane_density(data, current_time);
+	if (with_opacity) {
+	    kappa_eff(data);
+	}
+	return;
+    }
+
+    if (derived_fields::up_to_date(derived_fields::field_temperature) &&
+	derived_fields::up_to_date(derived_fields::field_sound_speed,
+				   current_time) &&
+	derived_fields::up_to_date(derived_fields::field_scale_height,
+				   current_time) &&
+	derived_fields::up_to_date(derived_fields::field_rho) &&
+	(!with_opacity ||
+	 derived_fields::up_to_date(derived_fields::field_kappa))) {
+	return;
+    }
+
+    t_polargrid &Sig = data[t_data::SIGMA];
+    t_polargrid &E = data[t_data::ENERGY];
+    t_polargrid &T = data[t_data::TEMPERATURE];
+    t_polargrid &Cs = data[t_data::SOUNDSPEED];
+    t_polargrid &H = data[t_data::SCALE_HEIGHT];
+    t_polargrid &h = data[t_data::ASPECTRATIO];
+    t_polargrid &rho = data[t_data::RHO];
+    t_polargrid &kappa = data[t_data::KAPPA];
+    t_polargrid &tau = data[t_data::TAU];
+    t_polargrid &tau_eff = data[t_data::TAU_EFF];
+
+    const unsigned int Nr = T.get_size_radial();
+    const unsigned int Naz = T.get_size_azimuthal();
+
+    const bool adiabatic = parameters::Adiabatic;
+    const bool variable_gamma = parameters::variableGamma;
+    const bool center_of_mass = parameters::aspectratio_mode == 2;
+    const bool write_aspectratio =
+	parameters::heating_star_enabled || parameters::self_gravity ||
+	parameters::disk_feedback || parameters::body_force_from_potential;
+
+    const Pair r_cm = data.get_planetary_system().get_center_of_mass();
+    const double m_cm = data.get_planetary_system().get_mass();
+
+    const double Rgas = constants::R;
+    const double G = constants::G;
+    const double gamma_const = parameters::ADIABATICINDEX;
+    const double mu_const = parameters::MU;
+    const double polyconst = parameters::POLYTROPIC_CONSTANT;
+    const double factor = parameters::density_factor;
+
+    #pragma omp parallel for
+    for (unsigned int nr = 0; nr < Nr; ++nr) {
+	const double *const sigma_row = &Sig(nr, 0);
+	const double *const energy_row = &E(nr, 0);
+	const double *const gamma_eff_row =
+	    variable_gamma ? &data[t_data::GAMMAEFF](nr, 0) : nullptr;
+	const double *const gamma1_row =
+	    variable_gamma ? &data[t_data::GAMMA1](nr, 0) : nullptr;
+	const double *const mu_row =
+	    variable_gamma ? &data[t_data::MU](nr, 0) : nullptr;
+	const double *const x_row = &CellCenterX->Field[get_cell_id(nr, 0)];
+	const double *const y_row = &CellCenterY->Field[get_cell_id(nr, 0)];
+
+	double *const T_row = &T(nr, 0);
+	double *const cs_row = &Cs(nr, 0);
+	double *const H_row = &H(nr, 0);
+	double *const h_row = &h(nr, 0);
+	double *const rho_row = &rho(nr, 0);
+
+	const double r = Rb[nr];
+	const double inv_omega_kepler = 1.0 / calculate_omega_kepler(r);
+
+	#pragma omp simd
+	for (unsigned int naz = 0; naz < Naz; ++naz) {
+	    const double sigma = sigma_row[naz];
+	    const double gamma_eff =
+		variable_gamma ? gamma_eff_row[naz] : gamma_const;
+	    const double gamma1 = variable_gamma ? gamma1_row[naz] : gamma_const;
+	    const double mu = variable_gamma ? mu_row[naz] : mu_const;
+
+	    double temperature;
+	    double cs;
+	    if (adiabatic) {
+		const double c_v_inv = mu / Rgas * (gamma_eff - 1.0);
+		temperature = c_v_inv * energy_row[naz] / sigma;
+		cs = std::sqrt(gamma1 * (gamma_eff - 1.0) * energy_row[naz] /
+			       sigma);
+	    } else { // polytropic
+		temperature =
+		    mu / Rgas * polyconst * std::pow(sigma, gamma_eff - 1.0);
+		cs = std::sqrt(gamma_eff * Rgas / mu_const * temperature);
+	    }
+
+	    // H = c_s,iso / Omega_K with c_s,iso = c_s / sqrt(gamma1)
+	    double scale_height;
+	    double aspectratio;
+	    if (center_of_mass) {
+		const double dx = x_row[naz] - r_cm.x;
+		const double dy = y_row[naz] - r_cm.y;
+		const double dist = std::sqrt(std::pow(dx, 2) + std::pow(dy, 2));
+		aspectratio = cs * std::sqrt(dist / (G * m_cm * gamma1));
+		scale_height = dist * aspectratio;
+	    } else {
+		scale_height = cs / (std::sqrt(gamma1)) * inv_omega_kepler;
+		aspectratio = scale_height / r;
+	    }
+
+	    T_row[naz] = temperature;
+	    cs_row[naz] = cs;
+	    H_row[naz] = scale_height;
+	    if (write_aspectratio) {
+		h_row[naz] = aspectratio;
+	    }
+	    rho_row[naz] = sigma / (factor * scale_height);
+	}
+
+	if (with_opacity) {
+	    // the opacity laws do not vectorize
+	    for (unsigned int naz = 0; naz < Naz; ++naz) {
+		kappa(nr, naz) = opacity::opacity(rho_row[naz], T_row[naz]);
+		tau(nr, naz) = parameters::tau_factor *
+			       (1.0 / parameters::density_factor) *
+			       kappa(nr, naz) * sigma_row[naz];
+
+		if (parameters::heating_star_enabled) {
+		    tau_eff(nr, naz) =
+			3.0 / 8.0 * tau(nr, naz) + 0.5 +
+			1.0 / (4.0 * tau(nr, naz) + parameters::tau_min);
+		} else {
+		    tau_eff(nr, naz) =
+			3.0 / 8.0 * tau(nr, naz) + std::sqrt(3.0) / 4.0 +
+			1.0 / (4.0 * tau(nr, naz) + parameters::tau_min);
+		}
+
+		if (parameters::opacity == parameters::opacity_simple) {
+		    tau_eff(nr, naz) = 3.0 / 8.0 * tau(nr, naz);
+		}
+	    }
+	}
+    }
+
+    derived_fields::computed(derived_fields::field_temperature);
+    derived_fields::computed(derived_fields::field_sound_speed, current_time);
+    derived_fields::computed(derived_fields::field_scale_height,
+			     current_time);
+    derived_fields::computed(derived_fields::field_rho);
+    if (with_opacity) {
+	derived_fields::computed(derived_fields::field_kappa);
+    }
 }
 
 /**
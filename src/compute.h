@@ -8,5 +8,7 @@ namespace compute {
     
     void midplane_density(t_data &data, const double current_time);
     void kappa_eff(t_data &data);
+    void thermodynamics(t_data &data, const double current_time,
+			const bool with_opacity);
     void toomreQ(t_data &data);
 }
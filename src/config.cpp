@@ -53,17 +53,23 @@ Config Config::get_subconfig(const std::string &key)
 }
 
 
-std::vector<Config> Config::get_nbody_config()
+std::vector<Config> Config::get_subconfig_list(const std::string &key)
 {
-    m_visited_keys.insert("nbody");
+    const std::string lkey = lowercase(key);
+    m_visited_keys.insert(lkey);
     const auto &n = *m_root;
-    std::vector<Config> bodies;
-    if (contains("nbody")) {
-        for (auto &new_node : n["nbody"]) {
-            bodies.emplace_back(YAML::Clone(new_node));
+    std::vector<Config> entries;
+    if (contains(lkey)) {
+        for (auto &new_node : n[lkey]) {
+            entries.emplace_back(YAML::Clone(new_node));
         }
     }
-    return bodies;
+    return entries;
+}
+
+std::vector<Config> Config::get_nbody_config()
+{
+    return get_subconfig_list("nbody");
 }
 
 void Config::print() {
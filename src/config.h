@@ -57,6 +57,7 @@ class Config
     bool contains(const std::string &key);
 
     Config get_subconfig(const std::string &key);
+    std::vector<Config> get_subconfig_list(const std::string &key);
     std::vector<Config> get_nbody_config();
 
     void print();
@@ -358,7 +358,7 @@ void write_code_constants_file()
 
 	of.close();
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 }
 
 } // namespace constants
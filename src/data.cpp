@@ -1,6 +1,8 @@
 
 #include "data.h"
+#include "global.h"
 #include "logging.h"
+#include "particles/dust_deposition.h"
 #include "quantities.h"
 #include "units.h"
 #include <mpi.h>
@@ -207,6 +209,23 @@ t_data::t_data()
     m_polargrids[DRHO_DR].set_scalar(true);
     m_polargrids[DRHO_DR].set_name("DRHO_DR");
 
+    // dust grids are cell centered, see particles/dust_deposition.cpp
+    m_polargrids[DUST_SIGMA].set_scalar(true);
+    m_polargrids[DUST_SIGMA].set_name("dust_Sigma");
+    m_polargrids[DUST_SIGMA].set_unit(units::surface_density);
+    m_polargrids[DUST_SIGMA].set_do_before_write(&dust_deposition::deposit);
+
+    m_polargrids[DUST_V_RADIAL].set_scalar(true);
+    m_polargrids[DUST_V_RADIAL].set_name("dust_vrad");
+    m_polargrids[DUST_V_RADIAL].set_unit(units::velocity);
+    m_polargrids[DUST_V_RADIAL].set_do_before_write(&dust_deposition::deposit);
+
+    m_polargrids[DUST_V_AZIMUTHAL].set_scalar(true);
+    m_polargrids[DUST_V_AZIMUTHAL].set_name("dust_vazi");
+    m_polargrids[DUST_V_AZIMUTHAL].set_unit(units::velocity);
+    m_polargrids[DUST_V_AZIMUTHAL].set_do_before_write(
+	&dust_deposition::deposit);
+
     // tau_r_r is cell centered
     m_polargrids[TAU_R_R].set_scalar(true);
     m_polargrids[TAU_R_R].set_name("tau_r_r");
@@ -305,6 +324,20 @@ t_data::t_data()
 /// destructor
 t_data::~t_data() {}
 
+/**
+	Find a polargrid by its name. Returns nullptr if there is none.
+*/
+t_polargrid *t_data::get_polargrid_by_name(const std::string &name)
+{
+    for (unsigned int i = 0; i < N_POLARGRID_TYPES; ++i) {
+	if (m_polargrids[i].get_name() != nullptr &&
+	    name == m_polargrids[i].get_name()) {
+	    return &m_polargrids[i];
+	}
+    }
+    return nullptr;
+}
+
 void t_data::set_size(unsigned int global_n_radial,
 		      unsigned int global_n_azimiuthal, unsigned int n_radial,
 		      unsigned int n_azimuthal)
@@ -338,7 +371,7 @@ void t_data::print_memory_usage(unsigned int n_radial, unsigned int n_azimuthal)
     }
 
     MPI_Allreduce(&local_memory_usage, &global_memory_usage, 1, MPI_DOUBLE,
-		  MPI_SUM, MPI_COMM_WORLD);
+		  MPI_SUM, CPU_Comm);
 
     logging::print(
 	LOG_INFO
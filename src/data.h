@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string>
 
 #include "nbody/planetary_system.h"
 #include "polargrid.h"
@@ -80,6 +81,9 @@ class t_data
 	WORKER_SCALAR_ARRAY,
 	GAS_DIFFUSION_COEFFICIENT,
 	DRHO_DR,
+	DUST_SIGMA,	      // dust surface density deposited from particles
+	DUST_V_RADIAL,	      // mass weighted radial dust velocity
+	DUST_V_AZIMUTHAL,     // mass weighted azimuthal dust velocity
 
 	// number of t_polargrid_types
 	N_POLARGRID_TYPES
@@ -104,6 +108,8 @@ class t_data
 	return m_radialgrids[radialgrid_type];
     }
 
+    t_polargrid *get_polargrid_by_name(const std::string &name);
+
     void set_size(unsigned int global_n_radial,
 		  unsigned int global_n_azimiuthal, unsigned int n_radial,
 		  unsigned int n_azimuthal);
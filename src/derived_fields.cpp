@@ -0,0 +1,158 @@
+/**
+	\file derived_fields.cpp
+
+	Dependency tracking of the disk fields derived from the hydro and nbody
+	state: gamma/mu, temperature, sound speed, scale height, pressure,
+	midplane density and opacity.
+
+	The inputs and every derived field carry a version, which is increased
+	whenever an input is changed or a field is recomputed. A field remembers
+	the versions of all nodes when it was computed last, and is up to date as
+	long as none of the nodes it reads has a newer version. The compute
+	functions return early for up to date fields, so the same field is not
+	recomputed several times in a step if its inputs did not change in
+	between. Skipping the computation gives the same values as repeating it.
+
+	Fields are not recomputed on demand: callers still compute them in the
+	order they need them. Which nodes a field reads depends on the equation
+	of state and the aspect ratio mode. gamma/mu reads the scale height,
+	which in turn depends on gamma/mu; the cycle is resolved by the call
+	order, exactly as before.
+
+	Every change of SIGMA or ENERGY has to be announced with
+	changed(input_hydro), every change of the nbody positions or masses with
+	changed(input_nbody). Code writing the derived grids directly, e.g. when
+	initializing, restarting or writing output, has to call invalidate().
+	All fields are invalidated at the start of every step.
+*/
+
+#include "derived_fields.h"
+#include "parameters.h"
+#include <algorithm>
+
+namespace derived_fields
+{
+
+static const unsigned int n_inputs = 2;
+static const unsigned int n_fields = 7;
+static const unsigned int n_nodes = n_inputs + n_fields;
+
+static unsigned long version[n_nodes] = {};
+
+struct t_stamp {
+    bool valid = false;
+    // only relevant for fields depending on the ramp up of the planet masses
+    double time = 0.0;
+    // versions of all nodes when the field was computed
+    unsigned long seen[n_nodes] = {};
+};
+
+static t_stamp stamps[n_fields];
+
+static inline unsigned int node(const t_input input) { return input; }
+
+static inline unsigned int node(const t_field field)
+{
+    return n_inputs + field;
+}
+
+static inline unsigned int bit(const unsigned int n) { return 1u << n; }
+
+/**
+	Nodes read when computing field as bit mask. uses_time is set if the
+	field also depends on the current time.
+*/
+static unsigned int dependencies(const t_field field, bool &uses_time)
+{
+    const bool energy_equation =
+	parameters::Adiabatic || parameters::Polytropic;
+    const bool nbody_mode = parameters::aspectratio_mode == 1;
+
+    uses_time = false;
+
+    switch (field) {
+    case field_gamma_mu:
+	return bit(node(input_hydro)) | bit(node(field_scale_height));
+    case field_temperature:
+	if (energy_equation) {
+	    return bit(node(input_hydro)) | bit(node(field_gamma_mu));
+	}
+	return bit(node(input_hydro)) | bit(node(field_pressure));
+    case field_sound_speed:
+	if (parameters::Adiabatic) {
+	    return bit(node(input_hydro)) | bit(node(field_gamma_mu));
+	}
+	if (parameters::Polytropic) {
+	    return bit(node(field_temperature)) | bit(node(field_gamma_mu));
+	}
+	// locally isothermal: central mass or nbody system
+	uses_time = nbody_mode;
+	return bit(node(input_nbody));
+    case field_scale_height: {
+	unsigned int mask = bit(node(input_nbody)) |
+			    bit(node(field_sound_speed)) |
+			    bit(node(field_gamma_mu));
+	// the Toomre parameter reads Sigma
+	if (parameters::self_gravity &&
+	    parameters::self_gravity_mode == parameters::t_sg::sg_BK) {
+	    mask |= bit(node(input_hydro));
+	}
+	uses_time = nbody_mode;
+	return mask;
+    }
+    case field_pressure:
+	if (parameters::Adiabatic) {
+	    return bit(node(input_hydro)) | bit(node(field_gamma_mu));
+	}
+	return bit(node(input_hydro)) | bit(node(field_sound_speed));
+    case field_rho:
+	return bit(node(input_hydro)) | bit(node(field_scale_height));
+    case field_kappa:
+	return bit(node(input_hydro)) | bit(node(field_rho)) |
+	       bit(node(field_temperature));
+    }
+
+    return ~0u;
+}
+
+void changed(const t_input input) { ++version[node(input)]; }
+
+bool up_to_date(const t_field field, const double current_time)
+{
+    const t_stamp &stamp = stamps[field];
+    if (!stamp.valid) {
+	return false;
+    }
+
+    bool uses_time;
+    const unsigned int mask = dependencies(field, uses_time);
+    if (uses_time && stamp.time != current_time) {
+	return false;
+    }
+
+    for (unsigned int n = 0; n < n_nodes; ++n) {
+	if ((mask & bit(n)) && stamp.seen[n] != version[n]) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+void computed(const t_field field, const double current_time)
+{
+    t_stamp &stamp = stamps[field];
+    stamp.valid = true;
+    stamp.time = current_time;
+    std::copy(version, version + n_nodes, stamp.seen);
+
+    ++version[node(field)];
+}
+
+void invalidate()
+{
+    for (t_stamp &stamp : stamps) {
+	stamp.valid = false;
+    }
+}
+
+} // namespace derived_fields
@@ -0,0 +1,29 @@
+#pragma once
+
+// Version stamps of the disk fields derived from the hydro and nbody state,
+// used to skip recomputing a field whose inputs did not change.
+
+namespace derived_fields
+{
+
+enum t_input {
+    input_hydro, // SIGMA and ENERGY
+    input_nbody  // positions and masses of the nbody system
+};
+
+enum t_field {
+    field_gamma_mu, // GAMMAEFF, GAMMA1 and MU
+    field_temperature,
+    field_sound_speed,
+    field_scale_height, // SCALE_HEIGHT and ASPECTRATIO
+    field_pressure,
+    field_rho,
+    field_kappa // KAPPA, TAU and TAU_EFF
+};
+
+void changed(const t_input input);
+bool up_to_date(const t_field field, const double current_time = 0.0);
+void computed(const t_field field, const double current_time = 0.0);
+void invalidate();
+
+} // namespace derived_fields
@@ -1,8 +1,12 @@
 #include "find_cell_id.h"
 #include "LowTasks.h"
 #include "global.h"
+#include "init.h"
+#include "logging.h"
 #include "parameters.h"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 static double growth_factor;
 static double inv_log_growth_factor;
@@ -11,6 +15,26 @@ static double cell_size;
 static double inv_phi_cell_size;
 static double phi_cell_size;
 
+/**
+	Lookup table for radii without closed form cell index. The range of the
+	radii is split into buckets uniform in log r, each storing the index
+	found for its lower edge. A lookup starts there and only needs to step
+	over the few radii inside the bucket.
+*/
+struct t_lookup_table {
+    const double *radii;
+    int size;
+    double log_r_min;
+    double inv_dlog;
+    std::vector<int> start;
+};
+
+static t_lookup_table rmed_table;
+static t_lookup_table rinf_table;
+
+// number of buckets per radius
+static const unsigned int lookup_table_oversampling = 4;
+
 unsigned int clamp_r_id_to_rmed_grid(int cell_id, const bool is_vector)
 {
 
@@ -90,6 +114,90 @@ static void init_cell_finder_exp(const double cell_growth_factor,
     optimization_const = (growth_factor - 1.0) / cell_size;
 }
 
+static void init_lookup_table(t_lookup_table &table, const double *radii,
+			      const int size)
+{
+    const int N_buckets = lookup_table_oversampling * size;
+
+    table.radii = radii;
+    table.size = size;
+    table.log_r_min = std::log(radii[0]);
+    table.inv_dlog = N_buckets / (std::log(radii[size - 1]) - table.log_r_min);
+    table.start.resize(N_buckets);
+
+    int id = -1;
+    for (int b = 0; b < N_buckets; ++b) {
+	const double edge = std::exp(table.log_r_min + b / table.inv_dlog);
+	while (id + 1 < size && radii[id + 1] < edge) {
+	    id++;
+	}
+	table.start[b] = id;
+    }
+}
+
+/**
+	Index of the last radius smaller than r, -1 if there is none.
+*/
+static int lookup(const t_lookup_table &table, const double r)
+{
+    int b = (int)std::floor((std::log(r) - table.log_r_min) * table.inv_dlog);
+    if (b < 0) {
+	b = 0;
+    } else if (b >= (int)table.start.size()) {
+	b = table.start.size() - 1;
+    }
+
+    int id = table.start[b];
+    while (id >= 0 && table.radii[id] >= r) {
+	id--;
+    }
+    while (id + 1 < table.size && table.radii[id + 1] < r) {
+	id++;
+    }
+    return id;
+}
+
+#ifndef NDEBUG
+/**
+	Index of the last radius smaller than r by a linear scan over the whole
+	table, the reference for lookup.
+*/
+static int lookup_linear(const t_lookup_table &table, const double r)
+{
+    int id = -1;
+    while (id + 1 < table.size && table.radii[id + 1] < r) {
+	id++;
+    }
+    return id;
+}
+
+/**
+	Compare lookup against the linear scan at, between and next to all radii
+	of the table, including those beyond the last active ring.
+*/
+static void check_lookup_table(const t_lookup_table &table)
+{
+    for (int i = 0; i < table.size; ++i) {
+	const double r = table.radii[i];
+	double samples[4] = {r, std::nextafter(r, 0.0),
+			     std::nextafter(r, 2.0 * r), 0.0};
+	unsigned int n_samples = 3;
+	if (i + 1 < table.size) {
+	    samples[n_samples++] = 0.5 * (r + table.radii[i + 1]);
+	}
+
+	for (unsigned int n = 0; n < n_samples; ++n) {
+	    const int id = lookup(table, samples[n]);
+	    const int id_linear = lookup_linear(table, samples[n]);
+	    if (id != id_linear) {
+		die("Cell lookup table found id=%d for r=%.17e but the linear scan found id=%d!\n",
+		    id, samples[n], id_linear);
+	    }
+	}
+    }
+}
+#endif // NDEBUG
+
 static void init_cell_finder_custom(const double cell_growth_factor,
 				    const double first_cell_size)
 {
@@ -102,6 +210,16 @@ static void init_cell_finder_custom(const double cell_growth_factor,
     growth_factor = 0.0;
     inv_log_growth_factor = 0.0;
     optimization_const = 0.0;
+
+    // the radii are filled up to NRadial + search_buffer, the linear scan
+    // this table replaces also found cells in that buffer
+    init_lookup_table(rmed_table, Rmed, NRadial + search_buffer);
+    init_lookup_table(rinf_table, Rinf, NRadial + search_buffer);
+
+#ifndef NDEBUG
+    check_lookup_table(rmed_table);
+    check_lookup_table(rinf_table);
+#endif
 }
 
 static void rmed_id_error_check(const double r, int &id)
@@ -247,13 +365,7 @@ static int get_rmed_id_exp(const double r)
 
 static int get_rmed_id_custom(const double r)
 {
-    int id = 0;
-    while (Rmed[id] < r) {
-	id++;
-    }
-
-    id--;
-    return id;
+    return lookup(rmed_table, r);
 }
 
 static int get_rinf_id_log(const double r)
@@ -281,13 +393,7 @@ static int get_rinf_id_exp(const double r)
 
 static int get_rinf_id_custom(const double r)
 {
-    int id = 0;
-    while (Rinf[id] < r) {
-	id++;
-    }
-    id--;
-
-    return id;
+    return lookup(rinf_table, r);
 }
 
 int get_inf_azimuthal_id(const double phi)
@@ -449,3 +555,50 @@ int get_rinf_id(const double r)
 
     return id;
 }
+
+/**
+	Range of local rings [i_min, i_max] around a radius.
+*/
+std::tuple<unsigned int, unsigned int>
+hill_radial_index(const double Rplanet, const double RHill)
+{
+
+    const bool is_vector = false;
+    /* Calculate the indeces in radial direction where
+       the Hill sphere starts and stops */
+    unsigned i_min;
+    if (Rplanet - RHill < RMIN) {
+	i_min = 0;
+    } else {
+	i_min =
+	    clamp_r_id_to_radii_grid(get_rinf_id(Rplanet - RHill), is_vector);
+    }
+    unsigned i_max =
+	clamp_r_id_to_radii_grid(get_rinf_id(Rplanet + RHill) + 1, is_vector);
+    std::tuple<unsigned int, unsigned int> ids(i_min, i_max);
+    return ids;
+}
+
+/**
+	Range of azimuthal cells [j_min, j_max] covering a circle of radius
+	RHill around the point (Rplanet, angle). The indices are not wrapped,
+	use clamp_phi_id_to_grid.
+*/
+std::tuple<int, int> hill_azimuthal_index(const double angle,
+					  const double Rplanet,
+					  const double RHill)
+{
+    /* Calculate the index in azimuthal direction
+       where the Hill sphere starts and stops */
+    double max_angle;
+    if(Rplanet == 0.0){
+	max_angle = 2.0*M_PI;
+    } else {
+	max_angle = std::min(2.0*M_PI, 2.0 * RHill / Rplanet);
+    }
+	const int j_min = get_med_azimuthal_id(angle - max_angle);
+	int j_max = get_med_azimuthal_id(angle + max_angle) + 1;
+	j_max = j_min + std::min(j_max - j_min, (int)NAzimuthal - 1);
+	std::tuple<int, int> ids(j_min, j_max);
+	return ids;
+}
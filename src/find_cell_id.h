@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdio>
+#include <tuple>
 
 void init_cell_finder(const double cell_growth_factor,
 		      const double first_cell_size);
@@ -14,3 +15,9 @@ unsigned int clamp_r_id_to_rmed_grid(const int cell_id, const bool is_vector);
 unsigned int clamp_r_id_to_radii_grid(int cell_id, const bool is_vector);
 
 unsigned int clamp_phi_id_to_grid(int cell_id);
+
+std::tuple<unsigned int, unsigned int> hill_radial_index(const double Rplanet,
+							 const double RHill);
+std::tuple<int, int> hill_azimuthal_index(const double angle,
+					  const double Rplanet,
+					  const double RHill);
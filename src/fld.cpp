@@ -6,6 +6,7 @@
 
 #include <fstream>
 #include <filesystem>
+#include <vector>
 
 #include "parameters.h"
 #include "constants.h"
@@ -14,6 +15,7 @@
 #include "opacity.h"
 #include "SourceEuler.h"
 #include "logging.h"
+#include "monitor_series.h"
 #include "compute.h"
 #include "output.h"
 #include "simulation.h"
@@ -291,10 +293,35 @@ static void write_logfile_header(const std::string filename) {
 
 void write_logfile(const std::string filename) {
 	static bool header_written = false;
+	static monitor_series::t_series *series = nullptr;
 	if (!CPU_Master || !radiative_diffusion_enabled) {
 		return;
 	}
 
+	const unsigned int hydro_steps = dt_logger.get_N_hydro_in_last_interval();
+	const unsigned int SOR_iterations = SOR_iterations_over_timestep;
+	const unsigned int average_SOR_iterations = get_average_SOR_iterations_and_reset(hydro_steps);
+
+	if (parameters::monitor_format != parameters::monitor_format_text) {
+		if (series == nullptr) {
+			series = monitor_series::open(
+				monitor_series::binary_filename(filename),
+				{{"snapshot number", "1"},
+				 {"monitor number", "1"},
+				 {"number of hydro steps in last interval", "1"},
+				 {"number of SOR iterations in last interval", "1"},
+				 {"average SOR iterations per hydro step", "1"}},
+				true);
+		}
+		series->append({(double)sim::N_snapshot, (double)sim::N_monitor,
+				(double)hydro_steps, (double)SOR_iterations,
+				(double)average_SOR_iterations});
+	}
+
+	if (parameters::monitor_format == parameters::monitor_format_binary) {
+		return;
+	}
+
 	if (!header_written) {
 		if (std::filesystem::exists(filename)) {
 			header_written = true;
@@ -312,12 +339,11 @@ void write_logfile(const std::string filename) {
 
 	logfile << std::scientific;
 
-	unsigned int hydro_steps = dt_logger.get_N_hydro_in_last_interval();
 	logfile << sim::N_snapshot;
 	logfile << "\t" << sim::N_monitor;
 	logfile << "\t" << hydro_steps;
-	logfile << "\t" << SOR_iterations_over_timestep;
-	logfile << "\t" << get_average_SOR_iterations_and_reset(hydro_steps);
+	logfile << "\t" << SOR_iterations;
+	logfile << "\t" << average_SOR_iterations;
 	logfile << std::endl;
 
 	logfile.close();
@@ -575,9 +601,9 @@ static void calculate_matrix_elements(t_polargrid &Density, const double dt) {
 	    A(nr, naz) = common_AC * Ka(nr, naz) * Ra[nr] * InvDiffRmed[nr];
 	    C(nr, naz) = common_AC * Ka(nr + 1, naz) * Ra[nr + 1] * InvDiffRmed[nr + 1];
 
-	    // 1/(r^2 dphi^2)
+	    // 1/(r^2 dphi^2), no azimuthal coupling for a single azimuthal cell
 		const unsigned int naz_next = naz == Kb.get_max_azimuthal() ? 0 : naz + 1;
-	    const double common_DE = common_factor / (std::pow(Rb[nr], 2) * std::pow(dphi, 2));
+	    const double common_DE = parameters::axisymmetric ? 0.0 : common_factor / (std::pow(Rb[nr], 2) * std::pow(dphi, 2));
 	    D(nr, naz) = common_DE * Kb(nr, naz);
 	    E(nr, naz) = common_DE * Kb(nr, naz_next);
 
@@ -616,28 +642,28 @@ static void communicate_parallelization_boundaries(t_polargrid &Temperature) {
 	if (CPU_Rank % 2 == 0) {
 	    if (CPU_Rank != 0) {
 		MPI_Isend(SendInnerBoundary, Noc,
-			  MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, &req1);
+			  MPI_DOUBLE, CPU_Prev, 0, CPU_Comm, &req1);
 		MPI_Irecv(RecvInnerBoundary, Noc,
-			  MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, &req2);
+			  MPI_DOUBLE, CPU_Prev, 0, CPU_Comm, &req2);
 	    }
 	    if (CPU_Rank != CPU_Highest) {
 		MPI_Isend(SendOuterBoundary, Noc,
-			  MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD, &req3);
+			  MPI_DOUBLE, CPU_Next, 0, CPU_Comm, &req3);
 		MPI_Irecv(RecvOuterBoundary, Noc,
-			  MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD, &req4);
+			  MPI_DOUBLE, CPU_Next, 0, CPU_Comm, &req4);
 	    }
 	} else {
 	    if (CPU_Rank != CPU_Highest) {
 		MPI_Irecv(RecvOuterBoundary, Noc,
-			  MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD, &req3);
+			  MPI_DOUBLE, CPU_Next, 0, CPU_Comm, &req3);
 		MPI_Isend(SendOuterBoundary, Noc,
-			  MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD, &req4);
+			  MPI_DOUBLE, CPU_Next, 0, CPU_Comm, &req4);
 	    }
 	    if (CPU_Rank != 0) {
 		MPI_Irecv(RecvInnerBoundary, Noc,
-			  MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, &req1);
+			  MPI_DOUBLE, CPU_Prev, 0, CPU_Comm, &req1);
 		MPI_Isend(SendInnerBoundary, Noc,
-			  MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, &req2);
+			  MPI_DOUBLE, CPU_Prev, 0, CPU_Comm, &req2);
 	    }
 	}
 
@@ -745,7 +771,7 @@ static void SOR(t_polargrid &T) {
 	}
 
     const double tmp = absolute_norm;
-	MPI_Allreduce(&tmp, &absolute_norm, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Allreduce(&tmp, &absolute_norm, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
 
 	// calculate the absolute change averaged over all cells
 	const unsigned int Ncells = GlobalNRadial * NAzimuthal;
@@ -795,6 +821,53 @@ static void SOR(t_polargrid &T) {
 			  omega);
 }
 
+/*
+Solve the linear system directly with the Thomas algorithm.
+
+For a single azimuthal cell on a single process the system is tridiagonal
+in radius, so one forward and one backward sweep give the exact solution
+instead of many SOR iterations. T(nstart - 1) and T(nstop) are boundary
+values just as in SOR.
+*/
+static void solve_tridiagonal(t_polargrid &T) {
+
+	const unsigned int N = nstop - nstart;
+	static std::vector<double> c_prime, d_prime;
+	c_prime.resize(N);
+	d_prime.resize(N);
+
+	for (unsigned int i = 0; i < N; ++i) {
+		const unsigned int nr = nstart + i;
+
+		double a = A(nr, 0);
+		double c = C(nr, 0);
+		double d = Told(nr, 0);
+		if (i == 0) {
+			d -= a * T(nr - 1, 0);
+			a = 0.0;
+		}
+		if (i == N - 1) {
+			d -= c * T(nr + 1, 0);
+			c = 0.0;
+		}
+
+		const double denom = B(nr, 0) - (i > 0 ? a * c_prime[i - 1] : 0.0);
+		c_prime[i] = c / denom;
+		d_prime[i] = (d - (i > 0 ? a * d_prime[i - 1] : 0.0)) / denom;
+	}
+
+	T(nstop - 1, 0) = d_prime[N - 1];
+	for (unsigned int i = N - 1; i-- > 0;) {
+		T(nstart + i, 0) = d_prime[i] - c_prime[i] * T(nstart + i + 1, 0);
+	}
+
+	for (unsigned int nr = nstart; nr < nstop; ++nr) {
+		floorceil_single(T(nr, 0));
+	}
+
+	SOR_iterations_over_timestep++;
+}
+
 /*
 Use radiation temperature to update internal energy.
 The underlying assumption is that gas temperature 
@@ -878,15 +951,15 @@ static void check_solution(t_polargrid &T) {
 
 
     double tmp = diff;
-	MPI_Allreduce(&tmp, &diff, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Allreduce(&tmp, &diff, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
 	printf("Sum of differences in RD solver : %e\n", diff);
 
 	tmp = diff_abs;
-	MPI_Allreduce(&tmp, &diff_abs, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Allreduce(&tmp, &diff_abs, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
 	printf("Sum of |differences| in RD solver : %e\n", diff_abs);
 
 	tmp = xmax;
-	MPI_Allreduce(&tmp, &xmax, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+	MPI_Allreduce(&tmp, &xmax, 1, MPI_DOUBLE, MPI_MAX, CPU_Comm);
 	printf("Max value in solution vector : %e\n", xmax);
 }
 
@@ -968,14 +1041,20 @@ static void one_fluid_fld(t_data &data, t_polargrid &T, const double dt) {
 	apply_temperature_boundary(T);
 	// calculate diffusion coefficient
 	compute_diffusion_coeff_radial(Density, T);
-    compute_diffusion_coeff_azimuthal(Density, T);
+	if (!parameters::axisymmetric) {
+	    compute_diffusion_coeff_azimuthal(Density, T);
+	}
     apply_coefficient_boundary();
 
 	// setup linear equation and solve the diffusion equation
     calculate_matrix_elements(Density, dt);
 	copy_polargrid(Told, T);
 
-	SOR(T);
+	if (parameters::axisymmetric && CPU_Number == 1) {
+	    solve_tridiagonal(T);
+	} else {
+	    SOR(T);
+	}
 }
 
 
@@ -992,12 +1071,9 @@ void radiative_diffusion(t_data &data, const double current_time, const double d
     auto &Energy = data[t_data::ENERGY];
 	auto &Tgas = data[t_data::TEMPERATURE];
 	
-    // update temperature, soundspeed and aspect ratio
-	compute_temperature(data);
+    // update temperature, soundspeed, aspect ratio and midplane density
 	// floor_T(data[t_data::TEMPERATURE]);
-	compute_sound_speed(data, current_time);
-	// compute_scale_height(data, current_time); done in compute::midplane_density
-	compute::midplane_density(data, current_time);
+	compute::thermodynamics(data, current_time, false);
 
 	if (radiative_diffusion_test_2d) {
 		run_2d_diffusion_test(data, dt);
@@ -1,5 +1,6 @@
 #include "frame_of_reference.h"
 #include "parameters.h"
+#include "derived_fields.h"
 #include "SideEuler.h"
 #include "particles/particles.h"
 #include "types.h"
@@ -51,6 +52,7 @@ void handle_corotation(t_data &data, const double dt)
     }
 
     data.get_planetary_system().rotate(OmegaFrame * dt);
+    derived_fields::changed(derived_fields::input_nbody);
 
     if (parameters::integrate_particles) {
 	particles::rotate(OmegaFrame * dt);
@@ -12,6 +12,10 @@
 #include "hydro_dt_logger.h"
 #include "polargrid.h"
 
+/** communicator of all processes working on this simulation, differs from
+ * MPI_COMM_WORLD in ensemble mode */
+MPI_Comm CPU_Comm = MPI_COMM_WORLD;
+
 /** number of this process, not an unsigned integer because MPI excepts it to be
  * signed */
 int CPU_Rank;
@@ -24,6 +28,12 @@ int Thread_Number;
 /** is this process the master process */
 int CPU_Master;
 
+/** index of the ensemble member this process belongs to */
+int Ensemble_Member = 0;
+
+/** number of independent simulations run inside this MPI job */
+int Ensemble_Number = 1;
+
 /** number of upper next CPU */
 int CPU_Next;
 
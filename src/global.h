@@ -8,10 +8,13 @@
 #include "hydro_dt_logger.h"
 #include "polargrid.h"
 
+extern MPI_Comm CPU_Comm;
 extern int CPU_Rank;
 extern int CPU_Number;
 extern int Thread_Number;
 extern int CPU_Master;
+extern int Ensemble_Member;
+extern int Ensemble_Number;
 extern int CPU_Next;
 extern int CPU_Prev;
 extern int CPU_Highest;
@@ -2,6 +2,7 @@
 #include <cmath>
 #include "global.h"
 #include "logging.h"
+#include "monitor_series.h"
 #include "LowTasks.h"
 #include "output.h"
 #include "start_mode.h"
@@ -53,11 +54,35 @@ void hydro_dt_logger::write(const unsigned int coarseOutputNumber,
 {
 	FILE *fd = 0;
 	static bool fd_created = false;
+	static monitor_series::t_series *series = nullptr;
+	const bool write_text =
+		parameters::monitor_format != parameters::monitor_format_binary;
+	const bool write_binary =
+		parameters::monitor_format != parameters::monitor_format_text;
 
 	if (CPU_Master) {
 
 		const std::string filename = output::outdir + "monitor/timestepLogging.dat";
 
+		if (write_binary && series == nullptr) {
+			const std::string time_unit = units::time.get_cgs_factor_symbol();
+			series = monitor_series::open(
+				monitor_series::binary_filename(filename),
+				{{"snapshot number", "1"},
+				 {"monitor number", "1"},
+				 {"hydrostep number", "1"},
+				 {"Number of Hydrosteps in last monitor_timestep", "1"},
+				 {"time", time_unit},
+				 {"walltime", "s"},
+				 {"walltime per hydrostep", "ms"},
+				 {"mean dt", time_unit},
+				 {"min dt", time_unit},
+				 {"max dt", time_unit},
+				 {"std dev dt", time_unit}},
+				start_mode::mode == start_mode::mode_restart);
+		}
+
+		if (write_text) {
 		// check if file exists and we restarted
 		if ((start_mode::mode == start_mode::mode_restart) && !(fd_created)) {
 			fd = fopen(filename.c_str(), "r");
@@ -103,6 +128,7 @@ void hydro_dt_logger::write(const unsigned int coarseOutputNumber,
 						units::time.get_cgs_factor_symbol().c_str(),units::time.get_cgs_factor_symbol().c_str(),units::time.get_cgs_factor_symbol().c_str(),units::time.get_cgs_factor_symbol().c_str(),units::time.get_cgs_factor_symbol().c_str());
 			fd_created = true;
 		}
+		}
 
 		double realtime_sec = 0.0;
 
@@ -135,9 +161,17 @@ void hydro_dt_logger::write(const unsigned int coarseOutputNumber,
 			mean_dt = 0.0;
 			std_dev = 0.0;
 		}
+		if (write_text) {
 		fprintf(fd, "%u\t%u\t%lu\t%u\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\n", coarseOutputNumber, fineOutputNumber,
 				sim::N_hydro_iter, m_N_hydro_iter_DT, sim::time, realtime_sec, time_per_step_ms, mean_dt, m_min_hydro_dt, m_max_hydro_dt, std_dev);
 		fclose(fd);
+		}
+		if (write_binary) {
+			series->append({(double)coarseOutputNumber, (double)fineOutputNumber,
+					(double)sim::N_hydro_iter, (double)m_N_hydro_iter_DT, sim::time,
+					realtime_sec, time_per_step_ms, mean_dt, m_min_hydro_dt,
+					m_max_hydro_dt, std_dev});
+		}
 
 		reset();
 	}
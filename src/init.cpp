@@ -19,6 +19,7 @@
 #include "parameters.h"
 #include "pvte_law.h"
 #include "quantities.h"
+#include "radial_profile.h"
 #include "selfgravity.h"
 #include "util.h"
 #include "viscosity/viscosity.h"
@@ -35,13 +36,6 @@
 #include <gsl/gsl_sf_bessel.h>
 #endif // DISABLE_GSL
 
-
-// Radial arrays have size MAX1D so we can write to N+search_buffer safely
-// we do this to avoid errors when accessing nr+x in the code
-// less than 15 should be safe too, but we need at least 2 or else
-// rmed_id_error_check accessing 'id+1' can cause errors
-const unsigned int search_buffer = 15;
-
 /**
 	resize all (global) radialarrays
 */
@@ -72,6 +66,62 @@ void resize_radialarrays(unsigned int size)
     GLOBAL_AxiSGAccr.resize(size);
 }
 
+// grid spacing parameters of the radii, needed by the cell finder
+static double radial_cell_growth_factor = 0.0;
+static double radial_first_cell_size = 0.0;
+
+/**
+	Fills the 1D arrays of the local rings like Rmed, Rinf, Rsup, Surf, ...
+	from the global radii. Has to be called again when IMIN or NRadial
+	change.
+*/
+void init_local_radialarrays()
+{
+    unsigned int nRadial;
+
+    for (nRadial = 0; nRadial < NRadial + search_buffer; ++nRadial) {
+	Rinf[nRadial] = Radii[nRadial + IMIN];
+	Rsup[nRadial] = Radii[nRadial + IMIN + 1];
+
+	Rmed[nRadial] = 2.0 / 3.0 *
+			(std::pow(Rsup[nRadial], 3) -
+			 std::pow(Rinf[nRadial], 3));
+	Rmed[nRadial] = Rmed[nRadial] / (std::pow(Rsup[nRadial], 2) -
+					 std::pow(Rinf[nRadial], 2));
+
+	// TODO: Is already calculated a few lines above. assert should check
+	// this
+	assert((Rmed[nRadial] - GlobalRmed[nRadial + IMIN]) < std::numeric_limits<double>::epsilon());
+
+	Surf[nRadial] =
+	    M_PI * (std::pow(Rsup[nRadial], 2) - std::pow(Rinf[nRadial], 2)) /
+	    (double)NAzimuthal;
+
+	InvRmed[nRadial] = 1.0 / Rmed[nRadial];
+	InvSurf[nRadial] = 1.0 / Surf[nRadial];
+	InvDiffRsup[nRadial] = 1.0 / (Rsup[nRadial] - Rinf[nRadial]);
+	InvDiffRsupRb[nRadial] =
+	    1.0 / ((Rsup[nRadial] - Rinf[nRadial]) * Rmed[nRadial]);
+	TwoDiffRaSq[nRadial] = 2.0 / (Rsup[nRadial] * Rsup[nRadial] -
+				      Rinf[nRadial] * Rinf[nRadial]);
+	FourThirdInvRbInvdphiSq[nRadial] =
+	    4.0 / 3.0 / Rmed[nRadial] * invdphi * invdphi;
+	InvRinf[nRadial] = 1.0 / Rinf[nRadial];
+    }
+
+    Rinf[NRadial] = Radii[NRadial + IMIN];
+    InvRinf[NRadial] = 1.0 / Rinf[NRadial];
+
+    // needs the local radii
+    init_cell_finder(radial_cell_growth_factor, radial_first_cell_size);
+
+    for (nRadial = 1; nRadial < NRadial + 1; ++nRadial) {
+	InvDiffRmed[nRadial] = 1.0 / (Rmed[nRadial] - Rmed[nRadial - 1]);
+	TwoDiffRbSq[nRadial] = 2.0 / (Rmed[nRadial] * Rmed[nRadial] -
+				      Rmed[nRadial - 1] * Rmed[nRadial - 1]);
+    }
+}
+
 /**
 	Fills 1D arrays like Rmed, Rinf, Rsup, Surf, ...
 */
@@ -158,8 +208,6 @@ void init_radialarrays()
 	}
     }
 
-    init_cell_finder(cell_growth_factor, first_cell_size);
-
     /* if input file is open, close it */
     if (fd_input != NULL) {
 	fclose(fd_input);
@@ -185,44 +233,9 @@ void init_radialarrays()
 	parameters::radial_grid_names[parameters::radial_grid_type], Radii[1],
 	Radii[GlobalNRadial - 1], Radii[0], Radii[GlobalNRadial]);
 
-    for (nRadial = 0; nRadial < NRadial + search_buffer; ++nRadial) {
-	Rinf[nRadial] = Radii[nRadial + IMIN];
-	Rsup[nRadial] = Radii[nRadial + IMIN + 1];
-
-	Rmed[nRadial] = 2.0 / 3.0 *
-			(std::pow(Rsup[nRadial], 3) -
-			 std::pow(Rinf[nRadial], 3));
-	Rmed[nRadial] = Rmed[nRadial] / (std::pow(Rsup[nRadial], 2) -
-					 std::pow(Rinf[nRadial], 2));
-
-	// TODO: Is already calculated a few lines above. assert should check
-	// this
-	assert((Rmed[nRadial] - GlobalRmed[nRadial + IMIN]) < std::numeric_limits<double>::epsilon());
-
-	Surf[nRadial] =
-	    M_PI * (std::pow(Rsup[nRadial], 2) - std::pow(Rinf[nRadial], 2)) /
-	    (double)NAzimuthal;
-
-	InvRmed[nRadial] = 1.0 / Rmed[nRadial];
-	InvSurf[nRadial] = 1.0 / Surf[nRadial];
-	InvDiffRsup[nRadial] = 1.0 / (Rsup[nRadial] - Rinf[nRadial]);
-	InvDiffRsupRb[nRadial] =
-	    1.0 / ((Rsup[nRadial] - Rinf[nRadial]) * Rmed[nRadial]);
-	TwoDiffRaSq[nRadial] = 2.0 / (Rsup[nRadial] * Rsup[nRadial] -
-				      Rinf[nRadial] * Rinf[nRadial]);
-	FourThirdInvRbInvdphiSq[nRadial] =
-	    4.0 / 3.0 / Rmed[nRadial] * invdphi * invdphi;
-	InvRinf[nRadial] = 1.0 / Rinf[nRadial];
-    }
-
-    Rinf[NRadial] = Radii[NRadial + IMIN];
-    InvRinf[NRadial] = 1.0 / Rinf[NRadial];
-
-    for (nRadial = 1; nRadial < NRadial + 1; ++nRadial) {
-	InvDiffRmed[nRadial] = 1.0 / (Rmed[nRadial] - Rmed[nRadial - 1]);
-	TwoDiffRbSq[nRadial] = 2.0 / (Rmed[nRadial] * Rmed[nRadial] -
-				      Rmed[nRadial - 1] * Rmed[nRadial - 1]);
-    }
+    radial_cell_growth_factor = cell_growth_factor;
+    radial_first_cell_size = first_cell_size;
+    init_local_radialarrays();
 
     /* output radii to used_rad.dat (on master only) */
     if (CPU_Master) {
@@ -245,7 +258,7 @@ void init_radialarrays()
 	if (fd_output != NULL)
 	    fclose(fd_output);
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 }
 
 /**
@@ -1641,46 +1654,16 @@ void init_gas_velocities(t_data &data)
 
 	/* vt_int \equiv rOmega� = grad(P)/sigma +  \partial(phi)/\partial(r)  -
 	 * acc_sg_radial */
-	mpi_make1Dprofile(data[t_data::PRESSURE].Field, GLOBAL_bufarray);
+	const std::vector<double> PressureMedGlobal = radial_profile::get(
+	    data[t_data::PRESSURE], radial_profile::reduction_mean);
 
 	// get global SigmaMed
 	t_radialarray SigmaMedGlobal(GlobalNRadial);
-	MPI_Status status;
-	MPI_Request request;
-
-	for (int i = 0; i < CPU_Number; ++i) {
-	    if (i == CPU_Rank) {
-		// receive data from prev CPU
-		if (CPU_Rank > 0) {
-		    MPI_Irecv(&SigmaMedGlobal[0], IMIN + CPUOVERLAP - 1,
-			      MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD,
-			      &request);
-		    MPI_Wait(&request, &status);
-		}
-		// insert own data
-		for (unsigned int j = IMIN + (CPU_Rank == 0 ? 0 : CPUOVERLAP);
-		     j <= IMAX - (CPU_Rank == CPU_Highest ? 0 : CPUOVERLAP);
-		     ++j) {
-		    SigmaMedGlobal[j] =
-			SigmaMed[Zero_or_active + j - IMIN -
-				 (CPU_Rank == 0 ? 0 : CPUOVERLAP)];
-		}
-		// send data to next CPU
-		if (CPU_Rank < CPU_Highest) {
-		    MPI_Isend(&SigmaMedGlobal[0], IMAX - CPUOVERLAP, MPI_DOUBLE,
-			      CPU_Next, 0, MPI_COMM_WORLD, &request);
-		    MPI_Wait(&request, &status);
-		}
-	    }
-	}
-
-	// now CPU_Highst has all data. broadcast to everybody
-	MPI_Bcast(&SigmaMedGlobal[0], GlobalNRadial, MPI_DOUBLE, CPU_Highest,
-		  MPI_COMM_WORLD);
+	radial_profile::gather(&SigmaMed[0], &SigmaMedGlobal[0]);
 
 	/* global axisymmetric pressure field, known by all cpus */
 	for (unsigned int i = 1; i < GlobalNRadial; i++) {
-	    vt_int[i] = (GLOBAL_bufarray[i] - GLOBAL_bufarray[i - 1]) /
+	    vt_int[i] = (PressureMedGlobal[i] - PressureMedGlobal[i - 1]) /
 			    (.5 * (SigmaMedGlobal[i] + SigmaMedGlobal[i - 1])) /
 			    (GlobalRmed[i] - GlobalRmed[i - 1]) +
 			constants::G * hydro_center_mass *
@@ -2,7 +2,14 @@
 
 #include "data.h"
 
+// Radial arrays have size MAX1D so we can write to N+search_buffer safely
+// we do this to avoid errors when accessing nr+x in the code
+// less than 15 should be safe too, but we need at least 2 or else
+// rmed_id_error_check accessing 'id+1' can cause errors
+const unsigned int search_buffer = 15;
+
 void init_radialarrays(void);
+void init_local_radialarrays(void);
 void resize_radialarrays(unsigned int size);
 
 void init_physics(t_data &data);
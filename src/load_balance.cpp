@@ -0,0 +1,456 @@
+/**
+	\file load_balance.cpp
+
+	Radial load balancing across MPI processes.
+
+	Every process measures the time it spends in the local compute phases
+	of the hydro step (start_timer/stop_timer). At every snapshot the times
+	are spread over the active rings of each process and blended into a
+	per ring cost profile, which is stored in ring_costs.dat in the output
+	directory.
+
+	SplitDomain assigns contiguous ring ranges of equal cost according to
+	this profile instead of equal numbers of rings. During the run, the
+	rings are redistributed at a snapshot if the profile predicts that the
+	slowest process needs more than rebalance_threshold times the average.
+	All grids of t_data are then moved to the new decomposition and the
+	domain dependent state of the other modules is rebuilt. Self-gravity,
+	particles and radiative diffusion keep domain dependent state that is
+	not rebuilt; with them the cost weighted decomposition is only applied
+	when the simulation is restarted. The snapshot data is stored in global
+	ring order, so it can be read with any decomposition.
+
+	The decomposition imposed by FFTW for the polar self-gravity solver is
+	not changed, LoadBalancing is disabled with a warning in that case.
+*/
+
+#include "load_balance.h"
+#include "LowTasks.h"
+#include "SideEuler.h"
+#include "TransportEuler.h"
+#include "cfl.h"
+#include "constants.h"
+#include "derived_fields.h"
+#include "fld.h"
+#include "global.h"
+#include "init.h"
+#include "logging.h"
+#include "mode_analysis.h"
+#include "output.h"
+#include "output_products.h"
+#include "parameters.h"
+#include "radial_profile.h"
+#include "split.h"
+#include "velocity_gradient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mpi.h>
+#include <numeric>
+#include <string>
+
+namespace load_balance
+{
+
+// weight of the new measurement when blending with the stored profile
+static const double blend_factor = 0.5;
+// redistribute if the slowest process is expected to need more than this
+// factor times the average
+static const double rebalance_threshold = 1.1;
+
+// rings are redistributed during the run, see init()
+static bool in_run = false;
+
+static double busy_time = 0.0;
+static std::chrono::steady_clock::time_point timer_start;
+
+static std::string cost_filename()
+{
+    return output::outdir + "ring_costs.dat";
+}
+
+/**
+	Check whether the cost weighted decomposition can be applied in the
+	current setup. Has to be called before SplitDomain.
+*/
+void init()
+{
+    if (!parameters::load_balancing) {
+	return;
+    }
+
+    if (parameters::self_gravity &&
+	parameters::self_gravity_solver == parameters::sg_solver_polar) {
+	logging::print_master(
+	    LOG_WARNING
+	    "LoadBalancing has no effect with SelfGravitySolver = polar, the domain decomposition is imposed by FFTW. Load balancing is disabled.\n");
+	parameters::load_balancing = false;
+	return;
+    }
+
+    in_run = !parameters::self_gravity && !parameters::integrate_particles &&
+	     !fld::radiative_diffusion_enabled;
+    if (in_run) {
+	logging::print_master(
+	    LOG_INFO
+	    "Load balance: rings are redistributed at snapshots if the slowest process needs more than %.2f times the average.\n",
+	    rebalance_threshold);
+    } else {
+	logging::print_master(
+	    LOG_WARNING
+	    "LoadBalancing: rings are not redistributed during the run with self-gravity, particles or radiative diffusion, the cost weighted decomposition is only applied when the simulation is restarted.\n");
+    }
+}
+
+void start_timer() { timer_start = std::chrono::steady_clock::now(); }
+
+void stop_timer()
+{
+    busy_time += std::chrono::duration<double>(
+		     std::chrono::steady_clock::now() - timer_start)
+		     .count();
+}
+
+/**
+	Read the stored cost profile. Returns false if there is none for the
+	current number of rings.
+*/
+static bool read_costs(std::vector<double> &costs)
+{
+    std::ifstream file(cost_filename());
+    if (!file.is_open()) {
+	return false;
+    }
+
+    costs.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+	if (line.empty() || line[0] == '#') {
+	    continue;
+	}
+	costs.push_back(std::stod(line));
+    }
+
+    return costs.size() == GlobalNRadial;
+}
+
+/**
+	Add the time measured since the last call to the cost profile and
+	write it to file. Also reports the load imbalance of the processes.
+*/
+void write_costs()
+{
+    const int active_rings = Max_or_active - Zero_or_active;
+    const int first_ring = IMIN + Zero_or_active;
+
+    std::vector<double> times(CPU_Number);
+    std::vector<int> rings(CPU_Number), first_rings(CPU_Number);
+    MPI_Gather(&busy_time, 1, MPI_DOUBLE, times.data(), 1, MPI_DOUBLE, 0,
+	       CPU_Comm);
+    MPI_Gather(&active_rings, 1, MPI_INT, rings.data(), 1, MPI_INT, 0,
+	       CPU_Comm);
+    MPI_Gather(&first_ring, 1, MPI_INT, first_rings.data(), 1, MPI_INT, 0,
+	       CPU_Comm);
+    busy_time = 0.0;
+
+    if (!CPU_Master) {
+	return;
+    }
+
+    const double total_time = std::accumulate(times.begin(), times.end(), 0.0);
+    if (total_time <= 0.0) {
+	return;
+    }
+
+    const double max_time = *std::max_element(times.begin(), times.end());
+    logging::print_master(
+	LOG_INFO "Load balance: slowest process needs %.2f times the average.\n",
+	max_time * CPU_Number / total_time);
+
+    // cost per ring, normalized to a mean of 1
+    std::vector<double> costs(GlobalNRadial, 0.0);
+    for (int rank = 0; rank < CPU_Number; ++rank) {
+	const double ring_cost =
+	    times[rank] / rings[rank] * GlobalNRadial / total_time;
+	for (int i = 0; i < rings[rank]; ++i) {
+	    costs[first_rings[rank] + i] = ring_cost;
+	}
+    }
+
+    std::vector<double> old_costs;
+    if (read_costs(old_costs)) {
+	for (unsigned int nr = 0; nr < GlobalNRadial; ++nr) {
+	    costs[nr] = blend_factor * costs[nr] +
+			(1.0 - blend_factor) * old_costs[nr];
+	}
+    }
+
+    FILE *fd = fopen(cost_filename().c_str(), "w");
+    if (fd == NULL) {
+	logging::print_master(LOG_ERROR "Can't write '%s' file.\n",
+			      cost_filename().c_str());
+	return;
+    }
+    fprintf(fd, "#FargoCPT ring cost file\n");
+    fprintf(fd, "#version: 1.0\n");
+    fprintf(fd, "#relative computational cost of each ring\n");
+    for (unsigned int nr = 0; nr < GlobalNRadial; ++nr) {
+	fprintf(fd, "%#.6g\n", costs[nr]);
+    }
+    fclose(fd);
+}
+
+/**
+	Read the stored cost profile on the master and distribute it to all
+	processes. Returns false if there is none.
+*/
+static bool load_costs(std::vector<double> &costs)
+{
+    int available = 0;
+    if (CPU_Master) {
+	available = read_costs(costs) ? 1 : 0;
+    }
+    MPI_Bcast(&available, 1, MPI_INT, 0, CPU_Comm);
+    if (!available) {
+	return false;
+    }
+    costs.resize(GlobalNRadial);
+    MPI_Bcast(costs.data(), GlobalNRadial, MPI_DOUBLE, 0, CPU_Comm);
+    return true;
+}
+
+/**
+	Cost of the rings [0, nr) for every nr.
+*/
+static std::vector<double> cumulative_costs(const std::vector<double> &costs)
+{
+    // rings without cost would allow arbitrarily large domains
+    const double mean_cost =
+	std::accumulate(costs.begin(), costs.end(), 0.0) / GlobalNRadial;
+    std::vector<double> cumulative(GlobalNRadial + 1, 0.0);
+    for (unsigned int nr = 0; nr < GlobalNRadial; ++nr) {
+	cumulative[nr + 1] =
+	    cumulative[nr] + std::max(costs[nr], 0.01 * mean_cost);
+    }
+    return cumulative;
+}
+
+/**
+	Split at the quantiles of the cumulative cost. Every process needs at
+	least 2 * CPUOVERLAP rings.
+*/
+static void partition(const std::vector<double> &cumulative,
+		      std::vector<unsigned int> &first_ring)
+{
+    const unsigned int min_rings = 2 * CPUOVERLAP;
+    first_ring.assign(CPU_Number + 1, 0);
+    first_ring[CPU_Number] = GlobalNRadial;
+    for (int rank = 1; rank < CPU_Number; ++rank) {
+	const double target = cumulative[GlobalNRadial] * rank / CPU_Number;
+	unsigned int ring =
+	    std::lower_bound(cumulative.begin(), cumulative.end(), target) -
+	    cumulative.begin();
+	ring = std::max(ring, first_ring[rank - 1] + min_rings);
+	ring = std::min(ring, GlobalNRadial - (CPU_Number - rank) * min_rings);
+	first_ring[rank] = ring;
+    }
+}
+
+/**
+	Cost of the most expensive process relative to the average.
+*/
+static double imbalance(const std::vector<double> &cumulative,
+			const std::vector<unsigned int> &first_ring)
+{
+    double max_cost = 0.0;
+    for (int rank = 0; rank < CPU_Number; ++rank) {
+	max_cost = std::max(max_cost, cumulative[first_ring[rank + 1]] -
+					  cumulative[first_ring[rank]]);
+    }
+    return max_cost * CPU_Number / cumulative[GlobalNRadial];
+}
+
+/**
+	Compute the first ring of every process such that all processes get
+	rings of about equal cost. Returns false if load balancing is disabled
+	or there is no cost profile.
+*/
+bool get_partition(std::vector<unsigned int> &first_ring)
+{
+    if (!parameters::load_balancing) {
+	return false;
+    }
+
+    std::vector<double> costs;
+    if (!load_costs(costs)) {
+	logging::print_master(LOG_INFO "Load balance: no cost profile found, using equal ring numbers.\n");
+	return false;
+    }
+
+    partition(cumulative_costs(costs), first_ring);
+
+    logging::print_master(LOG_INFO "Load balance: using cost weighted domain decomposition.\n");
+    return true;
+}
+
+/**
+	Copy the rows of a grid from the old to the new domain decomposition.
+	Every row is sent by the process it was active on before, the ghost
+	rows of the new domains are filled the same way.
+
+	\param old_data rows of the old local domain, starting at ring old_imin
+	\param old_first first active ring of every process in the old
+	decomposition, old_first[CPU_Number] = GlobalNRadial
+	\param new_imin IMIN of every process in the new decomposition
+	\param new_imax IMAX of every process in the new decomposition
+	\param new_data rows of the new local domain, starting at ring IMIN
+	\param row_length number of values per row
+	\param vector true for quantities on the radial interfaces, which have
+	one row more
+*/
+static void migrate_rows(const double *old_data, const unsigned int old_imin,
+			 const std::vector<unsigned int> &old_first,
+			 const std::vector<unsigned int> &new_imin,
+			 const std::vector<unsigned int> &new_imax,
+			 double *new_data, const unsigned int row_length,
+			 const bool vector)
+{
+    const unsigned int extra = vector ? 1 : 0;
+
+    std::vector<int> send_counts(CPU_Number, 0), send_displacements(CPU_Number, 0);
+    std::vector<int> recv_counts(CPU_Number, 0), recv_displacements(CPU_Number, 0);
+
+    for (int rank = 0; rank < CPU_Number; ++rank) {
+	// rows this process was active on and rank needs
+	const unsigned int owned_first = old_first[CPU_Rank];
+	const unsigned int owned_end =
+	    old_first[CPU_Rank + 1] + (CPU_Rank == CPU_Number - 1 ? extra : 0);
+	const unsigned int send_first = std::max(owned_first, new_imin[rank]);
+	const unsigned int send_end =
+	    std::min(owned_end, new_imax[rank] + 1 + extra);
+	if (send_end > send_first) {
+	    send_counts[rank] = (send_end - send_first) * row_length;
+	    send_displacements[rank] = (send_first - old_imin) * row_length;
+	}
+
+	// rows rank was active on and this process needs
+	const unsigned int other_first = old_first[rank];
+	const unsigned int other_end =
+	    old_first[rank + 1] + (rank == CPU_Number - 1 ? extra : 0);
+	const unsigned int recv_first = std::max(other_first, IMIN);
+	const unsigned int recv_end = std::min(other_end, IMAX + 1 + extra);
+	if (recv_end > recv_first) {
+	    recv_counts[rank] = (recv_end - recv_first) * row_length;
+	    recv_displacements[rank] = (recv_first - IMIN) * row_length;
+	}
+    }
+
+    MPI_Alltoallv(old_data, send_counts.data(), send_displacements.data(),
+		  MPI_DOUBLE, new_data, recv_counts.data(),
+		  recv_displacements.data(), MPI_DOUBLE, CPU_Comm);
+}
+
+/**
+	Redistribute the rings according to the current cost profile if the
+	decomposition is too unbalanced. Has to be called by all processes
+	after write_costs, with the boundaries of all grids communicated.
+*/
+void rebalance(t_data &data)
+{
+    if (!in_run) {
+	return;
+    }
+
+    std::vector<double> costs;
+    if (!load_costs(costs)) {
+	return;
+    }
+    const std::vector<double> cumulative = cumulative_costs(costs);
+
+    std::vector<unsigned int> old_first(CPU_Number + 1);
+    const unsigned int first_active = IMIN + Zero_or_active;
+    MPI_Allgather(&first_active, 1, MPI_UNSIGNED, old_first.data(), 1,
+		  MPI_UNSIGNED, CPU_Comm);
+    old_first[CPU_Number] = GlobalNRadial;
+
+    std::vector<unsigned int> new_first;
+    partition(cumulative, new_first);
+
+    const double old_imbalance = imbalance(cumulative, old_first);
+    const double new_imbalance = imbalance(cumulative, new_first);
+    if (old_imbalance <= rebalance_threshold ||
+	new_imbalance >= old_imbalance || new_first == old_first) {
+	return;
+    }
+
+    logging::print_master(
+	LOG_INFO
+	"Load balance: redistributing rings, the slowest process is expected to need %.2f instead of %.2f times the average.\n",
+	new_imbalance, old_imbalance);
+
+    // keep the local data, the grids are reallocated with the new sizes
+    const unsigned int old_imin = IMIN;
+    std::vector<std::vector<double>> polargrids(t_data::N_POLARGRID_TYPES);
+    for (unsigned int i = 0; i < t_data::N_POLARGRID_TYPES; ++i) {
+	const t_polargrid &grid = data[(t_data::t_polargrid_type)i];
+	polargrids[i].assign(grid.Field,
+			     grid.Field + grid.get_size_radial() *
+					      grid.get_size_azimuthal());
+    }
+    std::vector<std::vector<double>> radialgrids(t_data::N_RADIALGRID_TYPES);
+    for (unsigned int i = 0; i < t_data::N_RADIALGRID_TYPES; ++i) {
+	t_radialgrid &grid = data[(t_data::t_radialgrid_type)i];
+	radialgrids[i].assign(&grid(0), &grid(0) + grid.get_size_radial());
+    }
+    const std::vector<double> sigma_med(SigmaMed.array,
+					SigmaMed.array + NRadial);
+    const std::vector<double> energy_med(EnergyMed.array,
+					 EnergyMed.array + NRadial);
+    const std::vector<double> sigma_inf(SigmaInf.array,
+					SigmaInf.array + NRadial + 1);
+
+    // SplitDomain computes the same partition from the cost profile
+    FreeSplitDomain();
+    NRadial = GlobalNRadial;
+    SplitDomain();
+    data.set_size(GlobalNRadial, NAzimuthal, NRadial, NAzimuthal);
+
+    std::vector<unsigned int> new_imin(CPU_Number), new_imax(CPU_Number);
+    MPI_Allgather(&IMIN, 1, MPI_UNSIGNED, new_imin.data(), 1, MPI_UNSIGNED,
+		  CPU_Comm);
+    MPI_Allgather(&IMAX, 1, MPI_UNSIGNED, new_imax.data(), 1, MPI_UNSIGNED,
+		  CPU_Comm);
+
+    for (unsigned int i = 0; i < t_data::N_POLARGRID_TYPES; ++i) {
+	t_polargrid &grid = data[(t_data::t_polargrid_type)i];
+	migrate_rows(polargrids[i].data(), old_imin, old_first, new_imin,
+		     new_imax, grid.Field, grid.get_size_azimuthal(),
+		     grid.is_vector());
+    }
+    for (unsigned int i = 0; i < t_data::N_RADIALGRID_TYPES; ++i) {
+	t_radialgrid &grid = data[(t_data::t_radialgrid_type)i];
+	migrate_rows(radialgrids[i].data(), old_imin, old_first, new_imin,
+		     new_imax, &grid(0), 1, grid.is_vector());
+    }
+    migrate_rows(sigma_med.data(), old_imin, old_first, new_imin, new_imax,
+		 SigmaMed.array, 1, false);
+    migrate_rows(energy_med.data(), old_imin, old_first, new_imin, new_imax,
+		 EnergyMed.array, 1, false);
+    migrate_rows(sigma_inf.data(), old_imin, old_first, new_imin, new_imax,
+		 SigmaInf.array, 1, true);
+
+    // rebuild the state depending on the local rings
+    init_local_radialarrays();
+    InitCellCenterCoordinates();
+    FreeTransport();
+    InitTransport();
+    cfl::init(data);
+    output_products::update_domain();
+    mode_analysis::update_domain();
+    radial_profile::update_domain();
+    velocity_gradient::invalidate();
+    derived_fields::invalidate();
+}
+
+} // namespace load_balance
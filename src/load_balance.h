@@ -0,0 +1,21 @@
+#pragma once
+
+#include "data.h"
+#include <vector>
+
+// Measurement of the computational cost per ring and a cost weighted radial
+// domain decomposition, applied at startup and at snapshots during the run.
+
+namespace load_balance
+{
+
+void init();
+
+void start_timer();
+void stop_timer();
+
+void write_costs();
+bool get_partition(std::vector<unsigned int> &first_ring);
+void rebalance(t_data &data);
+
+} // namespace load_balance
@@ -71,7 +71,7 @@ void init_logfiles(const std::string outdir) {
 	header_buffer.clear();
 	header_buffer_enabled = false;
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 }
 
 void finalize() {
@@ -129,7 +129,10 @@ int vprint(const char *fmt, va_list args)
 	char buf[1028];
 	int res = std::vsnprintf(buf, 1028, fmt, args);
 
-	const std::string cpu_id = "[" + std::string((int)(std::log(CPU_Number) / std::log(10)), '0') + std::to_string(CPU_Rank) + "]";
+	std::string cpu_id = "[" + std::string((int)(std::log(CPU_Number) / std::log(10)), '0') + std::to_string(CPU_Rank) + "]";
+	if (Ensemble_Number > 1) {
+		cpu_id = "[" + std::to_string(Ensemble_Member) + ":" + cpu_id.substr(1);
+	}
 	std::string output = cpu_id + " ";
 	if (time_format) {
 		output += std::string(time_buf) + " ";
@@ -18,8 +18,10 @@
 #include "handle_signals.h"
 #include "init.h"
 #include "logging.h"
+#include "mode_analysis.h"
 #include "options.h"
 #include "output.h"
+#include "output_products.h"
 #include "parameters.h"
 #include "split.h"
 #include "start_mode.h"
@@ -30,15 +32,17 @@
 #include "buildtime_info.h"
 #include "restart.h"
 #include "fld.h"
+#include "load_balance.h"
 
 
 
 static void finalize() {
 	FreeEuler();
+	mode_analysis::finalize();
 	finalize_parallel();
     boundary_conditions::cleanup_custom();
 
-    if (CPU_Master && options::pidfile != "" && std::filesystem::exists(options::pidfile)) {
+    if (CPU_Master && Ensemble_Member == 0 && options::pidfile != "" && std::filesystem::exists(options::pidfile)) {
         std::filesystem::remove(options::pidfile);
     }
     logging::finalize();
@@ -68,6 +72,7 @@ int main(int argc, char *argv[])
 
 
     ReadVariables(options::parameter_file, data, argc, argv);
+    check_ensemble_output_directories();
 
     // check if there is enough free space for all outputs (check before any
     // output are files created)
@@ -88,6 +93,7 @@ int main(int argc, char *argv[])
 
     TellEverything();
 
+    load_balance::init();
     SplitDomain();
 
     if (options::disable)
@@ -105,6 +111,7 @@ int main(int argc, char *argv[])
     // Here planets are initialized feeling star potential
     data.get_planetary_system().init_system();
 	data.get_massflow_tracker().init(data.get_planetary_system());
+    output_products::init(data);
     init_binary_quadropole_moment(data.get_planetary_system());
 
     parameters::summarize_parameters();
@@ -137,7 +144,7 @@ int main(int argc, char *argv[])
 		output::write_1D_info(data);
         output::write_2D_info(data);
 		
-		MPI_Barrier(MPI_COMM_WORLD);
+		MPI_Barrier(CPU_Comm);
     }
 
     sim::timeInitial = sim::time;
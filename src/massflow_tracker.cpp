@@ -66,11 +66,11 @@ void t_massflow_tracker::update_mass_accretion(const double dt){
 		m_mdot = 0.0;
 	}
 	m_delta_mass = 0.0; // reset delta_mass
-	MPI_Send(&m_mdot, 1, MPI_DOUBLE, CPU_Highest, 0, MPI_COMM_WORLD);
+	MPI_Send(&m_mdot, 1, MPI_DOUBLE, CPU_Highest, 0, CPU_Comm);
 	}
 
 	if (CPU_Rank == CPU_Highest && boundary_conditions::rochelobe_overflow) {
-		MPI_Recv(&m_mdot, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD,
+		MPI_Recv(&m_mdot, 1, MPI_DOUBLE, 0, 0, CPU_Comm,
 				 &global_MPI_Status);
 	}
 	return;
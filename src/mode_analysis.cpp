@@ -0,0 +1,307 @@
+/**
+	\file mode_analysis.cpp
+
+	In-situ analysis of azimuthal Fourier modes.
+
+	For each selected polargrid the complex coefficients
+		c_m(r) = 1/N_phi sum_j f(r, phi_j) exp(-i m phi_j)
+	of every ring are computed for m = 0..M at each monitor step.
+
+	Two files per polargrid are written to the monitor directory:
+	modes_<name>.dat holds amplitude and phase of the area weighted disk
+	integrated modes, normalized to the m = 0 mode, and
+	modes_<name>_radial.bin holds one record per monitor step with the time
+	followed by Re(c_m), Im(c_m) for m = 0..M of all GlobalNRadial rings.
+*/
+
+#include "mode_analysis.h"
+#include "LowTasks.h"
+#include "global.h"
+#include "logging.h"
+#include "output.h"
+#include "parameters.h"
+#include "simulation.h"
+#include "start_mode.h"
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mpi.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifndef DISABLE_FFTW
+#include <fftw3.h>
+
+#ifndef NDEBUG
+#undef FFTW_MEASURE
+#define FFTW_MEASURE FFTW_ESTIMATE
+#endif
+#endif // DISABLE_FFTW
+
+namespace mode_analysis
+{
+
+static bool initialized = false;
+static std::vector<t_polargrid *> fields;
+static std::vector<bool> files_created;
+static unsigned int max_mode;
+
+// values per ring in the buffer: area weight followed by Re, Im for m = 0..M
+static unsigned int ring_stride;
+static std::vector<double> mode_buffer;
+
+#ifndef DISABLE_FFTW
+static fftw_plan rings_plan;
+static double *rings_in;
+static fftw_complex *rings_out;
+#else
+static std::vector<double> cos_table;
+static std::vector<double> sin_table;
+#endif // DISABLE_FFTW
+
+#ifndef DISABLE_FFTW
+/**
+	All active rings of this process are transformed with a single plan.
+*/
+static void init_plan()
+{
+    const unsigned int n_rings = radial_active_size - radial_first_active;
+    const int n = NAzimuthal;
+    const int n_complex = NAzimuthal / 2 + 1;
+    rings_in = fftw_alloc_real(n_rings * NAzimuthal);
+    rings_out = fftw_alloc_complex(n_rings * n_complex);
+    rings_plan = fftw_plan_many_dft_r2c(1, &n, n_rings, rings_in, NULL, 1, n,
+					rings_out, NULL, 1, n_complex,
+					FFTW_MEASURE);
+}
+
+static void free_plan()
+{
+    fftw_destroy_plan(rings_plan);
+    fftw_free(rings_in);
+    fftw_free(rings_out);
+}
+#endif // DISABLE_FFTW
+
+static void init(t_data &data)
+{
+    for (const std::string &name : parameters::mode_analysis_fields) {
+	t_polargrid *field = data.get_polargrid_by_name(name);
+	if (field == nullptr) {
+	    die("Unknown polargrid '%s' in ModeAnalysisFields\n", name.c_str());
+	}
+	fields.push_back(field);
+    }
+    files_created.assign(fields.size(), false);
+
+    max_mode = parameters::mode_analysis_max_mode;
+    if (max_mode > NAzimuthal / 2) {
+	max_mode = NAzimuthal / 2;
+	logging::print_master(
+	    LOG_WARNING
+	    "ModeAnalysisMaxMode is larger than Nsec/2, only modes up to m = %u are written.\n",
+	    max_mode);
+    }
+    ring_stride = 1 + 2 * (max_mode + 1);
+
+#ifndef DISABLE_FFTW
+    init_plan();
+#else
+    cos_table.resize((max_mode + 1) * NAzimuthal);
+    sin_table.resize((max_mode + 1) * NAzimuthal);
+    for (unsigned int m = 0; m <= max_mode; ++m) {
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    const double angle = 2.0 * M_PI * m * naz / NAzimuthal;
+	    cos_table[m * NAzimuthal + naz] = std::cos(angle);
+	    sin_table[m * NAzimuthal + naz] = std::sin(angle);
+	}
+    }
+#endif // DISABLE_FFTW
+
+    initialized = true;
+}
+
+void finalize()
+{
+    if (!initialized) {
+	return;
+    }
+#ifndef DISABLE_FFTW
+    free_plan();
+#endif // DISABLE_FFTW
+    initialized = false;
+}
+
+/**
+	Recreate the transform of the active rings after the domain
+	decomposition was changed.
+*/
+void update_domain()
+{
+    if (!initialized) {
+	return;
+    }
+#ifndef DISABLE_FFTW
+    free_plan();
+    init_plan();
+#endif // DISABLE_FFTW
+}
+
+/**
+	Fill the mode buffer with the coefficients of the active rings of this
+	process. All other rings are zero, so the buffer can be summed over all
+	processes.
+*/
+static void compute_ring_modes(const t_polargrid &field)
+{
+    const double inv_Nphi = 1.0 / (double)NAzimuthal;
+
+    mode_buffer.assign(GlobalNRadial * ring_stride, 0.0);
+
+#ifndef DISABLE_FFTW
+    const unsigned int n_complex = NAzimuthal / 2 + 1;
+
+	#pragma omp parallel for
+    for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
+	double *ring = &rings_in[(nr - radial_first_active) * NAzimuthal];
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    ring[naz] = field(nr, naz);
+	}
+    }
+
+    fftw_execute(rings_plan);
+
+	#pragma omp parallel for
+    for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
+	const fftw_complex *spectrum =
+	    &rings_out[(nr - radial_first_active) * n_complex];
+	double *modes = &mode_buffer[(IMIN + nr) * ring_stride];
+	modes[0] = Surf[nr] * NAzimuthal;
+	for (unsigned int m = 0; m <= max_mode; ++m) {
+	    modes[1 + 2 * m] = spectrum[m][0] * inv_Nphi;
+	    modes[2 + 2 * m] = spectrum[m][1] * inv_Nphi;
+	}
+    }
+#else
+	#pragma omp parallel for
+    for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
+	double *modes = &mode_buffer[(IMIN + nr) * ring_stride];
+	modes[0] = Surf[nr] * NAzimuthal;
+	for (unsigned int m = 0; m <= max_mode; ++m) {
+	    double re = 0.0;
+	    double im = 0.0;
+	    for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+		re += field(nr, naz) * cos_table[m * NAzimuthal + naz];
+		im -= field(nr, naz) * sin_table[m * NAzimuthal + naz];
+	    }
+	    modes[1 + 2 * m] = re * inv_Nphi;
+	    modes[2 + 2 * m] = im * inv_Nphi;
+	}
+    }
+#endif // DISABLE_FFTW
+
+    MPI_Reduce(CPU_Master ? MPI_IN_PLACE : mode_buffer.data(),
+	       mode_buffer.data(), mode_buffer.size(), MPI_DOUBLE, MPI_SUM, 0,
+	       CPU_Comm);
+}
+
+static FILE *open_file(const std::string &filename, const bool created,
+		       const bool binary)
+{
+    FILE *fd = fopen(filename.c_str(), created ? (binary ? "ab" : "a")
+					       : (binary ? "wb" : "w"));
+    if (fd == NULL) {
+	logging::print_master(LOG_ERROR "Can't write '%s' file. Aborting.\n",
+			      filename.c_str());
+	PersonalExit(1);
+    }
+    return fd;
+}
+
+static void write_field(const unsigned int field_id)
+{
+    const std::string name = fields[field_id]->get_name();
+    const std::string filename = output::outdir + "monitor/modes_" + name + ".dat";
+    const std::string filename_radial =
+	output::outdir + "monitor/modes_" + name + "_radial.bin";
+
+    // check if files exist and we restarted
+    if ((start_mode::mode == start_mode::mode_restart) &&
+	!files_created[field_id]) {
+	if (access(filename.c_str(), W_OK) != -1) {
+	    files_created[field_id] = true;
+	}
+    }
+
+    FILE *fd = open_file(filename, files_created[field_id], false);
+    FILE *fd_radial = open_file(filename_radial, files_created[field_id], true);
+
+    if (!files_created[field_id]) {
+	std::map<const std::string, const int> columns = {
+	    {"snapshot number", 0}, {"monitor number", 1}, {"time", 2}};
+	std::map<const std::string, const std::string> units = {
+	    {"snapshot number", "1"}, {"monitor number", "1"}, {"time", "time"}};
+	for (unsigned int m = 1; m <= max_mode; ++m) {
+	    const std::string amplitude = "amplitude m=" + std::to_string(m);
+	    const std::string phase = "phase m=" + std::to_string(m);
+	    columns.emplace(amplitude, 1 + 2 * m);
+	    columns.emplace(phase, 2 + 2 * m);
+	    units.emplace(amplitude, "1");
+	    units.emplace(phase, "1");
+	}
+
+	fprintf(fd, "#FargoCPT azimuthal mode file\n");
+	fprintf(fd, "#version: 1.0\n");
+	fprintf(fd, "#field: %s\n", name.c_str());
+	fprintf(fd, "#radial records: %u rings x %u modes x (Re, Im)\n",
+		GlobalNRadial, max_mode + 1);
+	fprintf(fd, "%s",
+		output::text_file_variable_description(columns, units).c_str());
+	files_created[field_id] = true;
+    }
+
+    // disk integrated modes, summed in radial order
+    std::vector<double> re(max_mode + 1, 0.0);
+    std::vector<double> im(max_mode + 1, 0.0);
+    for (unsigned int nr = 0; nr < GlobalNRadial; ++nr) {
+	const double *modes = &mode_buffer[nr * ring_stride];
+	for (unsigned int m = 0; m <= max_mode; ++m) {
+	    re[m] += modes[0] * modes[1 + 2 * m];
+	    im[m] += modes[0] * modes[2 + 2 * m];
+	}
+    }
+
+    const double norm = std::sqrt(re[0] * re[0] + im[0] * im[0]);
+    fprintf(fd, "%u\t%u\t%#.18g", sim::N_snapshot, sim::N_monitor, sim::time);
+    for (unsigned int m = 1; m <= max_mode; ++m) {
+	const double amplitude =
+	    norm > 0.0 ? std::sqrt(re[m] * re[m] + im[m] * im[m]) / norm : 0.0;
+	fprintf(fd, "\t%#.18g\t%#.18g", amplitude, std::atan2(im[m], re[m]));
+    }
+    fprintf(fd, "\n");
+    fclose(fd);
+
+    fwrite(&sim::time, sizeof(double), 1, fd_radial);
+    for (unsigned int nr = 0; nr < GlobalNRadial; ++nr) {
+	fwrite(&mode_buffer[nr * ring_stride + 1], sizeof(double),
+	       ring_stride - 1, fd_radial);
+    }
+    fclose(fd_radial);
+}
+
+void write(t_data &data)
+{
+    if (!initialized) {
+	init(data);
+    }
+
+    for (unsigned int i = 0; i < fields.size(); ++i) {
+	compute_ring_modes(*fields[i]);
+	if (CPU_Master) {
+	    write_field(i);
+	}
+    }
+}
+
+} // namespace mode_analysis
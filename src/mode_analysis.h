@@ -0,0 +1,14 @@
+#pragma once
+
+#include "data.h"
+
+// In-situ analysis of azimuthal Fourier modes of polargrids.
+
+namespace mode_analysis
+{
+
+void write(t_data &data);
+void finalize();
+void update_domain();
+
+} // namespace mode_analysis
@@ -0,0 +1,226 @@
+/**
+	\file monitor_series.cpp
+
+	Binary, append-only time series for the monitor files.
+
+	Layout (native byte order):
+	  t_header        magic "FCPTSERI", version, number of columns and
+	                  size of the header in bytes
+	  t_column_entry  name and unit string of every column, as in the
+	                  '#variable:' lines of the text files
+	  rows            one double per column, appended in order
+
+	Rows are buffered and appended in blocks of MonitorFlushRows rows, at
+	every snapshot and at exit. Every block is written with a single write
+	and flushed, so a crash loses at most the rows of the last block. An
+	incomplete row at the end of the file, e.g. from a crash during a write,
+	is cut off when the file is opened again and ignored by readers.
+*/
+
+#include "monitor_series.h"
+#include "LowTasks.h"
+#include "parameters.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+
+namespace monitor_series
+{
+
+static const char file_magic[8] = {'F', 'C', 'P', 'T', 'S', 'E', 'R', 'I'};
+static const std::uint32_t file_version = 1;
+
+struct t_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_columns;
+    std::uint64_t header_size;
+};
+
+struct t_column_entry {
+    char name[64];
+    char unit[64];
+};
+
+static std::map<std::string, std::unique_ptr<t_series>> series;
+
+/**
+	Name of the binary file belonging to a text monitor file, the extension
+	is replaced by .bin.
+*/
+std::string binary_filename(const std::string &text_filename)
+{
+    return std::filesystem::path(text_filename).replace_extension(".bin");
+}
+
+static std::uint64_t header_size(const unsigned int n_columns)
+{
+    return sizeof(t_header) + n_columns * sizeof(t_column_entry);
+}
+
+static void write_header(const std::string &filename,
+			 const std::vector<t_column> &columns)
+{
+    FILE *fd = fopen(filename.c_str(), "wb");
+    if (fd == NULL) {
+	die("Can't write '%s' file. Aborting.\n", filename.c_str());
+    }
+
+    t_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.n_columns = columns.size();
+    header.header_size = header_size(columns.size());
+
+    std::vector<t_column_entry> entries(columns.size());
+    memset(entries.data(), 0, entries.size() * sizeof(t_column_entry));
+    for (unsigned int i = 0; i < columns.size(); ++i) {
+	strncpy(entries[i].name, columns[i].name.c_str(),
+		sizeof(entries[i].name) - 1);
+	strncpy(entries[i].unit, columns[i].unit.c_str(),
+		sizeof(entries[i].unit) - 1);
+    }
+
+    fwrite(&header, sizeof(header), 1, fd);
+    fwrite(entries.data(), sizeof(t_column_entry), entries.size(), fd);
+    fclose(fd);
+}
+
+/**
+	Check that an existing file has the given columns and cut off an
+	incomplete last row. Returns false if the file can not be continued.
+*/
+static bool prepare_append(const std::string &filename,
+			   const std::vector<t_column> &columns)
+{
+    FILE *fd = fopen(filename.c_str(), "rb");
+    if (fd == NULL) {
+	return false;
+    }
+
+    t_header header;
+    std::vector<t_column_entry> entries(columns.size());
+    bool ok = fread(&header, sizeof(header), 1, fd) == 1 &&
+	      memcmp(header.magic, file_magic, sizeof(file_magic)) == 0 &&
+	      header.version == file_version &&
+	      header.n_columns == columns.size() &&
+	      fread(entries.data(), sizeof(t_column_entry), entries.size(),
+		    fd) == entries.size();
+    fclose(fd);
+
+    for (unsigned int i = 0; ok && i < columns.size(); ++i) {
+	ok = strncmp(entries[i].name, columns[i].name.c_str(),
+		     sizeof(entries[i].name) - 1) == 0;
+    }
+    if (!ok) {
+	return false;
+    }
+
+    const std::uint64_t size = std::filesystem::file_size(filename);
+    const std::uint64_t row_size = columns.size() * sizeof(double);
+    const std::uint64_t complete =
+	header.header_size +
+	(size - header.header_size) / row_size * row_size;
+    if (complete != size) {
+	std::filesystem::resize_file(filename, complete);
+    }
+    return true;
+}
+
+t_series::t_series(const std::string &filename,
+		   const std::vector<t_column> &columns, const bool append)
+    : m_filename(filename), m_n_columns(columns.size())
+{
+    if (!(append && std::filesystem::exists(filename) &&
+	  prepare_append(filename, columns))) {
+	if (append && std::filesystem::exists(filename)) {
+	    die("'%s' has different columns than this simulation writes. Move it away to start a new file.\n",
+		filename.c_str());
+	}
+	write_header(filename, columns);
+    }
+    m_buffer.reserve(parameters::monitor_flush_rows * m_n_columns);
+}
+
+t_series::~t_series() { flush(); }
+
+void t_series::append(std::initializer_list<double> row)
+{
+    if (row.size() != m_n_columns) {
+	die("Row with %u values for '%s' with %u columns!\n",
+	    (unsigned int)row.size(), m_filename.c_str(), m_n_columns);
+    }
+    m_buffer.insert(m_buffer.end(), row.begin(), row.end());
+    if (m_buffer.size() >= parameters::monitor_flush_rows * m_n_columns) {
+	flush();
+    }
+}
+
+void t_series::append(const std::vector<double> &row)
+{
+    if (row.size() != m_n_columns) {
+	die("Row with %u values for '%s' with %u columns!\n",
+	    (unsigned int)row.size(), m_filename.c_str(), m_n_columns);
+    }
+    m_buffer.insert(m_buffer.end(), row.begin(), row.end());
+    if (m_buffer.size() >= parameters::monitor_flush_rows * m_n_columns) {
+	flush();
+    }
+}
+
+void t_series::flush()
+{
+    if (m_buffer.empty()) {
+	return;
+    }
+
+    FILE *fd = fopen(m_filename.c_str(), "ab");
+    if (fd == NULL) {
+	die("Can't write '%s' file. Aborting.\n", m_filename.c_str());
+    }
+    fwrite(m_buffer.data(), sizeof(double), m_buffer.size(), fd);
+    fclose(fd);
+
+    m_buffer.clear();
+}
+
+t_series *get(const std::string &filename)
+{
+    auto it = series.find(filename);
+    if (it == series.end()) {
+	return nullptr;
+    }
+    return it->second.get();
+}
+
+static void flush_at_exit() { flush_all(); }
+
+/**
+	Open the series for filename. If append is set and the file already
+	exists with the same columns, new rows are appended to it, otherwise a
+	new file is started.
+*/
+t_series *open(const std::string &filename,
+	       const std::vector<t_column> &columns, const bool append)
+{
+    if (series.empty()) {
+	std::atexit(flush_at_exit);
+    }
+    auto &entry = series[filename];
+    entry = std::make_unique<t_series>(filename, columns, append);
+    return entry.get();
+}
+
+void flush_all()
+{
+    for (auto &entry : series) {
+	entry.second->flush();
+    }
+}
+
+} // namespace monitor_series
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Binary, append-only time series for the monitor files. See
+// monitor_series.cpp for the file layout.
+
+namespace monitor_series
+{
+
+struct t_column {
+    std::string name;
+    std::string unit;
+};
+
+class t_series
+{
+  public:
+    t_series(const std::string &filename, const std::vector<t_column> &columns,
+	     const bool append);
+    ~t_series();
+
+    void append(std::initializer_list<double> row);
+    void append(const std::vector<double> &row);
+    void flush();
+
+  private:
+    std::string m_filename;
+    unsigned int m_n_columns;
+    std::vector<double> m_buffer;
+};
+
+std::string binary_filename(const std::string &text_filename);
+
+t_series *get(const std::string &filename);
+t_series *open(const std::string &filename,
+	       const std::vector<t_column> &columns, const bool append);
+void flush_all();
+
+} // namespace monitor_series
@@ -1,4 +1,5 @@
 #include "mpi_utils.h"
+#include "global.h"
 #include "logging.h"
 #include <mpi.h>
 #include <stdlib.h>
@@ -31,7 +32,8 @@ void mpi_error_check(const int error)
 	error_string[error_length] = 0;
 	logging::print_master(LOG_ERROR "MPI error code: %s\n", error_string);
 
-	MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+	// only abort this simulation, not the whole ensemble
+	MPI_Abort(CPU_Comm, EXIT_FAILURE);
     }
 }
 
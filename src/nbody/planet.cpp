@@ -3,11 +3,13 @@
 #include "../constants.h"
 #include "../global.h"
 #include "../logging.h"
+#include "../monitor_series.h"
 #include "../output.h"
 #include "../parameters.h"
 #include "../util.h"
 #include "../frame_of_reference.h"
 #include "../simulation.h"
+#include "../start_mode.h"
 #include <cstdio>
 #include <fstream>
 #include <iostream>
@@ -297,6 +299,22 @@ void t_planet::create_planet_file() const
     fclose(fd);
 }
 
+/**
+	Open the binary monitor series. An existing series is only continued
+	when restarting, a fresh run starts a new file.
+*/
+void t_planet::open_monitor_series() const
+{
+    if (!CPU_Master) {
+	return;
+    }
+
+    monitor_series::open(
+	monitor_series::binary_filename(get_monitor_filename()),
+	output::variable_columns(planet_files_column, variable_units),
+	start_mode::mode == start_mode::mode_restart);
+}
+
 void t_planet::write(const unsigned int file_type)
 {
     if (!CPU_Master)
@@ -312,7 +330,12 @@ void t_planet::write(const unsigned int file_type)
 	break;
     case 1:
     filename = get_monitor_filename();
-	write_ascii(filename);
+	if (parameters::monitor_format != parameters::monitor_format_binary) {
+	    write_ascii(filename);
+	}
+	if (parameters::monitor_format != parameters::monitor_format_text) {
+	    write_monitor_series(monitor_series::binary_filename(filename));
+	}
 	reset_accreted_mass();
 	break;
     default:
@@ -355,6 +378,28 @@ void t_planet::write_ascii(const std::string &filename) const
     fclose(fd);
 }
 
+void t_planet::write_monitor_series(const std::string &filename) const
+{
+    const double accreted_mass = get_accreted_mass();
+    double div;
+
+    if (parameters::write_at_every_timestep) {
+	div = parameters::monitor_timestep;
+    } else {
+	div = parameters::monitor_timestep * parameters::Nmonitor;
+    }
+
+    const double accretion_rate = accreted_mass / div;
+
+    monitor_series::get(filename)->append(
+	{(double)sim::N_snapshot, (double)sim::N_monitor, get_x(), get_y(),
+	 get_vx(), get_vy(), get_mass(), sim::time, refframe::OmegaFrame,
+	 get_circumplanetary_mass(), get_eccentricity(), get_angular_momentum(),
+	 get_semi_major_axis(), get_omega(), get_mean_anomaly(),
+	 get_eccentric_anomaly(), get_true_anomaly(), get_pericenter_angle(),
+	 get_torque(), accreted_mass, accretion_rate});
+}
+
 void t_planet::write_binary(const std::string &filename) const
 {
 
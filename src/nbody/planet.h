@@ -214,8 +214,10 @@ class t_planet
 
     void copy(const planet_member_variables &other);
     void create_planet_file() const;
+    void open_monitor_series() const;
     void write(const unsigned int file_type);
     void write_ascii(const std::string &filename) const;
+    void write_monitor_series(const std::string &filename) const;
     void write_binary(const std::string &filename) const;
     void restart();
 
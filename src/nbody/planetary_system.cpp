@@ -131,7 +131,7 @@ void t_planetary_system::init_system()
 
 	// ensure planet monitor files exist
 	create_planet_files();
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 }
 
 void t_planetary_system::derive_config() {
@@ -455,9 +455,13 @@ void t_planetary_system::create_planet_files()
 {
     for (unsigned int i = 0; i < get_number_of_planets(); ++i) {
 		auto & p = get_planet(i);
-		if (!std::filesystem::exists(p.get_monitor_filename())) {
+		if (parameters::monitor_format != parameters::monitor_format_binary &&
+		    !std::filesystem::exists(p.get_monitor_filename())) {
 			p.create_planet_file();
 		}
+		if (parameters::monitor_format != parameters::monitor_format_text) {
+			p.open_monitor_series();
+		}
     }
 }
 
@@ -35,6 +35,8 @@ namespace options
 {
 std::string parameter_file = "";
 std::string pidfile = "";
+std::string ensemble_file = "";
+bool ensemble = false;
 bool memory_usage = false;
 bool disable = false;
 int max_iteration_number = -1;
@@ -51,6 +53,7 @@ static const struct option long_options[] = {
     {"auto", no_argument, NULL, 'a'},
 	{"pidfile", required_argument, NULL, 'P'},
 	{"version", no_argument, NULL, 'V'},
+	{"ensemble", no_argument, NULL, 'E'},
     {0, 0, 0, 0}};
 
 void usage(int argc, char **argv)
@@ -59,7 +62,8 @@ void usage(int argc, char **argv)
     // logging::print_master(
 	// LOG_ERROR
 	printf(
-	"Usage: %s [options] start|restart <N>|auto configfile\n\n"
+	"Usage: %s [options] start|restart <N>|auto configfile\n"
+	"       %s --ensemble [options] start|restart <N>|auto listfile\n\n"
 	"FargoCPT version %s\n\n"
 	"start                  Start a new simulation from scratch\n"
 	"restart <N>            Restart from an old simulation output, latest if no N specified\n"
@@ -74,8 +78,10 @@ void usage(int argc, char **argv)
 	"-N <N> |               Perform N hydro steps.\n"
 	"--version              Print the version string in major.minor.revision syntax.\n"
 	"--pidfile <path>       Path to the file to store the pid in.\n"
+	"--ensemble             Run one simulation per configfile listed in listfile (one per line).\n"
+	"                       The processes are split evenly among them, each configfile needs its own output directory.\n"
 	"",
-	argv[0], version::string);
+	argv[0], argv[0], version::string);
 }
 
 void parse(int argc, char **argv)
@@ -166,6 +172,10 @@ void parse(int argc, char **argv)
 	case 'P':
 		pidfile = std::string(optarg);
 		break;
+
+	case 'E':
+		ensemble = true;
+		break;
 	
 	case 'h':
 	    usage(argc, argv);
@@ -186,6 +196,12 @@ void parse(int argc, char **argv)
 	usage(argc, argv);
 	die("Input error: no parameter file specified");
     }
+
+    // in ensemble mode the last argument lists the parameter files, the one
+    // of this process is selected in init_parallel
+    if (ensemble) {
+	ensemble_file = parameter_file;
+    }
 }
 
 } // namespace options
@@ -11,6 +11,8 @@ void parse(int argc, char **argv);
 extern bool memory_usage;
 extern std::string parameter_file;
 extern std::string pidfile;
+extern std::string ensemble_file;
+extern bool ensemble;
 extern bool disable;
 extern int max_iteration_number;
 } // namespace options
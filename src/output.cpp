@@ -1,18 +1,22 @@
 #include "output.h"
 #include "Force.h"
+#include "checkpoint.h"
 #include "LowTasks.h"
 #include "Pframeforce.h"
 #include "constants.h"
 #include "global.h"
 #include "logging.h"
+#include "monitor_series.h"
 #include "options.h"
 #include "parameters.h"
+#include "particles/dust_deposition.h"
 #include "particles/particles.h"
 #include "quantities.h"
 #include "start_mode.h"
 #include "util.h"
 #include "frame_of_reference.h"
 #include "simulation.h"
+#include "snapshot_writer.h"
 #include "fld.h"
 
 #include <dirent.h>
@@ -199,6 +203,21 @@ static void copy_parameters_to_snapshot_dir()
     }
 }
 
+/**
+	The radii of the grid are stored with every snapshot, so it can be
+	remapped to a different grid on restart.
+*/
+static void copy_radii_to_snapshot_dir()
+{
+    if (CPU_Master) {
+	const std::string src_file = outdir + "used_rad.dat";
+	const std::string dst_file = snapshot_dir + "/used_rad.dat";
+	if (std::filesystem::exists(src_file)) {
+	    std::filesystem::copy_file(src_file, dst_file);
+	}
+    }
+}
+
 void write_output_version()
 {
     if (CPU_Master) {
@@ -253,7 +272,7 @@ void write_full_output(t_data &data, const std::string &snapshot_id,
     snapshot_dir = outdir + "snapshots/" + snapshot_id;
     delete_directory_if_exists(snapshot_dir);
     ensure_directory_exists(snapshot_dir);
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 
     // Enable output of Qplus / Qminus for bitwise exact restarting.
 	if (parameters::bitwise_exact_restarting && !parameters::Locally_Isothermal) {
@@ -285,6 +304,8 @@ void write_full_output(t_data &data, const std::string &snapshot_id,
 
     // write misc stuff (important for resuming)
     output::write_misc();
+    // monitor rows up to the snapshot survive a crash after it
+    monitor_series::flush_all();
     // write particles
     if (parameters::integrate_particles) {
 	particles::write();
@@ -299,8 +320,9 @@ void write_full_output(t_data &data, const std::string &snapshot_id,
     }
 
     copy_parameters_to_snapshot_dir();
+    copy_radii_to_snapshot_dir();
 
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 }
 
 void write_grids(t_data &data, int index, int iter, double phystime)
@@ -310,14 +332,27 @@ void write_grids(t_data &data, int index, int iter, double phystime)
 	snapshot_dir.c_str(), index, iter, phystime);
 
     // go thru all grids and write them
+    const bool write_2D_files =
+	parameters::checkpoint_container != parameters::checkpoint_container_only;
+    snapshot_writer::begin_batch();
     for (unsigned int i = 0; i < t_data::N_POLARGRID_TYPES; ++i) {
-	data[(t_data::t_polargrid_type)i].write_polargrid(data);
+	data[(t_data::t_polargrid_type)i].write_polargrid(data, write_2D_files);
     }
-
-    // go thru all grids and write them
+    dust_deposition::write_species_grids(data, write_2D_files);
     for (unsigned int i = 0; i < t_data::N_RADIALGRID_TYPES; ++i) {
 	data[(t_data::t_radialgrid_type)i].write_radialgrid(index, data);
     }
+    snapshot_writer::end_batch();
+
+    if (parameters::checkpoint_container != parameters::checkpoint_container_no) {
+	checkpoint::write(data, snapshot_dir);
+    }
+
+    for (unsigned int i = 0; i < t_data::N_POLARGRID_TYPES; ++i) {
+	if (data[(t_data::t_polargrid_type)i].get_clear_after_write()) {
+	    data[(t_data::t_polargrid_type)i].clear();
+	}
+    }
 }
 
 /**
@@ -329,8 +364,20 @@ void write_quantities(t_data &data, bool force_update)
     std::string filename = outdir + "monitor/Quantities.dat";
     auto fd_filename = filename.c_str();
     static bool fd_created = false;
+    static monitor_series::t_series *series = nullptr;
+    const bool write_text =
+	parameters::monitor_format != parameters::monitor_format_binary;
+    const bool write_binary =
+	parameters::monitor_format != parameters::monitor_format_text;
+
+    if (CPU_Master && write_binary && series == nullptr) {
+	series = monitor_series::open(
+	    monitor_series::binary_filename(filename),
+	    variable_columns(quantities_file_column, quantities_file_variables),
+	    start_mode::mode == start_mode::mode_restart);
+    }
 
-    if (CPU_Master) {
+    if (CPU_Master && write_text) {
 
 	// check if file exists and we restarted
 	if ((start_mode::mode == start_mode::mode_restart) && !(fd_created)) {
@@ -422,7 +469,8 @@ void write_quantities(t_data &data, bool force_update)
 	const double scale_height =
 	quantities::gas_reduce_mass_average(data, data[t_data::ASPECTRATIO], quantities_limit_radius);
 
-    double pdivv_total = 0.0;
+    // already reduced over all processes
+    const double pdivv_total = data.pdivv_total;
     double InnerBoundaryInflow = 0.0;
     double InnerBoundaryOutflow = 0.0;
     double OuterBoundaryInflow = 0.0;
@@ -433,28 +481,43 @@ void write_quantities(t_data &data, bool force_update)
 	double OuterWaveDampingMassRemoval = 0.0;
     double FloorMassCreation = 0.0;
 
-    MPI_Reduce(&data.pdivv_total, &pdivv_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-	       MPI_COMM_WORLD);
     MPI_Reduce(&MassDelta.InnerBoundaryInflow, &InnerBoundaryInflow, 1, MPI_DOUBLE, MPI_SUM,
-	       0, MPI_COMM_WORLD);
+	       0, CPU_Comm);
     MPI_Reduce(&MassDelta.InnerBoundaryOutflow, &InnerBoundaryOutflow, 1, MPI_DOUBLE, MPI_SUM,
-	       0, MPI_COMM_WORLD);
+	       0, CPU_Comm);
     MPI_Reduce(&MassDelta.OuterBoundaryInflow, &OuterBoundaryInflow, 1, MPI_DOUBLE, MPI_SUM,
-	       0, MPI_COMM_WORLD);
+	       0, CPU_Comm);
     MPI_Reduce(&MassDelta.OuterBoundaryOutflow, &OuterBoundaryOutflow, 1, MPI_DOUBLE, MPI_SUM,
-	       0, MPI_COMM_WORLD);
+	       0, CPU_Comm);
 	MPI_Reduce(&MassDelta.InnerWaveDampingMassCreation, &InnerWaveDampingMassCreation, 1,
-	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	       MPI_DOUBLE, MPI_SUM, 0, CPU_Comm);
 	MPI_Reduce(&MassDelta.OuterWaveDampingMassCreation, &OuterWaveDampingMassCreation, 1,
-		   MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		   MPI_DOUBLE, MPI_SUM, 0, CPU_Comm);
 	MPI_Reduce(&MassDelta.InnerWaveDampingMassRemoval, &InnerWaveDampingMassRemoval, 1,
-	       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	       MPI_DOUBLE, MPI_SUM, 0, CPU_Comm);
 	MPI_Reduce(&MassDelta.OuterWaveDampingMassRemoval, &OuterWaveDampingMassRemoval, 1,
-		   MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		   MPI_DOUBLE, MPI_SUM, 0, CPU_Comm);
     MPI_Reduce(&MassDelta.FloorMassCreation, &FloorMassCreation, 1, MPI_DOUBLE, MPI_SUM,
-	       0, MPI_COMM_WORLD);
+	       0, CPU_Comm);
+
+    if (CPU_Master && write_binary) {
+	series->append(
+	    {(double)sim::N_snapshot, (double)sim::N_monitor, sim::time,
+	     totalMass, diskRadius, totalAngularMomentum, totalEnergy,
+	     internalEnergy, kinematicEnergy, gravitationalEnergy,
+	     radialKinematicEnergy, azimuthalKinematicEnergy,
+	     average_eccentricity, average_periastron, qplus, qminus,
+	     pdivv_total, InnerBoundaryInflow, InnerBoundaryOutflow,
+	     OuterBoundaryInflow, OuterBoundaryOutflow,
+	     InnerWaveDampingMassCreation, InnerWaveDampingMassRemoval,
+	     OuterWaveDampingMassCreation, OuterWaveDampingMassRemoval,
+	     FloorMassCreation, scale_height, refframe::IndirectTermPlanets.x,
+	     refframe::IndirectTermPlanets.y, refframe::IndirectTermDisk.x,
+	     refframe::IndirectTermDisk.y, refframe::FrameAngle, tadv, tvisc,
+	     tgrav});
+    }
 
-    if (CPU_Master) {
+    if (CPU_Master && write_text) {
 	// print to logfile
 	fprintf(
 	    fd,
@@ -491,6 +554,36 @@ void write_quantities(t_data &data, bool force_update)
 	log misc. data
 */
 
+/**
+	Collect the scalar simulation state needed for restarting.
+*/
+misc_entry get_misc()
+{
+    misc_entry misc;
+    memset(&misc, 0, sizeof(misc_entry));
+
+    misc.timestep = sim::N_snapshot;
+    misc.nTimeStep = sim::N_monitor;
+    misc.time = sim::time;
+    misc.OmegaFrame = refframe::OmegaFrame;
+    misc.FrameAngle = refframe::FrameAngle;
+    misc.last_dt = sim::last_dt;
+    misc.N_iter = sim::N_hydro_iter;
+
+    return misc;
+}
+
+void set_misc(const misc_entry &misc)
+{
+    sim::N_snapshot = misc.timestep;
+    sim::N_monitor = misc.nTimeStep;
+    sim::time = misc.time;
+    refframe::OmegaFrame = misc.OmegaFrame;
+    refframe::FrameAngle = misc.FrameAngle;
+    sim::last_dt = misc.last_dt;
+    sim::N_hydro_iter = misc.N_iter;
+}
+
 void write_misc()
 {
     if (!CPU_Master) {
@@ -509,18 +602,7 @@ void write_misc()
 	PersonalExit(1);
     }
 
-	misc_entry misc;
-	memset(&misc, 0, sizeof(misc_entry));
-
-	
-    misc.timestep = sim::N_snapshot;
-    misc.nTimeStep = sim::N_monitor;
-    misc.time = sim::time;
-    misc.OmegaFrame = refframe::OmegaFrame;
-    misc.FrameAngle = refframe::FrameAngle;
-    misc.last_dt = sim::last_dt;
-    misc.N_iter = sim::N_hydro_iter;
-
+    const misc_entry misc = get_misc();
     wf.write((char *)&misc, sizeof(misc));
 
     wf.close();
@@ -566,14 +648,13 @@ static std::string unit_descriptor(double value, std::string unit)
     return us.str();
 }
 
-std::string text_file_variable_description(
+/**
+	Name and unit of every variable, ordered by column.
+*/
+std::vector<monitor_series::t_column> variable_columns(
     const std::map<const std::string, const int> &variables,
     const std::map<const std::string, const std::string> &units)
 {
-    // construct a header string describing each variable in
-    // its own line including the column and its unit. e.g.
-    // #variable: 1 | time | s
-
     std::map<int, std::string> vars_by_column;
     for (auto const &ent : variables) {
 	std::string name = ent.first;
@@ -609,13 +690,29 @@ std::string text_file_variable_description(
 	{"torque", unit_descriptor(units::torque.get_code_to_cgs_factor(),
 				   units::torque.get_cgs_symbol())}};
 
-    std::string var_descriptor;
+    std::vector<monitor_series::t_column> columns;
     for (auto const &ent : vars_by_column) {
-	std::string column = std::to_string(ent.first);
 	std::string name = ent.second;
 	std::string unit = units.at(name);
-	var_descriptor += "#variable: " + column + " | " + name + " | " +
-			  unit_descriptors[unit] + "\n";
+	columns.push_back({name, unit_descriptors[unit]});
+    }
+    return columns;
+}
+
+std::string text_file_variable_description(
+    const std::map<const std::string, const int> &variables,
+    const std::map<const std::string, const std::string> &units)
+{
+    // construct a header string describing each variable in
+    // its own line including the column and its unit. e.g.
+    // #variable: 1 | time | s
+
+    std::string var_descriptor;
+    unsigned int column = 0;
+    for (auto const &col : variable_columns(variables, units)) {
+	var_descriptor += "#variable: " + std::to_string(column) + " | " +
+			  col.name + " | " + col.unit + "\n";
+	++column;
     }
     return var_descriptor;
 }
@@ -637,14 +734,7 @@ int load_misc()
     misc_entry misc;
 
     rf.read((char *)&misc, sizeof(misc_entry));
-
-    sim::N_snapshot = misc.timestep;
-    sim::N_monitor = misc.nTimeStep;
-    sim::time = misc.time;
-    refframe::OmegaFrame = misc.OmegaFrame;
-    refframe::FrameAngle = misc.FrameAngle;
-    sim::last_dt = misc.last_dt;
-    sim::N_hydro_iter = misc.N_iter;
+    set_misc(misc);
 
     rf.close();
     return misc.timestep;
@@ -846,7 +936,7 @@ void write_2D_info(t_data &data)
     }
 	info_ofs.close();
 	}
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 }
 
 void write_lightcurves(t_data &data, unsigned int timestep, bool force_update)
@@ -867,14 +957,6 @@ void write_lightcurves(t_data &data, unsigned int timestep, bool force_update)
 	dissipation_values[i] = 0.0;
     }
 
-    // all cpu except the lowest one expects data
-    if (CPU_Rank > 0) {
-	MPI_Recv(luminosity_values, parameters::lightcurves_radii.size(),
-		 MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, NULL);
-	MPI_Recv(dissipation_values, parameters::lightcurves_radii.size(),
-		 MPI_DOUBLE, CPU_Prev, 0, MPI_COMM_WORLD, NULL);
-    }
-
 	/// TODO: openMP parallel
     unsigned int current_lightcurves_bin = 0;
     for (unsigned int n_radial = radial_first_active;
@@ -891,13 +973,13 @@ void write_lightcurves(t_data &data, unsigned int timestep, bool force_update)
 	    data[t_data::DISSIPATION_1D](n_radial);
     }
 
-    // all cpu except the hightest one sends data
-    if (CPU_Rank < CPU_Highest) {
-	MPI_Send(luminosity_values, parameters::lightcurves_radii.size(),
-		 MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD);
-	MPI_Send(dissipation_values, parameters::lightcurves_radii.size(),
-		 MPI_DOUBLE, CPU_Next, 0, MPI_COMM_WORLD);
-    }
+    // sum the bins of all cpus on the one writing the files
+    MPI_Reduce(CPU_Rank == CPU_Highest ? MPI_IN_PLACE : luminosity_values,
+	       luminosity_values, parameters::lightcurves_radii.size(),
+	       MPI_DOUBLE, MPI_SUM, CPU_Highest, CPU_Comm);
+    MPI_Reduce(CPU_Rank == CPU_Highest ? MPI_IN_PLACE : dissipation_values,
+	       dissipation_values, parameters::lightcurves_radii.size(),
+	       MPI_DOUBLE, MPI_SUM, CPU_Highest, CPU_Comm);
 
     // the last process can write the data
     if (CPU_Rank == CPU_Highest) {
@@ -1277,8 +1359,39 @@ void write_ecc_peri_changes(const unsigned int snapshot_number, const unsigned m
 	FILE *fd = 0;
 	char *fd_filename;
 	static bool fd_created = false;
+	static monitor_series::t_series *series = nullptr;
+	const bool write_text =
+	    parameters::monitor_format != parameters::monitor_format_binary;
+
+	if (CPU_Master &&
+	    parameters::monitor_format != parameters::monitor_format_text) {
+	if (series == nullptr) {
+		const std::string time_unit = units::time.get_cgs_factor_symbol();
+		series = monitor_series::open(
+		    outdir + "monitor/eccentricity_change.bin",
+		    {{"coarse output step", "1"},
+		     {"fine output step", "1"},
+		     {"time", time_unit},
+		     {"ecc change from source terms", "1"},
+		     {"ecc change from artificial viscosity", "1"},
+		     {"ecc change from viscosity", "1"},
+		     {"ecc change from transport", "1"},
+		     {"ecc change from damping", "1"},
+		     {"Periastron change from source terms", "1"},
+		     {"Periastron change from artificial viscosity", "1"},
+		     {"Periastron change from viscosity", "1"},
+		     {"Periastron change from transport", "1"},
+		     {"Periastron change from damping", "1"}},
+		    start_mode::mode == start_mode::mode_restart);
+	}
+	series->append({(double)snapshot_number, (double)monitor_number,
+			sim::time, delta_ecc_source, delta_ecc_art_visc,
+			delta_ecc_visc, delta_ecc_transport, delta_ecc_damp,
+			delta_peri_source, delta_peri_art_visc, delta_peri_visc,
+			delta_peri_transport, delta_peri_damp});
+	}
 
-	if (CPU_Master) {
+	if (CPU_Master && write_text) {
 
 	if (asprintf(&fd_filename, "%s%s", output::outdir.c_str(), "monitor/eccentricity_change.dat") == -1) {
 		logging::print_master(LOG_ERROR
@@ -1338,7 +1451,7 @@ void write_ecc_peri_changes(const unsigned int snapshot_number, const unsigned m
 	}
 	}
 
-	if (CPU_Master) {
+	if (CPU_Master && write_text) {
 	fprintf(fd, "%u\t%u\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\t%#.16e\n",
 		snapshot_number,
 		monitor_number,
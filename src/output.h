@@ -1,6 +1,7 @@
 #pragma once
 
 #include "data.h"
+#include "monitor_series.h"
 #include <map>
 #include <string>
 #include <vector>
@@ -34,6 +35,8 @@ void write_output_version();
 void write_grids(t_data &data, int index, int iter, double phystime);
 void write_quantities(t_data &data, bool force_update);
 void write_misc();
+misc_entry get_misc();
+void set_misc(const misc_entry &misc);
 void write_torques(t_data &data, bool force_update);
 void write_massflow_info(t_data &data);
 void write_1D_info(t_data &data);
@@ -46,6 +49,9 @@ void write_monitor_time();
 
 int load_misc();
 std::string get_version(std::string filename);
+std::vector<monitor_series::t_column> variable_columns(
+    const std::map<const std::string, const int> &variables,
+    const std::map<const std::string, const std::string> &units);
 std::string text_file_variable_description(
     const std::map<const std::string, const int> &variables,
     const std::map<const std::string, const std::string> &units);
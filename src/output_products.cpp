@@ -0,0 +1,451 @@
+/**
+	\file output_products.cpp
+
+	Configurable reduced outputs of polargrids. Each product is an entry of
+	the OutputProducts list in the config file, e.g.
+
+	OutputProducts:
+	  - name: planet_window
+	    type: window
+	    fields: Sigma, Temperature
+	    planet: 1
+	    hill radii: 3
+	    every: 1
+	  - name: coarse
+	    type: downsample
+	    factor: 4
+	    every: 10
+
+	Supported types are
+	  window:       cells within 'hill radii' Hill radii of nbody object
+	                'planet', co-moving with it
+	  downsample:   global field block-averaged over factor x factor cells
+	  radialcut:    all rings at the cell containing 'azimuth'
+	  azimuthalcut: all cells of the ring containing 'radius'
+
+	A product is written every 'every' monitor steps into
+	products/<name>/<field>_<monitor number>.dat as raw doubles, ring by
+	ring. The extent of every output is logged in products/<name>/info.dat.
+	Each process writes the rings it owns with collective MPI-IO.
+
+	Fields are written as they are stored in memory, derived quantities
+	which are only computed for snapshots may be outdated.
+*/
+
+#include "output_products.h"
+#include "LowTasks.h"
+#include "config.h"
+#include "global.h"
+#include "logging.h"
+#include "mpi_utils.h"
+#include "output.h"
+#include "simulation.h"
+#include "snapshot_writer.h"
+#include "start_mode.h"
+#include "units.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mpi.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace output_products
+{
+
+enum t_product_type { window, downsample, radial_cut, azimuthal_cut };
+
+struct t_product {
+    std::string name;
+    t_product_type type;
+    std::vector<t_polargrid *> fields;
+    unsigned int every;
+
+    // window
+    unsigned int planet;
+    double hill_radii;
+
+    // downsample
+    unsigned int factor;
+
+    // cuts
+    unsigned int azimuthal_cell;
+    unsigned int ring;
+
+    bool info_created;
+};
+
+/**
+	Extent of one output in global cell indices. The azimuthal range may
+	wrap around 2 pi.
+*/
+struct t_extent {
+    unsigned int first_ring;
+    unsigned int n_rings;
+    unsigned int first_cell;
+    unsigned int n_cells;
+};
+
+static std::vector<t_product> products;
+
+// rings [owned_first, owned_end) are written by this process
+static unsigned int owned_first;
+static unsigned int owned_end;
+
+static std::string product_dir(const t_product &product)
+{
+    return output::outdir + "products/" + product.name + "/";
+}
+
+/**
+	Global index of the ring containing radius r, clamped to the grid.
+*/
+static unsigned int find_ring(const double r)
+{
+    const double *radii = Radii;
+    const double *upper =
+	std::upper_bound(radii, radii + GlobalNRadial + 1, r);
+    if (upper == radii) {
+	return 0;
+    }
+    return std::min((unsigned int)(upper - radii) - 1, GlobalNRadial - 1);
+}
+
+static unsigned int find_azimuthal_cell(const double phi)
+{
+    double angle = std::fmod(phi, 2.0 * M_PI);
+    if (angle < 0.0) {
+	angle += 2.0 * M_PI;
+    }
+    return std::min((unsigned int)(angle * invdphi), NAzimuthal - 1);
+}
+
+/**
+	Take over the rings of this process after the domain decomposition was
+	changed.
+*/
+void update_domain()
+{
+    owned_first = IMIN + Zero_or_active;
+    owned_end = IMIN + Max_or_active;
+
+    for (const t_product &product : products) {
+	// every block must start on the process holding its other rings or
+	// on the direct neighbour
+	if (product.type == downsample &&
+	    owned_end - owned_first < product.factor) {
+	    die("Output product '%s': factor %u is larger than the %u rings of process %d\n",
+		product.name.c_str(), product.factor, owned_end - owned_first,
+		CPU_Rank);
+	}
+    }
+}
+
+void init(t_data &data)
+{
+    std::vector<config::Config> product_configs =
+	config::cfg.get_subconfig_list("OutputProducts");
+
+    for (auto &cfg : product_configs) {
+	t_product product;
+	product.name = cfg.get<std::string>("name");
+	product.every = cfg.get<unsigned int>("every", 1);
+	product.info_created = false;
+	if (product.every == 0) {
+	    die("Output product '%s': every must be at least 1\n",
+		product.name.c_str());
+	}
+
+	for (const std::string &name :
+	     split_list(cfg.get<std::string>("fields", "Sigma"))) {
+	    t_polargrid *field = data.get_polargrid_by_name(name);
+	    if (field == nullptr) {
+		die("Output product '%s': unknown polargrid '%s'\n",
+		    product.name.c_str(), name.c_str());
+	    }
+	    product.fields.push_back(field);
+	}
+
+	const std::string type = cfg.get_lowercase("type", "window");
+	if (type == "window") {
+	    product.type = window;
+	    product.planet = cfg.get<unsigned int>("planet", 1);
+	    product.hill_radii = cfg.get<double>("hill radii", 2.0);
+	    if (product.planet >=
+		data.get_planetary_system().get_number_of_planets()) {
+		die("Output product '%s': there is no nbody object %u\n",
+		    product.name.c_str(), product.planet);
+	    }
+	} else if (type == "downsample") {
+	    product.type = downsample;
+	    product.factor = cfg.get<unsigned int>("factor", 2);
+	    if (product.factor == 0) {
+		die("Output product '%s': factor must be at least 1\n",
+		    product.name.c_str());
+	    }
+	} else if (type == "radialcut") {
+	    product.type = radial_cut;
+	    product.azimuthal_cell =
+		find_azimuthal_cell(cfg.get<double>("azimuth", 0.0));
+	} else if (type == "azimuthalcut") {
+	    product.type = azimuthal_cut;
+	    product.ring = find_ring(cfg.get<double>("radius", units::L0));
+	} else {
+	    die("Output product '%s': unknown type '%s'\n",
+		product.name.c_str(), type.c_str());
+	}
+
+	if (CPU_Master) {
+	    cfg.exit_on_unknown_key();
+	    ensure_directory_exists(product_dir(product));
+	}
+
+	products.push_back(product);
+    }
+
+    update_domain();
+
+    for (const t_product &product : products) {
+	logging::print_master(LOG_INFO
+			      "Output product '%s' is written every %u monitor steps.\n",
+			      product.name.c_str(), product.every);
+    }
+
+    MPI_Barrier(CPU_Comm);
+}
+
+static t_extent get_extent(t_data &data, const t_product &product)
+{
+    t_extent extent;
+
+    switch (product.type) {
+    case window: {
+	const t_planet &planet =
+	    data.get_planetary_system().get_planet(product.planet);
+	const double r = planet.get_r();
+	const double half_width = product.hill_radii * planet.get_rhill();
+
+	extent.first_ring = find_ring(r - half_width);
+	extent.n_rings = find_ring(r + half_width) - extent.first_ring + 1;
+
+	const double half_angle = r > 0.0 ? half_width / r : M_PI;
+	if (half_angle >= M_PI) {
+	    extent.first_cell = 0;
+	    extent.n_cells = NAzimuthal;
+	} else {
+	    extent.first_cell = find_azimuthal_cell(planet.get_phi() - half_angle);
+	    extent.n_cells = std::min(
+		(unsigned int)std::ceil(2.0 * half_angle * invdphi) + 1,
+		NAzimuthal);
+	}
+	break;
+    }
+    case downsample:
+	extent.first_ring = 0;
+	extent.n_rings = (GlobalNRadial + product.factor - 1) / product.factor;
+	extent.first_cell = 0;
+	extent.n_cells = (NAzimuthal + product.factor - 1) / product.factor;
+	break;
+    case radial_cut:
+	extent.first_ring = 0;
+	extent.n_rings = GlobalNRadial;
+	extent.first_cell = product.azimuthal_cell;
+	extent.n_cells = 1;
+	break;
+    case azimuthal_cut:
+	extent.first_ring = product.ring;
+	extent.n_rings = 1;
+	extent.first_cell = 0;
+	extent.n_cells = NAzimuthal;
+	break;
+    }
+
+    return extent;
+}
+
+/**
+	Copy the owned rings of a window into buffer and return the offset of
+	the first copied value in the file.
+*/
+static unsigned int collect_window(const t_polargrid &field,
+				   const t_extent &extent,
+				   std::vector<double> &buffer)
+{
+    const unsigned int first =
+	std::max(owned_first, extent.first_ring);
+    const unsigned int end =
+	std::min(owned_end, extent.first_ring + extent.n_rings);
+
+    buffer.clear();
+    for (unsigned int ring = first; ring < end; ++ring) {
+	const unsigned int nr = ring - IMIN;
+	for (unsigned int j = 0; j < extent.n_cells; ++j) {
+	    buffer.push_back(
+		field(nr, (extent.first_cell + j) % NAzimuthal));
+	}
+    }
+
+    return first > extent.first_ring
+	       ? (first - extent.first_ring) * extent.n_cells
+	       : 0;
+}
+
+/**
+	Area weighted block average over factor x factor cells. Blocks are
+	written by the process owning their first ring, partial sums of blocks
+	starting on the previous process are sent there.
+*/
+static unsigned int collect_downsampled(const t_polargrid &field,
+					const unsigned int factor,
+					const t_extent &extent,
+					std::vector<double> &buffer)
+{
+    const unsigned int n_cells = extent.n_cells;
+    const unsigned int first_block = owned_first / factor;
+    const unsigned int last_block = (owned_end - 1) / factor;
+    const unsigned int n_blocks = last_block - first_block + 1;
+
+    // weighted sum and weight of every coarse cell
+    std::vector<double> sums(2 * n_blocks * n_cells, 0.0);
+
+    for (unsigned int ring = owned_first; ring < owned_end; ++ring) {
+	const unsigned int nr = ring - IMIN;
+	double *block = &sums[2 * (ring / factor - first_block) * n_cells];
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    block[2 * (naz / factor)] += Surf[nr] * field(nr, naz);
+	    block[2 * (naz / factor) + 1] += Surf[nr];
+	}
+    }
+
+    const bool send_first = (CPU_Rank > 0) && (owned_first % factor != 0);
+    const bool receive_last =
+	(CPU_Rank != CPU_Highest) && (owned_end % factor != 0);
+
+    MPI_Request request;
+    std::vector<double> received(2 * n_cells);
+    if (receive_last) {
+	MPI_Irecv(received.data(), 2 * n_cells, MPI_DOUBLE, CPU_Next, 0,
+		  CPU_Comm, &request);
+    }
+    if (send_first) {
+	MPI_Send(sums.data(), 2 * n_cells, MPI_DOUBLE, CPU_Prev, 0, CPU_Comm);
+    }
+    if (receive_last) {
+	MPI_Wait(&request, MPI_STATUS_IGNORE);
+	double *block = &sums[2 * (n_blocks - 1) * n_cells];
+	for (unsigned int i = 0; i < 2 * n_cells; ++i) {
+	    block[i] += received[i];
+	}
+    }
+
+    const unsigned int first_owned_block = send_first ? first_block + 1 : first_block;
+
+    buffer.clear();
+    for (unsigned int k = first_owned_block; k <= last_block; ++k) {
+	const double *block = &sums[2 * (k - first_block) * n_cells];
+	for (unsigned int j = 0; j < n_cells; ++j) {
+	    buffer.push_back(block[2 * j] / block[2 * j + 1]);
+	}
+    }
+
+    return first_owned_block * n_cells;
+}
+
+static void write_buffer(const std::string &filename,
+			 const std::vector<double> &buffer,
+			 const unsigned int offset)
+{
+    MPI_File fh;
+    MPI_Status status;
+
+    mpi_error_check_file_write(MPI_File_open(CPU_Comm, filename.c_str(),
+					     MPI_MODE_WRONLY | MPI_MODE_CREATE,
+					     snapshot_writer::get_info(), &fh),
+			       filename);
+    MPI_File_set_size(fh, 0);
+    MPI_File_set_view(fh, 0, MPI_DOUBLE, MPI_DOUBLE,
+		      const_cast<char *>("native"), MPI_INFO_NULL);
+    MPI_File_write_at_all(fh, offset, buffer.data(), buffer.size(),
+			  MPI_DOUBLE, &status);
+    MPI_File_close(&fh);
+}
+
+static void write_info(t_product &product, const t_extent &extent)
+{
+    const std::string filename = product_dir(product) + "info.dat";
+
+    // check if file exists and we restarted
+    if ((start_mode::mode == start_mode::mode_restart) &&
+	!product.info_created) {
+	if (access(filename.c_str(), W_OK) != -1) {
+	    product.info_created = true;
+	}
+    }
+
+    FILE *fd = fopen(filename.c_str(), product.info_created ? "a" : "w");
+    if (fd == NULL) {
+	logging::print_master(LOG_ERROR "Can't write '%s' file. Aborting.\n",
+			      filename.c_str());
+	PersonalExit(1);
+    }
+
+    if (!product.info_created) {
+	const std::map<const std::string, const int> columns = {
+	    {"snapshot number", 0}, {"monitor number", 1}, {"time", 2},
+	    {"first ring", 3},	    {"rings", 4},	   {"first azimuthal cell", 5},
+	    {"azimuthal cells", 6}};
+	const std::map<const std::string, const std::string> units = {
+	    {"snapshot number", "1"}, {"monitor number", "1"}, {"time", "time"},
+	    {"first ring", "1"},      {"rings", "1"},	   {"first azimuthal cell", "1"},
+	    {"azimuthal cells", "1"}};
+
+	fprintf(fd, "#FargoCPT output product file\n");
+	fprintf(fd, "#version: 1.0\n");
+	fprintf(fd, "#product: %s\n", product.name.c_str());
+	fprintf(fd, "%s",
+		output::text_file_variable_description(columns, units).c_str());
+	product.info_created = true;
+    }
+
+    fprintf(fd, "%u\t%u\t%#.18g\t%u\t%u\t%u\t%u\n", sim::N_snapshot,
+	    sim::N_monitor, sim::time, extent.first_ring, extent.n_rings,
+	    extent.first_cell, extent.n_cells);
+    fclose(fd);
+}
+
+void write(t_data &data)
+{
+    std::vector<double> buffer;
+
+    for (t_product &product : products) {
+	if (sim::N_monitor % product.every != 0) {
+	    continue;
+	}
+
+	const t_extent extent = get_extent(data, product);
+
+	for (const t_polargrid *field : product.fields) {
+	    unsigned int offset;
+	    if (product.type == downsample) {
+		offset = collect_downsampled(*field, product.factor, extent,
+					     buffer);
+	    } else {
+		offset = collect_window(*field, extent, buffer);
+	    }
+
+	    const std::string filename = product_dir(product) +
+					 field->get_name() + "_" +
+					 std::to_string(sim::N_monitor) + ".dat";
+	    write_buffer(filename, buffer, offset);
+	}
+
+	if (CPU_Master) {
+	    write_info(product, extent);
+	}
+    }
+}
+
+} // namespace output_products
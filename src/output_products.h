@@ -0,0 +1,15 @@
+#pragma once
+
+#include "data.h"
+
+// Reduced output products (planet windows, downsampled fields and cuts)
+// written alongside the monitor files.
+
+namespace output_products
+{
+
+void init(t_data &data);
+void update_domain();
+void write(t_data &data);
+
+} // namespace output_products
@@ -9,7 +9,14 @@
 #include "logging.h"
 #include "fld.h"
 #include "options.h"
+#include "output.h"
+#include "snapshot_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // copy paste from https://github.com/jeffhammond/HPCInfo/blob/master/mpi/with-threads/mpi-openmp.c
 #define MPI_THREAD_STRING(level)  \
@@ -22,6 +29,82 @@
 // copy operator for t_polargrid
 // write all polargrids on error
 
+/**
+	Split MPI_COMM_WORLD into one communicator per ensemble member. Each
+	member runs the simulation described by one line of the ensemble file.
+*/
+static void init_ensemble()
+{
+	int world_rank, world_size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+	std::ifstream list(options::ensemble_file);
+	if (!list.is_open()) {
+		die("Could not open ensemble file '%s'\n", options::ensemble_file.c_str());
+	}
+
+	std::vector<std::string> parameter_files;
+	std::string line;
+	while (std::getline(list, line)) {
+		const size_t begin = line.find_first_not_of(" \t\r");
+		if (begin == std::string::npos || line[begin] == '#') {
+			continue;
+		}
+		const size_t end = line.find_last_not_of(" \t\r");
+		parameter_files.push_back(line.substr(begin, end - begin + 1));
+	}
+
+	Ensemble_Number = parameter_files.size();
+	if (Ensemble_Number == 0) {
+		die("Ensemble file '%s' does not list any parameter files\n", options::ensemble_file.c_str());
+	}
+	if (world_size % Ensemble_Number != 0) {
+		die("%d processes can not be split evenly among %d ensemble members\n", world_size, Ensemble_Number);
+	}
+
+	const int member_size = world_size / Ensemble_Number;
+	Ensemble_Member = world_rank / member_size;
+	MPI_Comm_split(MPI_COMM_WORLD, Ensemble_Member, world_rank, &CPU_Comm);
+
+	options::parameter_file = parameter_files[Ensemble_Member];
+}
+
+/**
+	Make sure no two ensemble members write into the same output directory.
+*/
+void check_ensemble_output_directories()
+{
+	if (Ensemble_Number < 2) {
+		return;
+	}
+
+	int world_size;
+	MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+	const int member_size = world_size / Ensemble_Number;
+
+	// compare the canonical paths, so that e.g. out/a, out/a/ and ./out/a
+	// are recognized as the same directory. The directory may not exist yet,
+	// then a trailing separator is kept and has to be removed.
+	std::filesystem::path outdir =
+		std::filesystem::weakly_canonical(output::outdir);
+	if (!outdir.has_filename()) {
+		outdir = outdir.parent_path();
+	}
+	unsigned long long outdir_hash = std::hash<std::string>{}(outdir.string());
+	std::vector<unsigned long long> hashes(world_size);
+	MPI_Allgather(&outdir_hash, 1, MPI_UNSIGNED_LONG_LONG, hashes.data(), 1,
+		      MPI_UNSIGNED_LONG_LONG, MPI_COMM_WORLD);
+
+	for (int i = 0; i < Ensemble_Number; ++i) {
+		for (int j = i + 1; j < Ensemble_Number; ++j) {
+			if (hashes[i * member_size] == hashes[j * member_size]) {
+				die("Ensemble members %d and %d use the same output directory\n", i, j);
+			}
+		}
+	}
+}
+
 void init_parallel(int argc, char *argv[]) {
 	int CPU_NameLength;
     char CPU_Name[MPI_MAX_PROCESSOR_NAME + 1];
@@ -34,16 +117,20 @@ void init_parallel(int argc, char *argv[]) {
 					   MPI_THREAD_STRING(provided), MPI_THREAD_STRING(requested));
 	}
 
+    if (options::ensemble) {
+		init_ensemble();
+    }
+
     // initialize MPI
-    MPI_Comm_rank(MPI_COMM_WORLD, &CPU_Rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &CPU_Number);
+    MPI_Comm_rank(CPU_Comm, &CPU_Rank);
+    MPI_Comm_size(CPU_Comm, &CPU_Number);
     selfgravity::mpi_init();
 
     // are we master CPU?
     CPU_Master = (CPU_Rank == 0 ? 1 : 0);
 
 	pid_t pid = getpid();
-    if (CPU_Master) {
+    if (CPU_Master && Ensemble_Member == 0) {
 		if (options::pidfile != "") {
 			std::ofstream pidfile;
 			pidfile.open(options::pidfile);
@@ -55,7 +142,7 @@ void init_parallel(int argc, char *argv[]) {
 	logging::print(LOG_INFO "MPI rank # %2d runs as process %d\n", CPU_Rank, pid);
 
 	// make sure the pid of the master is printed before additional info
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 
 #ifdef _OPENMP
 	#pragma omp parallel
@@ -71,6 +158,12 @@ void init_parallel(int argc, char *argv[]) {
 			Thread_Number = omp_num;
 		}
 	}
+
+	// grids are placed on NUMA nodes by first touch, which only works if
+	// threads stay on their cores
+	if (Thread_Number > 1 && omp_get_proc_bind() == omp_proc_bind_false) {
+		logging::print_master(LOG_INFO "OpenMP threads are not bound to cores (OMP_PROC_BIND), memory of the grids may not be local to the threads using it.\n");
+	}
 #else
 	Thread_Number = 1;
 	printf("MPI rank # %2d \n", CPU_Rank);
@@ -85,7 +178,7 @@ void init_parallel(int argc, char *argv[]) {
     logging::print(LOG_INFO "fargo: running on %s\n", CPU_Name);
 #endif
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 
 }
 
@@ -94,6 +187,10 @@ void finalize_parallel() {
 	DeallocateBoundaryCommunicationBuffers();
     selfgravity::mpi_finalize();
     FreeSplitDomain();
+    snapshot_writer::free_info();
+	if (CPU_Comm != MPI_COMM_WORLD) {
+		MPI_Comm_free(&CPU_Comm);
+	}
 	MPI_Finalize();
 	fld::finalize();
 }
\ No newline at end of file
@@ -9,4 +9,5 @@
 #include <mpi.h>
 
 void init_parallel(int argc, char *argv[]);
+void check_ensemble_output_directories();
 void finalize_parallel();
\ No newline at end of file
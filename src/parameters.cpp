@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "LowTasks.h"
+#include "allocation.h"
 #include "boundary_conditions/boundary_conditions.h"
 #include "config.h"
 #include "constants.h"
@@ -17,6 +18,7 @@
 #include "parameters.h"
 #include "config.h"
 #include "units.h"
+#include "util.h"
 #include "config.h"
 #include "fld.h"
 
@@ -106,6 +108,8 @@ double artificial_viscosity_factor;
 bool artificial_viscosity_dissipation;
 
 bool calculate_disk;
+bool integrate_nbody_concurrently;
+bool load_balancing;
 
 // control centering of frame
 unsigned int n_bodies_for_hydroframe_center;
@@ -136,6 +140,7 @@ double profile_cutoff_width_inner;
 bool disk_feedback;
 bool accrete_without_disk_feedback;
 bool fast_transport;
+bool axisymmetric;
 int hydro_integrator;
 int indirect_term_mode;
 
@@ -152,6 +157,7 @@ bool v_azimuthal_with_quadropole_support;
 
 bool self_gravity;
 t_sg self_gravity_mode;
+t_sg_solver self_gravity_solver;
 unsigned int self_gravity_steps_between_kernel_update;
 double self_gravity_aspectratio_change_threshold;
 
@@ -165,6 +171,13 @@ bool write_lightcurves;
 bool write_at_every_timestep;
 std::vector<double> lightcurves_radii;
 bool write_massflow;
+bool write_mode_analysis;
+unsigned int mode_analysis_max_mode;
+std::vector<std::string> mode_analysis_fields;
+t_checkpoint_container checkpoint_container;
+std::vector<std::string> mpi_io_hints;
+t_monitor_format monitor_format;
+unsigned int monitor_flush_rows;
 
 unsigned int log_after_steps;
 double log_after_real_seconds;
@@ -211,6 +224,9 @@ bool particle_gas_drag_enabled;
 bool particle_disk_gravity_enabled;
 bool particle_dust_diffusion;
 t_particle_integrator particle_integrator;
+t_dust_deposition_scheme dust_deposition_scheme;
+double dust_deposition_mass;
+bool dust_deposition_per_species;
 
 // for constant opacity
 double kappa_const = 1.0;
@@ -319,6 +335,12 @@ static void read_output_config(t_data &data) {
 	config::cfg.get_flag("WriteSGAccelRad", false),do_write_1D);
 	data[t_data::SG_ACCEL_AZI].set_write(
 	config::cfg.get_flag("WriteSGAccelAzi", false),do_write_1D);
+    data[t_data::DUST_SIGMA].set_write(
+	config::cfg.get_flag("WriteDustDensity", false), do_write_1D);
+    data[t_data::DUST_V_RADIAL].set_write(
+	config::cfg.get_flag("WriteDustDensity", false), do_write_1D);
+    data[t_data::DUST_V_AZIMUTHAL].set_write(
+	config::cfg.get_flag("WriteDustDensity", false), do_write_1D);
 
     write_torques = config::cfg.get_flag("WriteTorques", false);
 
@@ -369,6 +391,50 @@ static void read_output_config(t_data &data) {
 	sort(lightcurves_radii.begin(), lightcurves_radii.end());
     }
 
+    write_mode_analysis = config::cfg.get_flag("WriteModeAnalysis", false);
+    mode_analysis_max_mode =
+	config::cfg.get<unsigned int>("ModeAnalysisMaxMode", 8);
+
+    mode_analysis_fields = split_list(
+	config::cfg.get<std::string>("ModeAnalysisFields", "Sigma"));
+
+    switch (config::cfg.get_first_letter_lowercase("CheckpointContainer", "no")) {
+    case 'n':
+	checkpoint_container = checkpoint_container_no;
+	break;
+    case 'y':
+	checkpoint_container = checkpoint_container_yes;
+	break;
+    case 'o':
+	checkpoint_container = checkpoint_container_only;
+	break;
+    default:
+	die("Invalid setting for CheckpointContainer: %s\n",
+	    config::cfg.get<std::string>("CheckpointContainer").c_str());
+    }
+
+    mpi_io_hints = split_list(config::cfg.get<std::string>("MPIIOHints", ""));
+
+    switch (config::cfg.get_first_letter_lowercase("MonitorFormat", "text")) {
+    case 't':
+	monitor_format = monitor_format_text;
+	break;
+    case 'b':
+	if (config::cfg.get_lowercase("MonitorFormat", "text") == "both") {
+	    monitor_format = monitor_format_both;
+	} else {
+	    monitor_format = monitor_format_binary;
+	}
+	break;
+    default:
+	die("Invalid setting for MonitorFormat: %s\n",
+	    config::cfg.get<std::string>("MonitorFormat").c_str());
+    }
+
+    monitor_flush_rows = config::cfg.get<unsigned int>("MonitorFlushRows", 64);
+    if (monitor_flush_rows < 1) {
+	die("MonitorFlushRows must be at least 1!\n");
+    }
 }
 
 
@@ -506,6 +572,10 @@ void read(const std::string &filename, t_data &data)
     NRadial = config::cfg.get<unsigned int>("Nrad", 64);
     NAzimuthal = config::cfg.get<unsigned int>("Naz", 64);
 
+    // use transparent huge pages for the polargrids
+    allocation::set_huge_pages(
+	config::cfg.get_flag("TransparentHugePages", "no"));
+
 
     // Disk radius = radius at which disk_radius_mass_fraction percent
     // of the total mass inside the domain is contained
@@ -544,6 +614,9 @@ void read(const std::string &filename, t_data &data)
 	boundary_conditions::parse_config();
 
     calculate_disk = config::cfg.get_flag("Disk", "yes");
+    integrate_nbody_concurrently =
+	config::cfg.get_flag("IntegrateNbodyConcurrently", "no");
+    load_balancing = config::cfg.get_flag("LoadBalancing", "no");
 	
     corotation_reference_body =
 	config::cfg.get<unsigned int>("CorotationReferenceBody", 1);
@@ -679,11 +752,25 @@ void read(const std::string &filename, t_data &data)
 		die("Configuration error.");
 	}
 
+	switch (config::cfg.get_first_letter_lowercase("SelfGravitySolver", "auto")) {
+	case 'a': // auto
+		self_gravity_solver = radial_grid_type == logarithmic_spacing ? sg_solver_polar : sg_solver_modal;
+		break;
+	case 'p': // polar
+		self_gravity_solver = sg_solver_polar;
+		break;
+	case 'm': // modal
+		self_gravity_solver = sg_solver_modal;
+		break;
+	default:
+		die("Invalid setting for SelfGravitySolver");
+	}
+
 	self_gravity_steps_between_kernel_update = config::cfg.get<unsigned int>("SelfGravityStepsBetweenKernelUpdate", 20);
 	self_gravity_aspectratio_change_threshold = config::cfg.get<double>("SelfGravityAspectRatioChangeThreshold", 0.001);
 
     if (self_gravity) {
-		logging::print_master(LOG_INFO "Self gravity enabled. It uses the '%s' mode. The kernel is updated every %u steps and after aspect ratio changed by %f.\n", sgmode.c_str(), self_gravity_steps_between_kernel_update, self_gravity_aspectratio_change_threshold);
+		logging::print_master(LOG_INFO "Self gravity enabled. It uses the '%s' mode with the %s solver. The kernel is updated every %u steps and after aspect ratio changed by %f.\n", sgmode.c_str(), self_gravity_solver == sg_solver_polar ? "polar" : "modal", self_gravity_steps_between_kernel_update, self_gravity_aspectratio_change_threshold);
     }
 
 
@@ -848,6 +935,26 @@ void read(const std::string &filename, t_data &data)
 	particle_dust_diffusion =
 	config::cfg.get_flag("ParticleDustDiffusion", false);
 
+    switch (config::cfg.get_first_letter_lowercase("DustDepositionScheme",
+						   "cic")) {
+    case 'n':
+	dust_deposition_scheme = deposition_ngp;
+	break;
+    case 'c':
+	dust_deposition_scheme = deposition_cic;
+	break;
+    case 't':
+	dust_deposition_scheme = deposition_tsc;
+	break;
+    default:
+	die("Invalid setting for DustDepositionScheme: %s\n",
+	    config::cfg.get<std::string>("DustDepositionScheme", "cic").c_str());
+    }
+    dust_deposition_mass =
+	config::cfg.get<double>("DustDepositionMass", 0.0, M0);
+    dust_deposition_per_species =
+	config::cfg.get_flag("DustDepositionPerSpecies", false);
+
 
 
     // particle integrator
@@ -1025,6 +1132,42 @@ void summarize_parameters()
 	logging::print_master(LOG_INFO "Lightcurves radii are: %s\n", lightcurves_radii_string.c_str());
     }
 
+    if (write_mode_analysis) {
+	std::string fields_string = "";
+	for (unsigned int i = 0; i < mode_analysis_fields.size(); ++i) {
+		fields_string += mode_analysis_fields[i];
+		if (i != mode_analysis_fields.size()-1) {
+			fields_string += ", ";
+		}
+	}
+	logging::print_master(LOG_INFO "Azimuthal modes m = 1..%u of %s are written at every monitor step.\n", mode_analysis_max_mode, fields_string.c_str());
+    }
+
+    if (integrate_nbody_concurrently) {
+	logging::print_master(LOG_INFO "The nbody system is integrated concurrently to the gas transport.\n");
+    }
+
+    if (checkpoint_container != checkpoint_container_no) {
+	logging::print_master(LOG_INFO "Snapshot polargrids are written to a single checkpoint file%s.\n",
+			      checkpoint_container == checkpoint_container_only ? " only" : " and to separate files");
+    }
+
+    if (!mpi_io_hints.empty()) {
+	std::string hints_string = "";
+	for (unsigned int i = 0; i < mpi_io_hints.size(); ++i) {
+		hints_string += mpi_io_hints[i];
+		if (i != mpi_io_hints.size()-1) {
+			hints_string += ", ";
+		}
+	}
+	logging::print_master(LOG_INFO "Snapshot files are written with the MPI-IO hints %s.\n", hints_string.c_str());
+    }
+
+    if (monitor_format != monitor_format_text) {
+	logging::print_master(LOG_INFO "Monitor files are written %s binary files, appended in blocks of %u rows.\n",
+			      monitor_format == monitor_format_both ? "as text and" : "as", monitor_flush_rows);
+    }
+
     // particles
     logging::print_master(LOG_INFO "Particles are %s.\n",
 			  integrate_particles ? "enabled" : "disabled");
@@ -1069,6 +1212,11 @@ void summarize_parameters()
 	    die("Invalid setting for Particle Integrator: %s",
 		(config::cfg.get<std::string>("ParticleIntegrator", "s")).c_str());
 	}
+	const char *deposition_names[] = {"NGP", "CIC", "TSC"};
+	logging::print_master(
+	    LOG_INFO "Dust grids are deposited with %s weights%s.\n",
+	    deposition_names[dust_deposition_scheme],
+	    dust_deposition_per_species ? " for every particle species" : "");
     }
 }
 
@@ -1121,7 +1269,7 @@ void write_grid_data_to_file()
 		radial_spacing_str);
 	fclose(fd);
     }
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 }
 
 } // namespace parameters
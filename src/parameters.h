@@ -180,6 +180,10 @@ extern bool correct_disk_selfgravity;
 
 /// calculate disk (hydro)
 extern bool calculate_disk;
+/// integrate the nbody system on a separate thread during gas transport
+extern bool integrate_nbody_concurrently;
+/// cost weighted domain decomposition on restart
+extern bool load_balancing;
 
 // control centering of frame
 extern unsigned int n_bodies_for_hydroframe_center;
@@ -198,6 +202,8 @@ extern bool accrete_without_disk_feedback;
 extern bool planet_orbit_disk_test;
 
 extern bool fast_transport;
+/// single azimuthal cell, transport, TW viscosity, CFL and FLD skip azimuthal terms
+extern bool axisymmetric;
 extern int hydro_integrator;
 
 extern int indirect_term_mode;
@@ -225,6 +231,11 @@ enum t_sg {
     sg_BK       // exact solution for the kernel using bessel functions by Steven Rendon Restrepo
 };
 extern t_sg self_gravity_mode;
+enum t_sg_solver {
+    sg_solver_polar, // 2D FFT convolution, logarithmic radial grid only
+    sg_solver_modal  // FFT in azimuth and radial direct sum per mode, any radial grid
+};
+extern t_sg_solver self_gravity_solver;
 extern unsigned int self_gravity_steps_between_kernel_update;
 extern double self_gravity_aspectratio_change_threshold;
 
@@ -240,6 +251,27 @@ extern bool write_at_every_timestep;
 extern bool write_lightcurves;
 extern std::vector<double> lightcurves_radii;
 extern bool write_massflow;
+extern bool write_mode_analysis;
+extern unsigned int mode_analysis_max_mode;
+extern std::vector<std::string> mode_analysis_fields;
+/// single file container for the 2D snapshot data
+enum t_checkpoint_container {
+    checkpoint_container_no,  // separate file per polargrid
+    checkpoint_container_yes, // container and separate files
+    checkpoint_container_only // container only
+};
+extern t_checkpoint_container checkpoint_container;
+/// MPI_Info hints (key=value) for the snapshot files
+extern std::vector<std::string> mpi_io_hints;
+/// format of the monitor time series
+enum t_monitor_format {
+    monitor_format_text,   // text files only
+    monitor_format_binary, // binary files only
+    monitor_format_both    // text and binary files
+};
+extern t_monitor_format monitor_format;
+/// rows buffered before a block is appended to a binary monitor file
+extern unsigned int monitor_flush_rows;
 
 // runtime output
 extern unsigned int log_after_steps;
@@ -315,6 +347,17 @@ enum t_particle_integrator {
 				     // - DUST
 };
 extern t_particle_integrator particle_integrator;
+/// particle to grid deposition for the dust output grids
+enum t_dust_deposition_scheme {
+    deposition_ngp, // nearest grid point
+    deposition_cic, // cloud in cell
+    deposition_tsc  // triangular shaped cloud
+};
+extern t_dust_deposition_scheme dust_deposition_scheme;
+/// total dust mass represented by the particles, 0 to use the particle masses
+extern double dust_deposition_mass;
+/// write dust grids for every particle species
+extern bool dust_deposition_per_species;
 
 void read(const std::string &filename, t_data &data);
 void summarize_parameters();
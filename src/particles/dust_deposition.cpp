@@ -0,0 +1,333 @@
+/**
+	\file dust_deposition.cpp
+
+	Particle to grid deposition of the dust particles.
+
+	Every particle deposits its mass and its mass weighted velocities onto
+	the cell centers around it with nearest grid point (NGP), cloud in cell
+	(CIC) or triangular shaped cloud (TSC) weights. The weights are computed
+	in index space, i.e. linear in r between neighbouring Rmed and linear in
+	phi between cell centers.
+
+	The particles are bucketed by the first ring of their stencil. A stencil
+	covers at most three rings, so all buckets whose ring index has the same
+	value modulo three can be deposited in parallel without write conflicts.
+	Contributions to the overlap rings are summed onto the neighbouring
+	process afterwards.
+*/
+
+#include "dust_deposition.h"
+#include "../LowTasks.h"
+#include "../constants.h"
+#include "../find_cell_id.h"
+#include "../frame_of_reference.h"
+#include "../global.h"
+#include "../logging.h"
+#include "../parameters.h"
+#include "../simulation.h"
+#include "particles.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace dust_deposition
+{
+
+// time of the last deposition, all dust grids are filled at once
+static double deposition_time = -1.0;
+
+// surface density, radial and azimuthal velocity of every particle species
+static std::vector<std::unique_ptr<t_polargrid>> species_grids;
+
+/**
+	1D weights for the fractional cell index x. Returns the number of
+	weights, first is the index of the first one.
+*/
+static unsigned int weights_1D(const double x, int &first, double w[3])
+{
+    switch (parameters::dust_deposition_scheme) {
+    case parameters::deposition_ngp: {
+	first = (int)std::floor(x + 0.5);
+	w[0] = 1.0;
+	return 1;
+    }
+    case parameters::deposition_cic: {
+	first = (int)std::floor(x);
+	const double f = x - first;
+	w[0] = 1.0 - f;
+	w[1] = f;
+	return 2;
+    }
+    case parameters::deposition_tsc: {
+	const int center = (int)std::floor(x + 0.5);
+	const double d = x - center;
+	first = center - 1;
+	w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+	w[1] = 0.75 - d * d;
+	w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+	return 3;
+    }
+    }
+    return 0;
+}
+
+/**
+	Fractional radial cell index of r with respect to the local Rmed.
+*/
+static double radial_index(const double r)
+{
+    int id = get_rmed_id(r);
+    id = std::max(0, std::min((int)NRadial - 2, id));
+    const double x = id + (r - Rmed[id]) / (Rmed[id + 1] - Rmed[id]);
+    return std::max(0.0, std::min((double)NRadial - 1.0, x));
+}
+
+static unsigned int get_species(const t_particle &particle)
+{
+    if (parameters::particle_species_number <= 1 ||
+	parameters::particle_radius_increase_factor == 1.0) {
+	return 0;
+    }
+    const int species = (int)std::lround(
+	std::log(particle.radius / parameters::particle_radius) /
+	std::log(parameters::particle_radius_increase_factor));
+    return std::max(
+	0, std::min((int)parameters::particle_species_number - 1, species));
+}
+
+static void init_species_grids()
+{
+    const char *names[3] = {"dust_Sigma", "dust_vrad", "dust_vazi"};
+    units::t_unit *grid_units[3] = {&units::surface_density, &units::velocity,
+				    &units::velocity};
+
+    for (unsigned int s = 0; s < parameters::particle_species_number; ++s) {
+	for (unsigned int q = 0; q < 3; ++q) {
+	    const std::string name = std::string(names[q]) + "_" + std::to_string(s);
+	    auto grid = std::make_unique<t_polargrid>();
+	    grid->set_scalar(true);
+	    grid->set_name(name.c_str());
+	    grid->set_unit(*grid_units[q]);
+	    grid->set_size(NRadial, NAzimuthal);
+	    species_grids.push_back(std::move(grid));
+	}
+    }
+}
+
+/**
+	Add the overlap rings of all grids to the rings of the neighbouring
+	processes they belong to.
+*/
+static void sum_overlap(const std::vector<t_polargrid *> &grids)
+{
+    const unsigned int l = CPUOVERLAP * NAzimuthal;
+    const unsigned int n = grids.size() * l;
+
+    std::vector<double> send_inner(n), send_outer(n);
+    std::vector<double> recv_inner(n, 0.0), recv_outer(n, 0.0);
+
+    for (unsigned int g = 0; g < grids.size(); ++g) {
+	const double *field = grids[g]->Field;
+	std::copy(field, field + l, &send_inner[g * l]);
+	std::copy(field + (NRadial - CPUOVERLAP) * NAzimuthal,
+		  field + NRadial * NAzimuthal, &send_outer[g * l]);
+    }
+
+    const int prev = CPU_Rank == 0 ? MPI_PROC_NULL : CPU_Prev;
+    const int next = CPU_Rank == CPU_Highest ? MPI_PROC_NULL : CPU_Next;
+
+    MPI_Sendrecv(send_inner.data(), n, MPI_DOUBLE, prev, 0, recv_outer.data(),
+		 n, MPI_DOUBLE, next, 0, CPU_Comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(send_outer.data(), n, MPI_DOUBLE, next, 1, recv_inner.data(),
+		 n, MPI_DOUBLE, prev, 1, CPU_Comm, MPI_STATUS_IGNORE);
+
+    for (unsigned int g = 0; g < grids.size(); ++g) {
+	double *field = grids[g]->Field;
+	if (prev != MPI_PROC_NULL) {
+	    double *target = field + CPUOVERLAP * NAzimuthal;
+	    for (unsigned int i = 0; i < l; ++i) {
+		target[i] += recv_inner[g * l + i];
+	    }
+	}
+	if (next != MPI_PROC_NULL) {
+	    double *target = field + (NRadial - 2 * CPUOVERLAP) * NAzimuthal;
+	    for (unsigned int i = 0; i < l; ++i) {
+		target[i] += recv_outer[g * l + i];
+	    }
+	}
+    }
+}
+
+/**
+	Fill the dust grids. Called before any of them is written.
+*/
+void deposit(t_data &data, unsigned int timestep, bool force_update)
+{
+    (void)timestep;
+
+    if (!force_update && deposition_time == sim::time) {
+	return;
+    }
+    deposition_time = sim::time;
+
+    const bool per_species = parameters::dust_deposition_per_species;
+    if (per_species && species_grids.empty()) {
+	init_species_grids();
+    }
+
+    std::vector<t_polargrid *> grids = {&data[t_data::DUST_SIGMA],
+					&data[t_data::DUST_V_RADIAL],
+					&data[t_data::DUST_V_AZIMUTHAL]};
+    if (per_species) {
+	for (auto &grid : species_grids) {
+	    grids.push_back(grid.get());
+	}
+    }
+    for (t_polargrid *grid : grids) {
+	grid->clear();
+    }
+
+    if (!parameters::integrate_particles) {
+	return;
+    }
+
+    std::vector<t_particle> &particles = particles::particles;
+    const unsigned int N_particles = particles::local_number_of_particles;
+
+    // mass carried by each particle
+    double mass_per_particle = 0.0;
+    if (parameters::dust_deposition_mass > 0.0) {
+	unsigned int N_global = 0;
+	MPI_Allreduce(&N_particles, &N_global, 1, MPI_UNSIGNED, MPI_SUM,
+		      CPU_Comm);
+	if (N_global > 0) {
+	    mass_per_particle = parameters::dust_deposition_mass / N_global;
+	}
+    }
+
+    // bucket particles by the first ring of their stencil
+    std::vector<int> first_ring(N_particles);
+    std::vector<unsigned int> ring_offset(NRadial + 1, 0);
+    for (unsigned int i = 0; i < N_particles; ++i) {
+	double w[3];
+	weights_1D(radial_index(particles[i].get_distance_to_star()),
+		   first_ring[i], w);
+	const int ring =
+	    std::max(0, std::min((int)NRadial - 1, first_ring[i]));
+	ring_offset[ring + 1]++;
+    }
+    for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	ring_offset[nr + 1] += ring_offset[nr];
+    }
+    std::vector<unsigned int> bucket(N_particles);
+    {
+	std::vector<unsigned int> position(ring_offset.begin(),
+					   ring_offset.end() - 1);
+	for (unsigned int i = 0; i < N_particles; ++i) {
+	    const int ring =
+		std::max(0, std::min((int)NRadial - 1, first_ring[i]));
+	    bucket[position[ring]++] = i;
+	}
+    }
+
+    const double inv_dphi = (double)NAzimuthal / (2.0 * M_PI);
+
+    for (unsigned int color = 0; color < 3; ++color) {
+	#pragma omp parallel for schedule(dynamic)
+	for (unsigned int ring = color; ring < NRadial; ring += 3) {
+	    for (unsigned int b = ring_offset[ring]; b < ring_offset[ring + 1];
+		 ++b) {
+		t_particle &particle = particles[bucket[b]];
+
+		const double r = particle.get_distance_to_star();
+		const double phi = particle.get_angle();
+		const double mass = mass_per_particle > 0.0 ? mass_per_particle
+							    : particle.mass;
+		const double v_radial = particle.get_r_dot();
+		const double v_azimuthal =
+		    r * (particle.get_phi_dot() - refframe::OmegaFrame);
+
+		int first_r, first_az;
+		double w_r[3], w_az[3];
+		const unsigned int n_r =
+		    weights_1D(radial_index(r), first_r, w_r);
+		const unsigned int n_az =
+		    weights_1D(phi * inv_dphi - 0.5, first_az, w_az);
+
+		t_polargrid *species[3] = {nullptr, nullptr, nullptr};
+		if (per_species) {
+		    const unsigned int s = get_species(particle);
+		    for (unsigned int q = 0; q < 3; ++q) {
+			species[q] = species_grids[3 * s + q].get();
+		    }
+		}
+
+		for (unsigned int i = 0; i < n_r; ++i) {
+		    const unsigned int nr = std::max(
+			0, std::min((int)NRadial - 1, first_r + (int)i));
+		    for (unsigned int j = 0; j < n_az; ++j) {
+			const unsigned int naz =
+			    clamp_phi_id_to_grid(first_az + (int)j);
+			const double m = mass * w_r[i] * w_az[j];
+
+			data[t_data::DUST_SIGMA](nr, naz) += m;
+			data[t_data::DUST_V_RADIAL](nr, naz) += m * v_radial;
+			data[t_data::DUST_V_AZIMUTHAL](nr, naz) +=
+			    m * v_azimuthal;
+			if (per_species) {
+			    (*species[0])(nr, naz) += m;
+			    (*species[1])(nr, naz) += m * v_radial;
+			    (*species[2])(nr, naz) += m * v_azimuthal;
+			}
+		    }
+		}
+	    }
+	}
+    }
+
+    sum_overlap(grids);
+
+    // mass to surface density, momenta to velocities
+    for (unsigned int g = 0; g < grids.size(); g += 3) {
+	t_polargrid &sigma = *grids[g];
+	t_polargrid &v_radial = *grids[g + 1];
+	t_polargrid &v_azimuthal = *grids[g + 2];
+
+	#pragma omp parallel for collapse(2)
+	for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	    for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+		const double mass = sigma(nr, naz);
+		if (mass > 0.0) {
+		    v_radial(nr, naz) /= mass;
+		    v_azimuthal(nr, naz) /= mass;
+		}
+		sigma(nr, naz) = mass / Surf[nr];
+	    }
+	}
+    }
+}
+
+/**
+	Write the grids of the individual particle species, if enabled. The
+	total dust grids are part of t_data and written with the other grids.
+*/
+void write_species_grids(t_data &data, const bool write_2D_file)
+{
+    if (!parameters::dust_deposition_per_species ||
+	!data[t_data::DUST_SIGMA].get_write()) {
+	return;
+    }
+
+    deposit(data, 0, false);
+
+    for (auto &grid : species_grids) {
+	grid->set_write(data[t_data::DUST_SIGMA].get_write_2D(),
+			data[t_data::DUST_SIGMA].get_write_1D());
+	grid->write_polargrid(data, write_2D_file);
+    }
+}
+
+} // namespace dust_deposition
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../data.h"
+
+// Deposition of the dust particles onto the polar grid, giving dust surface
+// density and mass weighted dust velocities as regular polargrid outputs.
+
+namespace dust_deposition
+{
+
+void deposit(t_data &data, unsigned int timestep, bool force_update);
+void write_species_grids(t_data &data, const bool write_2D_file);
+
+} // namespace dust_deposition
@@ -4,6 +4,8 @@
 #include "../random/random_wrapper.h"
 #include "../Theo.h"
 #include "../parameters.h"
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 
 namespace dust_diffusion
@@ -25,25 +27,52 @@ size of the kick is drawn from a normal distribution.
 
 Kicks are only applied in the radial direction.
 In the azimuthal direction, Keplerian shear dominates.
+
+The normal variates are drawn from a counter based generator keyed by the
+particle id and the current time, so the kicks do not depend on the number
+of threads or processes and are reproduced after a restart.
 */
 void diffuse_dust(t_data &data, std::vector<t_particle> &particles,
-		  const double dt, const unsigned int N_particles)
+		  const double current_time, const double dt,
+		  const unsigned int N_particles)
 {
     if (parameters::calculate_disk) {
         compute_gas_diffusion_coefficient(data);
         compute_gas_density_radial_derivative(data);
     }
 
+    uint64_t counter;
+    static_assert(sizeof(counter) == sizeof(current_time));
+    memcpy(&counter, &current_time, sizeof(counter));
+
+    // particles are processed in blocks so the normal variates of a block
+    // can be drawn in one vectorized call
+    const unsigned int block_size = 256;
+    const unsigned int N_blocks = (N_particles + block_size - 1) / block_size;
+
     #pragma omp parallel for
-    for (unsigned int i = 0; i < N_particles; i++) {
-	auto &particle = particles[i];
-    const double deltar = kick_length(particle, data, dt);
+    for (unsigned int block = 0; block < N_blocks; block++) {
+	const unsigned int first = block * block_size;
+	const unsigned int n = std::min(block_size, N_particles - first);
+
+	uint64_t ids[block_size];
+	double normals[block_size];
+	for (unsigned int j = 0; j < n; j++) {
+	    ids[j] = particles[first + j].id;
+	}
+	fargo_random::get_std_normals(fargo_random::stream_dust_diffusion,
+				      counter, ids, n, normals);
+
+	for (unsigned int j = 0; j < n; j++) {
+	auto &particle = particles[first + j];
+    const double deltar = kick_length(particle, data, dt, normals[j]);
     const double rold = particle.r;
     const double rnew = rold + deltar;
 	particle.r = rnew;
     // correct azimuthal motion to avoid oscillations
     // for a particle on a circular orbit, v_phi^new = vK(r^new) instead of vK(r^old)
     particle.phi_dot *= std::pow(rold/rnew, 1.5); 
+	}
     }
 }
 
@@ -63,9 +92,10 @@ Charnoz et al. 2011 Eq. 21 (right now still 17 which ignores the varying dust
 diffusion coeff!)
 
 Use values from the grid cell the particle is currently in without
-interpolation.
+interpolation. snv is a standard normal variate.
  */
-double kick_length(t_particle &particle, t_data &data, const double dt)
+double kick_length(t_particle &particle, t_data &data, const double dt,
+		   const double snv)
 {
     const double r = particle.get_distance_to_star();
     const double phi = particle.get_angle();
@@ -86,7 +116,6 @@ double kick_length(t_particle &particle, t_data &data, const double dt)
     const double mean = Dd / rho * drho_dr * dt * dt * OmegaK;
     const double sigma = std::sqrt(2 * Dd * dt);
 
-    const double snv = fargo_random::get_std_normal();
     // Correct for missing diffusion in direction tangential to r
     const double corr_2d = r * ( std::sqrt(1 + std::pow(sigma*snv/r,2)) - 1 );
     const double deltar = mean + snv * sigma + corr_2d;
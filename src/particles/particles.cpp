@@ -19,8 +19,10 @@
 #include "../Theo.h"
 #include "../frame_of_reference.h"
 #include "../simulation.h"
+#include "../snapshot_writer.h"
 #include "../compute.h"
 #include "../random/random_wrapper.h"
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <mpi.h>
@@ -474,13 +476,25 @@ static void insert_particle(const unsigned long i, const unsigned int id_offset,
     particles[i].id = id_offset + i;
 }
 
+/**
+	Initialize particle i with random orbital elements. The numbers are drawn
+	from the counter based generator keyed by the global particle id, so the
+	initial conditions do not depend on the number of processes.
+*/
 static void
 init_particle(const unsigned long &i, const unsigned int &id_offset)
 {
+    const uint64_t id = id_offset + i;
+    double u_a, u_phi, u_e, u_unused;
+    fargo_random::get_uniform_pair(fargo_random::stream_particle_init, id, 0,
+				   u_a, u_phi);
+    fargo_random::get_uniform_pair(fargo_random::stream_particle_init, id, 1,
+				   u_e, u_unused);
+
     double semi_major_axis =
-	power_law_distribution(fargo_random::get_uniform_one(), parameters::particle_slope);
-    double phi = fargo_random::get_uniform_two_pi();
-    double eccentricity = fargo_random::get_uniform_dust_eccentricity();
+	power_law_distribution(u_a, parameters::particle_slope);
+    double phi = 2.0 * M_PI * u_phi;
+    double eccentricity = parameters::particle_eccentricity * u_e;
 
     /*
     // debug setup
@@ -536,7 +550,7 @@ static void init_dust_profile()
     std::vector<unsigned int> nodes_number_of_particles(CPU_Number);
     MPI_Allgather(&local_number_of_particles, 1, MPI_UNSIGNED,
 		  &nodes_number_of_particles[0], 1, MPI_UNSIGNED,
-		  MPI_COMM_WORLD);
+		  CPU_Comm);
 
     // compute local offset
     unsigned int local_offset = 0;
@@ -544,10 +558,7 @@ static void init_dust_profile()
 	local_offset += nodes_number_of_particles[cpu];
     }
 
-    for (unsigned int i = 0; i < local_offset; ++i) {
-	init_particle(0, local_offset); // bring random generator to correct position
-    }
-
+    #pragma omp parallel for
     for (unsigned int i = 0; i < local_number_of_particles; ++i) {
 	init_particle(i, local_offset);
     }
@@ -659,7 +670,7 @@ static void init_populate_disk(t_data &data)
 	}
 
 	MPI_Allreduce(&local_mass, &global_mass, 1, MPI_DOUBLE, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 
 	const double disk_mass = global_mass;
 	///////////////////////////////////////////////////////////////////////////////////
@@ -681,7 +692,10 @@ static void init_populate_disk(t_data &data)
 		const double cell_mass = Surf[nr] * data[t_data::SIGMA](nr, naz);
 
 		double particles_in_cell = cell_mass / disk_mass * (double)global_number_of_particles;
-		const double roll = fargo_random::get_uniform_one();
+		double roll, roll_unused;
+		fargo_random::get_uniform_pair(
+		    fargo_random::stream_particle_init,
+		    (uint64_t)(IMIN + nr) * NAzimuthal + naz, 2, roll, roll_unused);
 
 		while(particles_in_cell > 1.0){
 
@@ -706,7 +720,7 @@ static void init_populate_disk(t_data &data)
 
 	unsigned int total_initialized = 0;
 	MPI_Allreduce(&particle_init_counter, &total_initialized, 1, MPI_UNSIGNED, MPI_SUM,
-		      MPI_COMM_WORLD);
+		      CPU_Comm);
 
 	if(CPU_Master){
 	for (unsigned int i = total_initialized; i < local_number_of_particles; ++i) {
@@ -855,7 +869,7 @@ void restart()
     // try to open file
 
     mpi_error_check_file_read(
-	MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_RDONLY,
+	MPI_File_open(CPU_Comm, filename.c_str(), MPI_MODE_RDONLY,
 		      MPI_INFO_NULL, &fh),
 	filename.c_str());
 
@@ -866,7 +880,7 @@ void restart()
     std::vector<unsigned int> nodes_number_of_particles(CPU_Number);
     MPI_Allgather(&local_number_of_particles, 1, MPI_UNSIGNED,
 		  &nodes_number_of_particles[0], 1, MPI_UNSIGNED,
-		  MPI_COMM_WORLD);
+		  CPU_Comm);
 
     // compute local offset
     unsigned int local_offset = 0;
@@ -1550,7 +1564,8 @@ void integrate(t_data &data, const double current_time, const double dt)
 			check_tstop(data);
 		}
 		// TODO: should be before corrector step for implicit method: see Picogna+2018 App. B.2
-		dust_diffusion::diffuse_dust(data, particles, dt, local_number_of_particles);
+		dust_diffusion::diffuse_dust(data, particles, current_time, dt,
+					     local_number_of_particles);
     }
 	move();
 
@@ -1674,342 +1689,361 @@ void integrate_exponential_midpoint(t_data &data, const double dt)
 }
 
 
-void integrate_explicit_adaptive(t_data &data, const double dt)
+// Cash-Karp tableau, see
+// http://en.wikipedia.org/wiki/Cash%E2%80%93Karp_method
+static const double cash_karp_a[6][5] = {
+    {0.0, 0.0, 0.0, 0.0, 0.0},
+    {0.2, 0.0, 0.0, 0.0, 0.0},
+    {0.075, 0.225, 0.0, 0.0, 0.0},
+    {0.3, -0.9, 1.2, 0.0, 0.0},
+    {-11.0 / 54.0, 2.5, -70.0 / 27.0, 35.0 / 27.0, 0.0},
+    {1631.0 / 55296.0, 175.0 / 512.0, 575.0 / 13824.0, 44275.0 / 110592.0,
+     253.0 / 4096.0}};
+// 5th order weights
+static const double cash_karp_b[6] = {37.0 / 378.0,  0.0, 250.0 / 621.0,
+				      125.0 / 594.0, 0.0, 512.0 / 1771.0};
+// difference between 5th and 4th order weights
+static const double cash_karp_e[6] = {
+    37.0 / 378.0 - 2825.0 / 27648.0, 0.0,
+    250.0 / 621.0 - 18575.0 / 48384.0, 125.0 / 594.0 - 13525 / 55296.0,
+    -277.0 / 14336.0, 512.0 / 1771.0 - 1.0 / 4.0};
+
+// number of particles integrated together in SIMD lanes
+static const unsigned int batch_lanes = 8;
+// number of particles handed to a thread at once
+static const unsigned int batch_chunk_size = 64;
+
+/**
+	Positions and masses of the planets, copied into arrays once per
+	integration so the batched right-hand side can vectorize over particles.
+*/
+struct t_planet_arrays {
+    std::vector<double> x, y, r, phi, GM;
+};
+
+static t_planet_arrays get_planet_arrays(t_data &data)
 {
+    t_planet_arrays planets;
+    for (unsigned int k = 0;
+	 k < data.get_planetary_system().get_number_of_planets(); ++k) {
+	const t_planet &planet = data.get_planetary_system().get_planet(k);
+	planets.x.push_back(planet.get_x());
+	planets.y.push_back(planet.get_y());
+	planets.r.push_back(planet.get_r());
+	planets.phi.push_back(planet.get_phi());
+	planets.GM.push_back(constants::G * planet.get_mass());
+    }
+    return planets;
+}
+
+/**
+	Right-hand side for all lanes of a batch. y and k hold r, phi, r_dot and
+	phi_dot (or x, y, vx, vy for cartesian particles) of every lane. Same
+	forces as calculate_accelerations_from_star_and_planets(_cart).
+*/
+static void batch_derivatives(const t_planet_arrays &planets,
+			      const double y[4][batch_lanes],
+			      const double eps_sq[batch_lanes],
+			      double k[4][batch_lanes])
+{
+    const unsigned int N_planets = planets.GM.size();
 
     if (parameters::CartesianParticles) {
-	// disk gravity on particles is inside gas_drag function
-	if (parameters::particle_gas_drag_enabled)
-	    update_velocities_from_gas_drag_cart(data, dt);
+	#pragma omp simd
+	for (unsigned int l = 0; l < batch_lanes; ++l) {
+	    k[0][l] = y[2][l];
+	    k[1][l] = y[3][l];
+	    k[2][l] = 0.0;
+	    k[3][l] = 0.0;
+	}
+	for (unsigned int p = 0; p < N_planets; ++p) {
+	    #pragma omp simd
+	    for (unsigned int l = 0; l < batch_lanes; ++l) {
+		const double dx = planets.x[p] - y[0][l];
+		const double dy = planets.y[p] - y[1][l];
+		const double r2 = dx * dx + dy * dy + eps_sq[l];
+		const double dist = std::sqrt(r2);
+		const double factor = planets.GM[p] / (dist * r2);
+		k[2][l] += factor * dx;
+		k[3][l] += factor * dy;
+	    }
+	}
     } else {
-	// disk gravity on particles is inside gas_drag function
-	if (parameters::particle_gas_drag_enabled)
-	    update_velocities_from_gas_drag(data, dt);
+	#pragma omp simd
+	for (unsigned int l = 0; l < batch_lanes; ++l) {
+	    const double r = y[0][l];
+	    const double r_dot = y[2][l];
+	    const double phi_dot = y[3][l];
+	    k[0][l] = r_dot;
+	    k[1][l] = phi_dot;
+	    k[2][l] = r * phi_dot * phi_dot; // Centrifugal force
+	    k[3][l] = -2.0 * r_dot / r * phi_dot;
+	}
+	for (unsigned int p = 0; p < N_planets; ++p) {
+	    #pragma omp simd
+	    for (unsigned int l = 0; l < batch_lanes; ++l) {
+		const double r = y[0][l];
+		const double delta_phi = y[1][l] - planets.phi[p];
+		const double sin_delta_phi = std::sin(delta_phi);
+		const double cos_delta_phi = std::cos(delta_phi);
+
+		const double dist = std::sqrt(
+		    r * r + planets.r[p] * planets.r[p] -
+		    2 * r * planets.r[p] * cos_delta_phi + eps_sq[l]);
+		const double factor = planets.GM[p] / (dist * dist * dist);
+
+		k[2][l] -= factor * (r - planets.r[p] * cos_delta_phi);
+		k[3][l] -= factor * planets.r[p] * sin_delta_phi / r;
+	    }
+	}
     }
+}
 
-    // as particles move independent of each other, we can integrate one after
-    // one
-	#pragma omp parallel for
-    for (unsigned int i = 0; i < local_number_of_particles; ++i) {
-
-	double fac, fac11;
-	double atoli, rtoli, err, sk;
-	double sqr;
-
-	constexpr double beta = 0.04;
-	constexpr double fac1 = 0.2;
-	constexpr double fac2 = 10.0;
-	constexpr double safe = 0.9;
-
-	constexpr double expo1 = 0.2 - beta * 0.75;
-	constexpr double facc1 = 1.0 / fac1;
-	constexpr double facc2 = 1.0 / fac2;
-
-	constexpr double e1 = 37.0 / 378.0 - 2825.0 / 27648.0;
-	constexpr double e3 = 250.0 / 621.0 - 18575.0 / 48384.0;
-	constexpr double e4 = 125.0 / 594.0 - 13525 / 55296.0;
-	constexpr double e5 = -277.0 / 14336.0;
-	constexpr double e6 = 512.0 / 1771.0 - 1.0 / 4.0;
-
-	// initial preparations
-	atoli = 1e-14;
-	rtoli = 1e-12;
-	bool last = false;
-
-	bool reject = false;
-
-	// basic integration step
-	double dt_particle_temp = 0.0;
+/**
+	Integrate the particles queue[0..N_queue) over dt with the adaptive
+	Cash-Karp method. The particles are processed in batches of batch_lanes;
+	every lane has its own step size control and a lane is refilled with the
+	next particle of the queue as soon as its particle has reached dt.
+*/
+static void integrate_adaptive_batch(t_data &data,
+				     const t_planet_arrays &planets,
+				     const unsigned int *queue,
+				     const unsigned int N_queue,
+				     const double dt)
+{
+    constexpr double beta = 0.04;
+    constexpr double fac1 = 0.2;
+    constexpr double fac2 = 10.0;
+    constexpr double safe = 0.9;
+
+    constexpr double expo1 = 0.2 - beta * 0.75;
+    constexpr double facc1 = 1.0 / fac1;
+    constexpr double facc2 = 1.0 / fac2;
+
+    constexpr double atoli = 1e-14;
+    constexpr double rtoli = 1e-12;
+
+    bool active[batch_lanes];
+    unsigned int index[batch_lanes];
+    double elapsed[batch_lanes];
+    bool last[batch_lanes];
+    bool update_timestep[batch_lanes];
+    bool reject[batch_lanes];
+
+    double y0[4][batch_lanes];
+    double y[4][batch_lanes];
+    double k[6][4][batch_lanes];
+    double h[batch_lanes];
+    double eps_sq[batch_lanes];
+
+    unsigned int next = 0;
+    unsigned int N_active = 0;
+
+    auto fill_lane = [&](const unsigned int l) {
+	active[l] = next < N_queue;
+	if (active[l]) {
+	    index[l] = queue[next++];
+	    elapsed[l] = 0.0;
+	    last[l] = false;
+	    reject[l] = false;
+	    N_active++;
+	}
+    };
 
-	while (!last) {
-	    double timestep = particles[i].timestep;
-	    const double &old_timestep = particles[i].timestep;
-	    bool update_timestep = true;
+    for (unsigned int l = 0; l < batch_lanes; ++l) {
+	fill_lane(l);
+    }
 
-	    if (dt_particle_temp + timestep * 1.01 > dt) {
-		timestep = dt - dt_particle_temp;
-		last = true;
-		update_timestep = false;
+    while (N_active > 0) {
+	// step sizes and smoothing lengths of this attempt
+	for (unsigned int l = 0; l < batch_lanes; ++l) {
+	    if (!active[l]) {
+		// idle lanes integrate a harmless dummy state
+		y0[0][l] = 1.0;
+		y0[1][l] = 0.0;
+		y0[2][l] = 0.0;
+		y0[3][l] = 0.0;
+		eps_sq[l] = 1.0;
+		h[l] = 0.0;
+		continue;
 	    }
 
-	    double k1_r, k1_phi, k1_r_dot, k1_phi_dot;
-	    double k2_r, k2_phi, k2_r_dot, k2_phi_dot;
-	    double k3_r, k3_phi, k3_r_dot, k3_phi_dot;
-	    double k4_r, k4_phi, k4_r_dot, k4_phi_dot;
-	    double k5_r, k5_phi, k5_r_dot, k5_phi_dot;
-	    double k6_r, k6_phi, k6_r_dot, k6_phi_dot;
-
-	    double temp_ar, temp_aphi, temp_r, temp_phi, temp_r_dot,
-		temp_phi_dot;
-
-	    temp_r = particles[i].r;
-	    temp_phi = particles[i].phi;
-	    temp_r_dot = particles[i].r_dot;
-	    temp_phi_dot = particles[i].phi_dot;
-
-	    const double rsmooth = calculate_dust_smoothing(
-		particles[i].get_distance_to_star(), particles[i].get_angle(),
-		particles[i].stokes, data);
-
-	    // Cash–Karp method
-	    // (http://en.wikipedia.org/wiki/Cash%E2%80%93Karp_method) cartesian
-	    // coordinates are written inside the polar coordinates
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
+	    t_particle &particle = particles[index[l]];
+	    y0[0][l] = particle.r;
+	    y0[1][l] = particle.phi;
+	    y0[2][l] = particle.r_dot;
+	    y0[3][l] = particle.phi_dot;
+
+	    h[l] = particle.timestep;
+	    update_timestep[l] = true;
+	    if (elapsed[l] + h[l] * 1.01 > dt) {
+		h[l] = dt - elapsed[l];
+		last[l] = true;
+		update_timestep[l] = false;
 	    }
 
-	    // calculate k1
-	    k1_r_dot = temp_ar;
-	    k1_phi_dot = temp_aphi;
-	    k1_r = temp_r_dot;
-	    k1_phi = temp_phi_dot;
+	    const double rsmooth = calculate_dust_smoothing(
+		particle.get_distance_to_star(), particle.get_angle(),
+		particle.stokes, data);
+	    eps_sq[l] = rsmooth * rsmooth;
+	}
 
-	    temp_r = particles[i].r + timestep * 0.2 * k1_r;
-	    temp_phi = particles[i].phi + timestep * 0.2 * k1_phi;
+	// stages
+	for (unsigned int s = 0; s < 6; ++s) {
+	    for (unsigned int v = 0; v < 4; ++v) {
+		#pragma omp simd
+		for (unsigned int l = 0; l < batch_lanes; ++l) {
+		    double sum = 0.0;
+		    for (unsigned int j = 0; j < s; ++j) {
+			sum += cash_karp_a[s][j] * k[j][v][l];
+		    }
+		    y[v][l] = y0[v][l] + h[l] * sum;
+		}
+	    }
+	    batch_derivatives(planets, y, eps_sq, k[s]);
+	}
 
-	    temp_r_dot = particles[i].r_dot + timestep * 0.2 * k1_r_dot;
-	    temp_phi_dot = particles[i].phi_dot + timestep * 0.2 * k1_phi_dot;
+	// new state and error estimate
+	double err[batch_lanes];
+	double ddot[2][batch_lanes];
+	#pragma omp simd
+	for (unsigned int l = 0; l < batch_lanes; ++l) {
+	    err[l] = 0.0;
+	}
+	for (unsigned int v = 0; v < 4; ++v) {
+	    #pragma omp simd
+	    for (unsigned int l = 0; l < batch_lanes; ++l) {
+		double sum_b = 0.0;
+		double sum_e = 0.0;
+		for (unsigned int s = 0; s < 6; ++s) {
+		    sum_b += cash_karp_b[s] * k[s][v][l];
+		    sum_e += cash_karp_e[s] * k[s][v][l];
+		}
+		y[v][l] = y0[v][l] + h[l] * sum_b;
+		if (v >= 2) {
+		    ddot[v - 2][l] = sum_b;
+		}
 
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
-	    }
-	    // calculate k2
-	    k2_r_dot = temp_ar;
-	    k2_phi_dot = temp_aphi;
-	    k2_r = temp_r_dot;
-	    k2_phi = temp_phi_dot;
-
-	    temp_r = particles[i].r + timestep * (0.075 * k1_r + 0.225 * k2_r);
-	    temp_phi =
-		particles[i].phi + timestep * (0.075 * k1_phi + 0.225 * k2_phi);
-
-	    temp_r_dot = particles[i].r_dot +
-			 timestep * (0.075 * k1_r_dot + 0.225 * k2_r_dot);
-	    temp_phi_dot = particles[i].phi_dot +
-			   timestep * (0.075 * k1_phi_dot + 0.225 * k2_phi_dot);
-
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
+		const double sk =
+		    atoli + rtoli * std::fmax(std::fabs(y0[v][l]), std::fabs(y[v][l]));
+		const double sqr = h[l] * sum_e / sk;
+		err[l] += sqr * sqr;
 	    }
-	    // calculate k3
-	    k3_r_dot = temp_ar;
-	    k3_phi_dot = temp_aphi;
-	    k3_r = temp_r_dot;
-	    k3_phi = temp_phi_dot;
-
-	    temp_r = particles[i].r +
-		     timestep * (0.3 * k1_r - 0.9 * k2_r + 1.2 * k3_r);
-	    temp_phi = particles[i].phi +
-		       timestep * (0.3 * k1_phi - 0.9 * k2_phi + 1.2 * k3_phi);
-
-	    temp_r_dot =
-		particles[i].r_dot +
-		timestep * (0.3 * k1_r_dot - 0.9 * k2_r_dot + 1.2 * k3_r_dot);
-	    temp_phi_dot = particles[i].phi_dot +
-			   timestep * (0.3 * k1_phi_dot - 0.9 * k2_phi_dot +
-				       1.2 * k3_phi_dot);
-
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
-	    }
-	    // calculate k4
-	    k4_r_dot = temp_ar;
-	    k4_phi_dot = temp_aphi;
-	    k4_r = temp_r_dot;
-	    k4_phi = temp_phi_dot;
-
-	    temp_r = particles[i].r +
-		     timestep * (-11.0 / 54.0 * k1_r + 2.5 * k2_r -
-				 70.0 / 27.0 * k3_r + 35.0 / 27.0 * k4_r);
-	    temp_phi = particles[i].phi +
-		       timestep * (-11.0 / 54.0 * k1_phi + 2.5 * k2_phi -
-				   70.0 / 27.0 * k3_phi + 35.0 / 27.0 * k4_phi);
-
-	    temp_r_dot =
-		particles[i].r_dot +
-		timestep * (-11.0 / 54.0 * k1_r_dot + 2.5 * k2_r_dot -
-			    70.0 / 27.0 * k3_r_dot + 35.0 / 27.0 * k4_r_dot);
-	    temp_phi_dot =
-		particles[i].phi_dot +
-		timestep *
-		    (-11.0 / 54.0 * k1_phi_dot + 2.5 * k2_phi_dot -
-		     70.0 / 27.0 * k3_phi_dot + 35.0 / 27.0 * k4_phi_dot);
-
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
-	    }
-	    // calculate k5
-	    k5_r_dot = temp_ar;
-	    k5_phi_dot = temp_aphi;
-	    k5_r = temp_r_dot;
-	    k5_phi = temp_phi_dot;
-
-	    temp_r =
-		particles[i].r +
-		timestep * (1631.0 / 55296.0 * k1_r + 175.0 / 512.0 * k2_r +
-			    575.0 / 13824.0 * k3_r + 44275.0 / 110592.0 * k4_r +
-			    253.0 / 4096.0 * k5_r);
-	    temp_phi =
-		particles[i].phi +
-		timestep *
-		    (1631.0 / 55296.0 * k1_phi + 175.0 / 512.0 * k2_phi +
-		     575.0 / 13824.0 * k3_phi + 44275.0 / 110592.0 * k4_phi +
-		     253.0 / 4096.0 * k5_phi);
-
-	    temp_r_dot =
-		particles[i].r_dot +
-		timestep *
-		    (1631.0 / 55296.0 * k1_r_dot + 175.0 / 512.0 * k2_r_dot +
-		     575.0 / 13824.0 * k3_r_dot +
-		     44275.0 / 110592.0 * k4_r_dot + 253.0 / 4096.0 * k5_r_dot);
-	    temp_phi_dot = particles[i].phi_dot +
-			   timestep * (1631.0 / 55296.0 * k1_phi_dot +
-				       175.0 / 512.0 * k2_phi_dot +
-				       575.0 / 13824.0 * k3_phi_dot +
-				       44275.0 / 110592.0 * k4_phi_dot +
-				       253.0 / 4096.0 * k5_phi_dot);
-
-	    if (parameters::CartesianParticles) {
-		calculate_accelerations_from_star_and_planets_cart(
-		    temp_ar, temp_aphi, temp_r, temp_phi, rsmooth, data);
-	    } else {
-		calculate_accelerations_from_star_and_planets(
-		    temp_ar, temp_aphi, temp_r, temp_r_dot, temp_phi,
-		    temp_phi_dot, rsmooth, data);
-	    }
-	    // calculate k6
-	    k6_r_dot = temp_ar;
-	    k6_phi_dot = temp_aphi;
-	    k6_r = temp_r_dot;
-	    k6_phi = temp_phi_dot;
-
-	    // estimate new positions and velocities
-	    const double r_new =
-		particles[i].r +
-		timestep * (37.0 / 378.0 * k1_r + 250.0 / 621.0 * k3_r +
-			    125.0 / 594.0 * k4_r + 512.0 / 1771.0 * k6_r);
-	    double phi_new =
-		particles[i].phi +
-		timestep * (37.0 / 378.0 * k1_phi + 250.0 / 621.0 * k3_phi +
-			    125.0 / 594.0 * k4_phi + 512.0 / 1771.0 * k6_phi);
-
-	    if (!parameters::CartesianParticles) {
-		check_angle(phi_new);
+	}
+
+	// step size control, identical to the scalar integrator
+	for (unsigned int l = 0; l < batch_lanes; ++l) {
+	    if (!active[l]) {
+		continue;
 	    }
 
-	    const double r_ddot_new =
-		(37.0 / 378.0 * k1_r_dot + 250.0 / 621.0 * k3_r_dot +
-		 125.0 / 594.0 * k4_r_dot + 512.0 / 1771.0 * k6_r_dot);
-	    const double phi_ddot_new =
-		(37.0 / 378.0 * k1_phi_dot + 250.0 / 621.0 * k3_phi_dot +
-		 125.0 / 594.0 * k4_phi_dot + 512.0 / 1771.0 * k6_phi_dot);
-
-	    const double r_dot_new = particles[i].r_dot + timestep * r_ddot_new;
-	    const double phi_dot_new =
-		particles[i].phi_dot + timestep * phi_ddot_new;
-
-	    // error estimates, reuse k2 variables
-	    k2_r = timestep *
-		   (e1 * k1_r + e3 * k3_r + e4 * k4_r + e5 * k5_r + e6 * k6_r);
-	    k2_phi = timestep * (e1 * k1_phi + e3 * k3_phi + e4 * k4_phi +
-				 e5 * k5_phi + e6 * k6_phi);
-	    k2_r_dot =
-		timestep * (e1 * k1_r_dot + e3 * k3_r_dot + e4 * k4_r_dot +
-			    e5 * k5_r_dot + e6 * k6_r_dot);
-	    k2_phi_dot = timestep *
-			 (e1 * k1_phi_dot + e3 * k3_phi_dot + e4 * k4_phi_dot +
-			  e5 * k5_phi_dot + e6 * k6_phi_dot);
-
-	    // error estimation
-	    err = 0.0;
-
-	    sk = atoli + rtoli * fmax(fabs(particles[i].r), fabs(r_new));
-	    sqr = k2_r / sk;
-	    err += sqr * sqr;
-
-	    sk = atoli + rtoli * fmax(fabs(particles[i].phi), fabs(phi_new));
-	    sqr = k2_phi / sk;
-	    err += sqr * sqr;
-
-	    sk =
-		atoli + rtoli * fmax(fabs(particles[i].r_dot), fabs(r_dot_new));
-	    sqr = k2_r_dot / sk;
-	    err += sqr * sqr;
-
-	    sk = atoli +
-		 rtoli * fmax(fabs(particles[i].phi_dot), fabs(phi_dot_new));
-	    sqr = k2_phi_dot / sk;
-	    err += sqr * sqr;
-
-	    err = std::sqrt(err / (double)(4));
+	    t_particle &particle = particles[index[l]];
+	    // a reference, as in the scalar integrator: after the update below
+	    // old_timestep is the new timestep
+	    const double &old_timestep = particle.timestep;
+	    const double error = std::sqrt(err[l] / (double)(4));
+
 	    // computation of hnew
-	    fac11 = pow(err, expo1);
+	    const double fac11 = pow(error, expo1);
 	    // Lund-stabilization
-	    fac = fac11 / pow(particles[i].facold, beta);
+	    double fac = fac11 / pow(particle.facold, beta);
 	    // we require fac1 <= hnew/h <= fac2
 	    fac = fmax(facc2, fmin(facc1, fac / safe));
 
 	    // if timestep is reduced to reach full dt, don't make it larger
-	    if (!update_timestep)
+	    if (!update_timestep[l])
 		fac = fmax(fac, 1.0);
 
-	    particles[i].timestep = old_timestep / fac;
+	    particle.timestep = old_timestep / fac;
 
-	    if (err <= 1.0) {
+	    if (error <= 1.0) {
 		// step accepted
-		particles[i].facold = fmax(err, 1.0e-4);
-		dt_particle_temp += timestep;
+		particle.facold = fmax(error, 1.0e-4);
+		elapsed[l] += h[l];
+
+		double phi_new = y[1][l];
+		if (!parameters::CartesianParticles) {
+		    check_angle(phi_new);
+		}
 
 		// update position & velocity
-		particles[i].r = r_new;
-		particles[i].phi = phi_new;
+		particle.r = y[0][l];
+		particle.phi = phi_new;
 
-		particles[i].r_dot = r_dot_new;
-		particles[i].phi_dot = phi_dot_new;
+		particle.r_dot = y[2][l];
+		particle.phi_dot = y[3][l];
 
-		particles[i].r_ddot = r_ddot_new;
-		particles[i].phi_ddot = phi_ddot_new;
+		particle.r_ddot = ddot[0][l];
+		particle.phi_ddot = ddot[1][l];
 
-		if (reject) // last try was rejected
+		if (reject[l]) // last try was rejected
 		{
-		    particles[i].timestep =
-			fmin(fabs(particles[i].timestep), fabs(old_timestep));
+		    particle.timestep =
+			fmin(fabs(particle.timestep), fabs(old_timestep));
+		}
+		reject[l] = false;
+
+		if (last[l]) {
+		    N_active--;
+		    fill_lane(l);
 		}
-		reject = false;
 	    } else // timestep rejected
 	    {
-		particles[i].timestep =
-		    old_timestep / fmin(facc1, fac11 / safe);
-		reject = true;
-		last = false;
+		particle.timestep = old_timestep / fmin(facc1, fac11 / safe);
+		reject[l] = true;
+		last[l] = false;
 	    }
 	}
     }
+}
+
+void integrate_explicit_adaptive(t_data &data, const double dt)
+{
+
+    if (parameters::CartesianParticles) {
+	// disk gravity on particles is inside gas_drag function
+	if (parameters::particle_gas_drag_enabled)
+	    update_velocities_from_gas_drag_cart(data, dt);
+    } else {
+	// disk gravity on particles is inside gas_drag function
+	if (parameters::particle_gas_drag_enabled)
+	    update_velocities_from_gas_drag(data, dt);
+    }
+
+    // Particles are sorted by the number of steps they are expected to need,
+    // so particles integrated together in a batch finish at similar times.
+    // Chunks of particles are distributed dynamically over the threads.
+    const unsigned int N_levels = 64;
+    std::vector<unsigned int> level(local_number_of_particles);
+    std::vector<unsigned int> level_offset(N_levels + 1, 0);
+    for (unsigned int i = 0; i < local_number_of_particles; ++i) {
+	const double timestep = particles[i].timestep;
+	int l = 0;
+	if (timestep > 0.0 && timestep < dt) {
+	    l = std::min((int)N_levels - 1, std::ilogb(dt / timestep));
+	}
+	level[i] = l;
+	level_offset[l + 1]++;
+    }
+    for (unsigned int l = 0; l < N_levels; ++l) {
+	level_offset[l + 1] += level_offset[l];
+    }
+    std::vector<unsigned int> order(local_number_of_particles);
+    for (unsigned int i = 0; i < local_number_of_particles; ++i) {
+	order[level_offset[level[i]]++] = i;
+    }
+
+    const t_planet_arrays planets = get_planet_arrays(data);
+    const unsigned int N_chunks =
+	(local_number_of_particles + batch_chunk_size - 1) / batch_chunk_size;
+
+	#pragma omp parallel for schedule(dynamic)
+    for (unsigned int chunk = 0; chunk < N_chunks; ++chunk) {
+	const unsigned int first = chunk * batch_chunk_size;
+	const unsigned int N = std::min(batch_chunk_size,
+					local_number_of_particles - first);
+	integrate_adaptive_batch(data, planets, &order[first], N, dt);
+    }
     move();
 }
 
@@ -2043,7 +2077,7 @@ void move(void)
     // receive particles from outer node first
     if (CPU_Rank < CPU_Highest) {
 	MPI_Status status;
-	MPI_Probe(CPU_Next, 0, MPI_COMM_WORLD, &status);
+	MPI_Probe(CPU_Next, 0, CPU_Comm, &status);
 	int number;
 	MPI_Get_count(&status, mpi_particle, &number);
 
@@ -2054,7 +2088,7 @@ void move(void)
 	}
 
 	MPI_Recv(&particles[0] + local_number_of_particles, number, mpi_particle,
-		 CPU_Next, 0, MPI_COMM_WORLD, &status);
+		 CPU_Next, 0, CPU_Comm, &status);
 
 	local_number_of_particles += number;
     }
@@ -2078,7 +2112,7 @@ void move(void)
 	MPI_Type_indexed(inward_count, &inward_size[0], &inward_offset[0],
 			 mpi_particle, &inward_type);
 	MPI_Type_commit(&inward_type);
-	MPI_Send(&particles[0], 1, inward_type, CPU_Prev, 0, MPI_COMM_WORLD);
+	MPI_Send(&particles[0], 1, inward_type, CPU_Prev, 0, CPU_Comm);
 	MPI_Type_free(&inward_type);
     }
 
@@ -2099,7 +2133,7 @@ void move(void)
     // receive particles from inner node first
     if (CPU_Rank > 0) {
 	MPI_Status status;
-	MPI_Probe(CPU_Prev, 0, MPI_COMM_WORLD, &status);
+	MPI_Probe(CPU_Prev, 0, CPU_Comm, &status);
 	int number;
 	MPI_Get_count(&status, mpi_particle, &number);
 
@@ -2110,7 +2144,7 @@ void move(void)
 	}
 
 	MPI_Recv(&particles[0] + local_number_of_particles, number, mpi_particle,
-		 CPU_Prev, 0, MPI_COMM_WORLD, &status);
+		 CPU_Prev, 0, CPU_Comm, &status);
 
 	local_number_of_particles += number;
     }
@@ -2137,7 +2171,7 @@ void move(void)
 	MPI_Type_indexed(outward_count, &outward_size[0], &outward_offset[0],
 			 mpi_particle, &outward_type);
 	MPI_Type_commit(&outward_type);
-	MPI_Send(&particles[0], 1, outward_type, CPU_Next, 0, MPI_COMM_WORLD);
+	MPI_Send(&particles[0], 1, outward_type, CPU_Next, 0, CPU_Comm);
 	MPI_Type_free(&outward_type);
     }
 
@@ -2157,7 +2191,7 @@ void move(void)
 
     // update global_number_of_particles
     MPI_Allreduce(&local_number_of_particles, &global_number_of_particles, 1,
-		  MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+		  MPI_INT, MPI_SUM, CPU_Comm);
 }
 
 /* Write a particle file if it does not exists in the current snapshot directory
@@ -2175,22 +2209,13 @@ void write_if_not_exist() {
 
 void write()
 {
-    MPI_File fh;
-    MPI_Status status;
-
     std::string filename = output::snapshot_dir + "/particles.dat";
 
-    // try to open file
-    mpi_error_check_file_write(
-	MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-		      MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &fh),
-	filename.c_str());
-
     // get number of local particles from all nodes to compute correct offsets
     std::vector<unsigned int> nodes_number_of_particles(CPU_Number);
     MPI_Allgather(&local_number_of_particles, 1, MPI_UNSIGNED,
 		  &nodes_number_of_particles[0], 1, MPI_UNSIGNED,
-		  MPI_COMM_WORLD);
+		  CPU_Comm);
 
     // compute local offset
     unsigned int local_offset = 0;
@@ -2198,14 +2223,9 @@ void write()
 	local_offset += nodes_number_of_particles[cpu];
     }
 
-    MPI_File_set_view(fh, 0, mpi_particle, mpi_particle,
-		      const_cast<char *>("native"), MPI_INFO_NULL);
-    MPI_File_seek(fh, local_offset, MPI_SEEK_SET);
-    MPI_File_write(fh, &particles[0], local_number_of_particles, mpi_particle,
-		   &status);
-
-    // close file
-    MPI_File_close(&fh);
+    snapshot_writer::write(filename, particles.data(),
+			   local_number_of_particles, mpi_particle,
+			   local_offset);
 }
 
 
@@ -5,17 +5,21 @@
 
 #include "polargrid.h"
 #include "LowTasks.h"
+#include "allocation.h"
 #include "constants.h"
 #include "global.h"
 #include "logging.h"
 #include "mpi_utils.h"
 #include "output.h"
+#include "radial_profile.h"
+#include "snapshot_writer.h"
 #include <cfloat>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <mpi.h>
+#include <vector>
 
 #ifndef DISABLE_GSL
 #include <gsl/gsl_spline.h>
@@ -42,7 +46,7 @@ t_polargrid::t_polargrid()
 t_polargrid::~t_polargrid()
 {
     delete[] m_name;
-    delete[] Field;
+    allocation::deallocate(Field);
 }
 
 /**
@@ -51,16 +55,15 @@ t_polargrid::~t_polargrid()
 void t_polargrid::set_size(ptrdiff_t size_radial, ptrdiff_t size_azimuthal)
 {
     // delete old field
-    delete[] Field;
+    allocation::deallocate(Field);
 
     Nrad = size_radial;
     Nsec = size_azimuthal;
 
     // vector fields need one more cell in radial direction
-    Field = new double[(m_scalar ? size_radial : size_radial + 1) *
-		       (size_azimuthal)];
-
-    clear();
+    // memory is placed by first touch in the allocator
+    Field = allocation::allocate_grid(
+	(m_scalar ? size_radial : size_radial + 1) * (size_azimuthal));
 }
 
 /**
@@ -92,10 +95,16 @@ void t_polargrid::set_scalar(bool value) { m_scalar = value; }
 */
 void t_polargrid::clear()
 {
-    memset(Field, 0, get_size_radial() * get_size_azimuthal() * sizeof(*Field));
+    allocation::clear_grid(Field, get_size_radial() * get_size_azimuthal());
 }
 
-void t_polargrid::write_polargrid(t_data &data)
+/**
+	Compute the grid if necessary and write the 1D and 2D files. The 2D file
+	is skipped if write_2D_file is false, e.g. if the data goes into the
+	checkpoint container. Grids which are cleared after writing are cleared
+	by the caller.
+*/
+void t_polargrid::write_polargrid(t_data &data, const bool write_2D_file)
 {
     if ((get_write_1D() || get_write_2D() || m_calculate_on_write)) {
 	if (m_do_before_write != NULL) {
@@ -107,13 +116,9 @@ void t_polargrid::write_polargrid(t_data &data)
 	write1D();
     }
 
-    if (get_write_2D()) {
+    if (get_write_2D() && write_2D_file) {
 	write2D();
     }
-
-    if (get_clear_after_write()) {
-	clear();
-    }
 }
 
 /**
@@ -134,22 +139,9 @@ void t_polargrid::write2D() const {
 */
 void t_polargrid::write2D(const std::string filename) const
 {
-    MPI_File fh;
-    MPI_Status status;
-
     unsigned int count;
     double *from;
 
-    mpi_error_check_file_write(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-					     MPI_MODE_WRONLY | MPI_MODE_CREATE,
-					     MPI_INFO_NULL, &fh),
-			       filename);
-
-    MPI_File_set_view(fh, 0, MPI_DOUBLE, MPI_DOUBLE,
-		      const_cast<char *>("native"), MPI_INFO_NULL);
-    MPI_File_seek(fh, (IMIN + Zero_or_active) * get_size_azimuthal(),
-		  MPI_SEEK_SET);
-
     from = Field;
     count = get_size_radial();
 
@@ -171,12 +163,9 @@ void t_polargrid::write2D(const std::string filename) const
 	count -= CPUOVERLAP;
     }
 
-    // write data from buffer
-    MPI_File_write(fh, from, (count) * (get_size_azimuthal()), MPI_DOUBLE,
-		   &status);
-
-    // close file
-    MPI_File_close(&fh);
+    snapshot_writer::write(filename, from, count * get_size_azimuthal(),
+			   MPI_DOUBLE,
+			   (IMIN + Zero_or_active) * get_size_azimuthal());
 }
 
 /**
@@ -186,8 +175,6 @@ void t_polargrid::write2D(const std::string filename) const
 */
 void t_polargrid::write1D() const
 {
-    MPI_File fh;
-    MPI_Status status;
     unsigned int count, from, number_of_values = 2;
 
     // use Rmed or Rinf depending if this quantity is scalar or vector
@@ -196,21 +183,11 @@ void t_polargrid::write1D() const
     const std::string filename =
 	output::snapshot_dir + "/" + std::string(get_name()) + +"1D" + ".dat";
 
-    // try to open file
-    mpi_error_check_file_write(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-					     MPI_MODE_WRONLY | MPI_MODE_CREATE,
-					     MPI_INFO_NULL, &fh),
-			       filename);
-
     if (m_write_max_max_1D) {
 	// min/max need additional two values
 	number_of_values += 2;
     }
 
-    MPI_File_set_view(fh, 0, MPI_DOUBLE, MPI_DOUBLE,
-		      const_cast<char *>("native"), MPI_INFO_NULL);
-    MPI_File_seek(fh, (IMIN + Zero_or_active) * number_of_values, MPI_SEEK_SET);
-
     from = 0;
     count = get_size_radial();
 
@@ -232,52 +209,35 @@ void t_polargrid::write1D() const
 	count -= CPUOVERLAP;
     }
 
-    double *buffer;
-    buffer = new double[number_of_values * count];
+    std::vector<double> sum(count);
+    std::vector<double> min, max;
+    if (m_write_max_max_1D) {
+	min.resize(count);
+	max.resize(count);
+    }
+    radial_profile::statistics(*this, from, from + count, sum.data(),
+			       m_write_max_max_1D ? min.data() : nullptr,
+			       m_write_max_max_1D ? max.data() : nullptr);
+
+    std::vector<double> buffer(number_of_values * count);
 
     for (unsigned int n_radial = 0; n_radial < count; ++n_radial) {
 	buffer[number_of_values * n_radial] = radius[from + n_radial];
-	buffer[number_of_values * n_radial + 1] = 0;
-
-	for (unsigned int n_azimuthal = 0; n_azimuthal < get_size_azimuthal();
-	     ++n_azimuthal) {
-	    buffer[number_of_values * n_radial + 1] += operator()(
-		from + n_radial, n_azimuthal);
-	}
+	buffer[number_of_values * n_radial + 1] = sum[n_radial];
 
 	if (!get_integrate_azimuthally_for_1D_write()) {
 	    buffer[number_of_values * n_radial + 1] /=
 		(double)get_size_azimuthal();
 	}
-    }
 
-    // if write min/max values, get them!
-    if (m_write_max_max_1D) {
-	for (unsigned int n_radial = 0; n_radial < count; ++n_radial) {
-	    // min
-		buffer[number_of_values * n_radial + 2] = std::numeric_limits<double>::max();
-	    // max
-		buffer[number_of_values * n_radial + 3] = std::numeric_limits<double>::lowest();
-
-	    for (unsigned int n_azimuthal = 0;
-		 n_azimuthal < get_size_azimuthal(); ++n_azimuthal) {
-		buffer[number_of_values * n_radial + 2] =
-		    std::min(buffer[number_of_values * n_radial + 2],
-			     operator()(from + n_radial, n_azimuthal));
-		buffer[number_of_values * n_radial + 3] =
-		    std::max(buffer[number_of_values * n_radial + 3],
-			     operator()(from + n_radial, n_azimuthal));
-	    }
+	if (m_write_max_max_1D) {
+	    buffer[number_of_values * n_radial + 2] = min[n_radial];
+	    buffer[number_of_values * n_radial + 3] = max[n_radial];
 	}
     }
 
-    MPI_File_write_all(fh, buffer, count * number_of_values, MPI_DOUBLE,
-		       &status);
-
-    delete[] buffer;
-
-    // close file
-    MPI_File_close(&fh);
+    snapshot_writer::write(filename, std::move(buffer),
+			   (IMIN + Zero_or_active) * number_of_values);
 }
 
 void t_polargrid::read2D()
@@ -311,7 +271,7 @@ void t_polargrid::read2D(const char *_filename)
 
 
 
-    mpi_error_check_file_read(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
+    mpi_error_check_file_read(MPI_File_open(CPU_Comm, filename.c_str(),
 					    MPI_MODE_RDONLY, MPI_INFO_NULL,
 					    &fh),
 			      filename);
@@ -384,7 +344,7 @@ void t_polargrid::read1D(const char *_filename, bool skip_min_max)
     t_radialarray &radius = is_scalar() ? Rmed : Rinf;
 
     // try to open file
-    mpi_error_check_file_read(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
+    mpi_error_check_file_read(MPI_File_open(CPU_Comm, filename.c_str(),
 					    MPI_MODE_RDONLY, MPI_INFO_NULL,
 					    &fh),
 			      filename);
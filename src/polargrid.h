@@ -89,7 +89,7 @@ class t_polargrid
 
     void clear();
 
-    void write_polargrid(t_data &data);
+    void write_polargrid(t_data &data, const bool write_2D_file = true);
     // 2D read/write
     void write2D() const;
     void write2D(const std::string filename) const;
@@ -10,6 +10,7 @@
 
 #include "constants.h"
 #include "data.h"
+#include "derived_fields.h"
 #include "logging.h"
 #include "parameters.h"
 #include "pvte_law.h"
@@ -496,6 +497,10 @@ double H_dissociation_fraction(const double densityCGS, const double temperature
 
 void compute_gamma_mu(t_data &data)
 {
+    if (derived_fields::up_to_date(derived_fields::field_gamma_mu)) {
+	return;
+    }
+
     /*
 	static bool lookupTablesInitialized = false;
 
@@ -538,6 +543,8 @@ void compute_gamma_mu(t_data &data)
 		data[t_data::GAMMA1](nr, naz) = q.g1;
 	}
     }
+
+    derived_fields::computed(derived_fields::field_gamma_mu);
 }
 
 double get_gamma_eff(t_data &data, const int n_radial, const int n_azimuthal)
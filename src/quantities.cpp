@@ -8,12 +8,14 @@
 #include "frame_of_reference.h"
 #include <math.h>
 #include <mpi.h>
+#include <array>
 #include <vector>
 #include "pvte_law.h"
 #include "simulation.h"
 #include "gas_torques.h"
 #include "viscosity/viscosity.h"
 #include "compute.h"
+#include "reduction.h"
 
 
 namespace quantities
@@ -50,27 +52,11 @@ void fill_alpha_array(t_data &data, unsigned int timestep,
 */
 double gas_total_mass(t_data &data, const double quantitiy_radius)
 {
-    double local_mass = 0.0;
-    double global_mass = 0.0;
+    const t_polargrid &sigma = data[t_data::SIGMA];
 
-    // calculate mass of this process' cells
-	#pragma omp parallel for reduction(+ : local_mass)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::SIGMA].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		local_mass +=
-		    Surf[n_radial] * data[t_data::SIGMA](n_radial, n_azimuthal);
-	    }
-	}
-    }
-
-	MPI_Allreduce(&local_mass, &global_mass, 1, MPI_DOUBLE, MPI_SUM,
-		  MPI_COMM_WORLD);
-
-    return global_mass;
+    return reduction::sum([&](const unsigned int nr, const unsigned int naz) {
+	return Rmed[nr] <= quantitiy_radius ? Surf[nr] * sigma(nr, naz) : 0.0;
+    });
 }
 
 /**
@@ -79,104 +65,57 @@ double gas_total_mass(t_data &data, const double quantitiy_radius)
  */
 double gas_quantity_reduce(const t_polargrid& arr, const double quantitiy_radius)
 {
-
-	double global_reduced_quantity = 0.0;
-	double local_reduced_quantity = 0.0;
-
 	// Loop thru all cells excluding GHOSTCELLS & CPUOVERLAP cells (otherwise
 	// they would be included twice!)
-	#pragma omp parallel for reduction(+ : local_reduced_quantity)
-	for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
-	for (unsigned int naz = 0; naz < arr.get_size_azimuthal(); ++naz) {
-		// eccentricity and semi major axis weighted with cellmass
-		if (Rmed[nr] <= quantitiy_radius) {
-		local_reduced_quantity += arr(nr, naz) ;
-		}
-	}
-	}
-
-	// synchronize threads
-	MPI_Reduce(&local_reduced_quantity, &global_reduced_quantity, 1, MPI_DOUBLE, MPI_SUM, 0,
-		  MPI_COMM_WORLD);
-
-	return global_reduced_quantity;
+	return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+		return Rmed[nr] <= quantitiy_radius ? arr(nr, naz) : 0.0;
+	},
+	false);
 }
 
 
 
-double gas_allreduce_mass_average(t_data &data, const t_polargrid& arr, const double quantitiy_radius)
+/**
+	sums of cell mass and of arr weighted with cell mass, used for the mass
+	averages below
+*/
+static std::array<double, 2> gas_mass_weighted_sums(t_data &data, const t_polargrid& arr, const double quantitiy_radius, const bool to_all)
 {
-
 	const t_polargrid& sigma = data[t_data::SIGMA];
 
-	double local_mass = 0.0;
-	double global_mass = 0.0;
-
-	double global_reduced_quantity = 0.0;
-	double local_reduced_quantity = 0.0;
-
 	// Loop thru all cells excluding GHOSTCELLS & CPUOVERLAP cells (otherwise
 	// they would be included twice!)
-	#pragma omp parallel for reduction(+ : local_reduced_quantity, local_mass)
-	for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
-	for (unsigned int naz = 0; naz < arr.get_size_azimuthal(); ++naz) {
+	return reduction::sum_array<2>(
+	[&](const unsigned int nr, const unsigned int naz,
+		std::array<double, 2> &sums) {
 		// eccentricity and semi major axis weighted with cellmass
 		if (Rmed[nr] <= quantitiy_radius) {
 		const double cell_mass = sigma(nr, naz) * Surf[nr];
-		local_mass += cell_mass;
-		local_reduced_quantity += arr(nr, naz) * cell_mass;
+		sums[0] += cell_mass;
+		sums[1] += arr(nr, naz) * cell_mass;
 		}
-	}
-	}
-
-	MPI_Allreduce(&local_mass, &global_mass, 1, MPI_DOUBLE, MPI_SUM,
-		  MPI_COMM_WORLD);
-
-	// synchronize threads
-	MPI_Allreduce(&local_reduced_quantity, &global_reduced_quantity, 1, MPI_DOUBLE, MPI_SUM,
-		  MPI_COMM_WORLD);
+	},
+	to_all);
+}
 
-	global_reduced_quantity /= global_mass;
-	return global_reduced_quantity;
+double gas_allreduce_mass_average(t_data &data, const t_polargrid& arr, const double quantitiy_radius)
+{
+	const std::array<double, 2> sums =
+	gas_mass_weighted_sums(data, arr, quantitiy_radius, true);
 
+	return sums[1] / sums[0];
 }
 
 
 double gas_reduce_mass_average(t_data &data, const t_polargrid& arr, const double quantitiy_radius)
 {
+	const std::array<double, 2> sums =
+	gas_mass_weighted_sums(data, arr, quantitiy_radius, false);
 
-	const t_polargrid& sigma = data[t_data::SIGMA];
-
-	double local_mass = 0.0;
-	double global_mass = 0.0;
-
-	double local_reduced_quantity = 0.0;
-	double global_reduced_quantity = 0.0;
-
-	// Loop thru all cells excluding GHOSTCELLS & CPUOVERLAP cells (otherwise
-	// they would be included twice!)
-	#pragma omp parallel for reduction(+ : local_reduced_quantity, local_mass)
-	for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
-	for (unsigned int naz = 0; naz < arr.get_size_azimuthal(); ++naz) {
-		// eccentricity and semi major axis weighted with cellmass
-		if (Rmed[nr] <= quantitiy_radius) {
-		const double cell_mass = sigma(nr, naz) * Surf[nr];
-		local_mass += cell_mass;
-		local_reduced_quantity += arr(nr, naz) * cell_mass;
-		}
-	}
-	}
-
-	MPI_Reduce(&local_mass, &global_mass, 1, MPI_DOUBLE, MPI_SUM, 0,
-		  MPI_COMM_WORLD);
-
-	// synchronize threads
-	MPI_Reduce(&local_reduced_quantity, &global_reduced_quantity, 1, MPI_DOUBLE, MPI_SUM,
-		  0, MPI_COMM_WORLD);
-
+	const double global_mass = sums[0];
 	if(CPU_Master && global_mass > 0.0){
-	global_reduced_quantity /= global_mass;
-	return global_reduced_quantity;
+	return sums[1] / global_mass;
 	} else {
 		return 0.0;
 	}
@@ -193,9 +132,9 @@ double gas_disk_radius(t_data &data, const double total_mass)
 
     const unsigned int local_array_start = Zero_or_active;
     const unsigned int local_array_end = Max_or_active;
-	static const unsigned int send_size = local_array_end - local_array_start;
+	const unsigned int send_size = local_array_end - local_array_start;
 
-	static std::vector<double> local_mass(send_size);
+	std::vector<double> local_mass(send_size);
 
 	#pragma omp parallel for
     for (unsigned int n_radial = local_array_start; n_radial < local_array_end;
@@ -214,7 +153,7 @@ double gas_disk_radius(t_data &data, const double total_mass)
 
     MPI_Gatherv(&local_mass[0], send_size, MPI_DOUBLE, GLOBAL_bufarray,
 		RootNradialLocalSizes, RootNradialDisplacements, MPI_DOUBLE, 0,
-		MPI_COMM_WORLD);
+		CPU_Comm);
 
     if (CPU_Master) {
 	int j = 0;
@@ -241,38 +180,22 @@ double gas_disk_radius(t_data &data, const double total_mass)
 */
 double gas_angular_momentum(t_data &data, const double quantitiy_radius)
 {
-    double local_angular_momentum = 0.0;
-    double global_angular_momentum = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_angular_momentum)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::SIGMA].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		local_angular_momentum +=
-		    Surf[n_radial] * 0.5 *
-		    (data[t_data::SIGMA](n_radial, n_azimuthal) +
-		     data[t_data::SIGMA](
-			 n_radial, n_azimuthal == 0
-				       ? data[t_data::SIGMA].get_max_azimuthal()
-				       : n_azimuthal - 1)) *
-		    Rmed[n_radial] *
-		    (data[t_data::V_AZIMUTHAL](n_radial, n_azimuthal) +
-		     refframe::OmegaFrame * Rmed[n_radial]);
-	    }
-	    // local_angular_momentum +=
-	    // Surf[n_radial]*data[t_data::DENSITY](n_radial,n_azimuthal)*Rmed[n_radial]*(0.5*(data[t_data::V_AZIMUTHAL](n_radial,n_azimuthal)+data[t_data::V_AZIMUTHAL](n_radial,n_azimuthal
-	    // == data[t_data::V_AZIMUTHAL].get_max_azimuthal() ? 0 :
-	    // n_azimuthal+1))+frame_of_reference::OmegaFrame*Rmed[n_radial]);
-	}
-    }
-
-    MPI_Allreduce(&local_angular_momentum, &global_angular_momentum, 1,
-		  MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
-
-    return global_angular_momentum;
+    const t_polargrid &sigma = data[t_data::SIGMA];
+    const t_polargrid &vazi = data[t_data::V_AZIMUTHAL];
+
+    return reduction::sum([&](const unsigned int n_radial,
+			      const unsigned int n_azimuthal) {
+	if (Rmed[n_radial] > quantitiy_radius) {
+	    return 0.0;
+	}
+	return Surf[n_radial] * 0.5 *
+	       (sigma(n_radial, n_azimuthal) +
+		sigma(n_radial, n_azimuthal == 0 ? sigma.get_max_azimuthal()
+						 : n_azimuthal - 1)) *
+	       Rmed[n_radial] *
+	       (vazi(n_radial, n_azimuthal) +
+		refframe::OmegaFrame * Rmed[n_radial]);
+    });
 }
 
 /**
@@ -280,75 +203,63 @@ double gas_angular_momentum(t_data &data, const double quantitiy_radius)
 */
 double gas_internal_energy(t_data &data, const double quantitiy_radius)
 {
-    double local_internal_energy = 0.0;
-    double global_internal_energy = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_internal_energy)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::ENERGY].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		local_internal_energy +=
-		    Surf[n_radial] *
-		    data[t_data::ENERGY](n_radial, n_azimuthal);
-	    }
-	}
-    }
-
-    MPI_Reduce(&local_internal_energy, &global_internal_energy, 1, MPI_DOUBLE,
-	       MPI_SUM, 0, MPI_COMM_WORLD);
-
-    return global_internal_energy;
+    const t_polargrid &quantity = data[t_data::ENERGY];
+
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    return Rmed[nr] <= quantitiy_radius ? Surf[nr] * quantity(nr, naz)
+						: 0.0;
+	},
+	false);
 }
 
 double gas_viscous_dissipation(t_data &data, const double quantitiy_radius)
 {
-    double local_qplus = 0.0;
-    double global_qplus = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_qplus)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::QPLUS].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		local_qplus +=
-		    Surf[n_radial] * data[t_data::QPLUS](n_radial, n_azimuthal);
-	    }
-	}
-    }
-
-    MPI_Reduce(&local_qplus, &global_qplus, 1, MPI_DOUBLE, MPI_SUM, 0,
-	       MPI_COMM_WORLD);
-
-    return global_qplus;
+    const t_polargrid &quantity = data[t_data::QPLUS];
+
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    return Rmed[nr] <= quantitiy_radius ? Surf[nr] * quantity(nr, naz)
+						: 0.0;
+	},
+	false);
 }
 
 double gas_luminosity(t_data &data, const double quantitiy_radius)
 {
-    double local_qminus = 0.0;
-    double global_qminus = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_qminus)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::QMINUS].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		local_qminus += Surf[n_radial] *
-				data[t_data::QMINUS](n_radial, n_azimuthal);
-	    }
-	}
-    }
+    const t_polargrid &quantity = data[t_data::QMINUS];
+
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    return Rmed[nr] <= quantitiy_radius ? Surf[nr] * quantity(nr, naz)
+						: 0.0;
+	},
+	false);
+}
 
-    MPI_Reduce(&local_qminus, &global_qminus, 1, MPI_DOUBLE, MPI_SUM, 0,
-	       MPI_COMM_WORLD);
+/**
+	radial velocity interpolated to the cell center
+*/
+static inline double cell_center_v_radial(t_data &data, const unsigned int nr,
+					  const unsigned int naz)
+{
+    const double v_radial_center =
+	(Rmed[nr] - Rinf[nr]) * data[t_data::V_RADIAL](nr + 1, naz) +
+	(Rsup[nr] - Rmed[nr]) * data[t_data::V_RADIAL](nr, naz);
+    return v_radial_center / (Rsup[nr] - Rinf[nr]);
+}
 
-    return global_qminus;
+/**
+	azimuthal velocity interpolated to the cell center in the inertial frame
+*/
+static inline double cell_center_v_azimuthal(t_data &data,
+					     const unsigned int nr,
+					     const unsigned int naz)
+{
+    const t_polargrid &vazi = data[t_data::V_AZIMUTHAL];
+    return 0.5 * (vazi(nr, naz) +
+		  vazi(nr, naz == vazi.get_max_azimuthal() ? 0 : naz + 1)) +
+	   Rmed[nr] * refframe::OmegaFrame;
 }
 
 /**
@@ -356,48 +267,20 @@ double gas_luminosity(t_data &data, const double quantitiy_radius)
 */
 double gas_kinematic_energy(t_data &data, const double quantitiy_radius)
 {
-    double local_kinematic_energy = 0.0;
-    double global_kinematic_energy = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_kinematic_energy)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::SIGMA].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    // centered-in-cell radial velocity
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		double v_radial_center =
-		    (Rmed[n_radial] - Rinf[n_radial]) *
-			data[t_data::V_RADIAL](n_radial + 1, n_azimuthal) +
-		    (Rsup[n_radial] - Rmed[n_radial]) *
-			data[t_data::V_RADIAL](n_radial, n_azimuthal);
-		v_radial_center /= (Rsup[n_radial] - Rinf[n_radial]);
-
-		// centered-in-cell azimuthal velocity
-		double v_azimuthal_center =
-		    0.5 *
-			(data[t_data::V_AZIMUTHAL](n_radial, n_azimuthal) +
-			 data[t_data::V_AZIMUTHAL](
-			     n_radial, n_azimuthal == data[t_data::V_AZIMUTHAL]
-							  .get_max_azimuthal()
-					   ? 0
-					   : n_azimuthal + 1)) +
-		    Rmed[n_radial] * refframe::OmegaFrame;
-
-		local_kinematic_energy +=
-		    0.5 * Surf[n_radial] *
-		    data[t_data::SIGMA](n_radial, n_azimuthal) *
-		    (std::pow(v_radial_center, 2) +
-		     std::pow(v_azimuthal_center, 2));
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    if (Rmed[nr] > quantitiy_radius) {
+		return 0.0;
 	    }
-	}
-    }
-
-    MPI_Reduce(&local_kinematic_energy, &global_kinematic_energy, 1, MPI_DOUBLE,
-	       MPI_SUM, 0, MPI_COMM_WORLD);
-
-    return global_kinematic_energy;
+	    const double v_radial_center = cell_center_v_radial(data, nr, naz);
+	    const double v_azimuthal_center =
+		cell_center_v_azimuthal(data, nr, naz);
+
+	    return 0.5 * Surf[nr] * data[t_data::SIGMA](nr, naz) *
+		   (std::pow(v_radial_center, 2) +
+		    std::pow(v_azimuthal_center, 2));
+	},
+	false);
 }
 
 /**
@@ -405,36 +288,17 @@ double gas_kinematic_energy(t_data &data, const double quantitiy_radius)
 */
 double gas_radial_kinematic_energy(t_data &data, const double quantitiy_radius)
 {
-    double local_kinematic_energy = 0.0;
-    double global_kinematic_energy = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_kinematic_energy)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::SIGMA].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		// centered-in-cell radial velocity
-		double v_radial_center =
-		    (Rmed[n_radial] - Rinf[n_radial]) *
-			data[t_data::V_RADIAL](n_radial + 1, n_azimuthal) +
-		    (Rsup[n_radial] - Rmed[n_radial]) *
-			data[t_data::V_RADIAL](n_radial, n_azimuthal);
-		v_radial_center /= (Rsup[n_radial] - Rinf[n_radial]);
-
-		local_kinematic_energy +=
-		    0.5 * Surf[n_radial] *
-		    data[t_data::SIGMA](n_radial, n_azimuthal) *
-		    std::pow(v_radial_center, 2);
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    if (Rmed[nr] > quantitiy_radius) {
+		return 0.0;
 	    }
-	}
-    }
+	    const double v_radial_center = cell_center_v_radial(data, nr, naz);
 
-    MPI_Reduce(&local_kinematic_energy, &global_kinematic_energy, 1, MPI_DOUBLE,
-	       MPI_SUM, 0, MPI_COMM_WORLD);
-
-    return global_kinematic_energy;
+	    return 0.5 * Surf[nr] * data[t_data::SIGMA](nr, naz) *
+		   std::pow(v_radial_center, 2);
+	},
+	false);
 }
 
 /**
@@ -443,39 +307,18 @@ double gas_radial_kinematic_energy(t_data &data, const double quantitiy_radius)
 double gas_azimuthal_kinematic_energy(t_data &data,
 				      const double quantitiy_radius)
 {
-    double local_kinematic_energy = 0.0;
-    double global_kinematic_energy = 0.0;
-
-	#pragma omp parallel for reduction(+ : local_kinematic_energy)
-    for (unsigned int n_radial = radial_first_active;
-	 n_radial < radial_active_size; ++n_radial) {
-	for (unsigned int n_azimuthal = 0;
-	     n_azimuthal < data[t_data::SIGMA].get_size_azimuthal();
-	     ++n_azimuthal) {
-	    if (Rmed[n_radial] <= quantitiy_radius) {
-		// centered-in-cell azimuthal velocity
-		double v_azimuthal_center =
-		    0.5 *
-			(data[t_data::V_AZIMUTHAL](n_radial, n_azimuthal) +
-			 data[t_data::V_AZIMUTHAL](
-			     n_radial, n_azimuthal == data[t_data::V_AZIMUTHAL]
-							  .get_max_azimuthal()
-					   ? 0
-					   : n_azimuthal + 1)) +
-		    Rmed[n_radial] * refframe::OmegaFrame;
-
-		local_kinematic_energy +=
-		    0.5 * Surf[n_radial] *
-		    data[t_data::SIGMA](n_radial, n_azimuthal) *
-		    std::pow(v_azimuthal_center, 2);
+    return reduction::sum(
+	[&](const unsigned int nr, const unsigned int naz) {
+	    if (Rmed[nr] > quantitiy_radius) {
+		return 0.0;
 	    }
-	}
-    }
-
-    MPI_Reduce(&local_kinematic_energy, &global_kinematic_energy, 1, MPI_DOUBLE,
-	       MPI_SUM, 0, MPI_COMM_WORLD);
+	    const double v_azimuthal_center =
+		cell_center_v_azimuthal(data, nr, naz);
 
-    return global_kinematic_energy;
+	    return 0.5 * Surf[nr] * data[t_data::SIGMA](nr, naz) *
+		   std::pow(v_azimuthal_center, 2);
+	},
+	false);
 }
 
 void calculate_disk_ecc_vector(t_data &data, unsigned int timestep,
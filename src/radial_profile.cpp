@@ -0,0 +1,170 @@
+/**
+	\file radial_profile.cpp
+
+	Azimuthal reductions of polargrids and their assembly into global radial
+	profiles.
+
+	Every process reduces its active rings [Zero_or_active, Max_or_active)
+	in one threaded pass. The global profile is put together with a single
+	MPI_Allgatherv, so its cost does not grow with the number of processes
+	as a chain of sends from one process to the next does.
+*/
+
+#include "radial_profile.h"
+#include "LowTasks.h"
+#include "global.h"
+#include <algorithm>
+#include <limits>
+#include <mpi.h>
+
+namespace radial_profile
+{
+
+// number of active rings and their global position for every process
+static std::vector<int> counts;
+static std::vector<int> displacements;
+static unsigned int layout_global_n_radial = 0;
+
+/**
+	Reduce the rings [first, end) of grid over the azimuth. profile[i] is
+	the value of ring first + i.
+*/
+void reduce(const t_polargrid &grid, const t_reduction reduction,
+	    const unsigned int first, const unsigned int end, double *profile,
+	    const t_polargrid *weight)
+{
+    const unsigned int Nsec = grid.get_size_azimuthal();
+
+    if (reduction == reduction_weighted_mean && weight == nullptr) {
+	die("A weighted radial profile of %s needs a weight grid!\n",
+	    grid.get_name());
+    }
+
+    #pragma omp parallel for
+    for (unsigned int nr = first; nr < end; ++nr) {
+	double value;
+	switch (reduction) {
+	case reduction_min:
+	    value = std::numeric_limits<double>::max();
+	    for (unsigned int naz = 0; naz < Nsec; ++naz) {
+		value = std::min(value, grid(nr, naz));
+	    }
+	    break;
+	case reduction_max:
+	    value = std::numeric_limits<double>::lowest();
+	    for (unsigned int naz = 0; naz < Nsec; ++naz) {
+		value = std::max(value, grid(nr, naz));
+	    }
+	    break;
+	case reduction_weighted_mean: {
+	    double sum = 0.0;
+	    double weight_sum = 0.0;
+	    for (unsigned int naz = 0; naz < Nsec; ++naz) {
+		sum += (*weight)(nr, naz) * grid(nr, naz);
+		weight_sum += (*weight)(nr, naz);
+	    }
+	    value = weight_sum > 0.0 ? sum / weight_sum : 0.0;
+	    break;
+	}
+	default:
+	    value = 0.0;
+	    for (unsigned int naz = 0; naz < Nsec; ++naz) {
+		value += grid(nr, naz);
+	    }
+	    if (reduction == reduction_mean) {
+		value /= (double)Nsec;
+	    }
+	}
+	profile[nr - first] = value;
+    }
+}
+
+/**
+	Sum, minimum and maximum of the rings [first, end) of grid in a single
+	pass. Outputs that are null are not computed.
+*/
+void statistics(const t_polargrid &grid, const unsigned int first,
+		const unsigned int end, double *sum, double *min, double *max)
+{
+    const unsigned int Nsec = grid.get_size_azimuthal();
+
+    #pragma omp parallel for
+    for (unsigned int nr = first; nr < end; ++nr) {
+	double s = 0.0;
+	double lo = std::numeric_limits<double>::max();
+	double hi = std::numeric_limits<double>::lowest();
+	for (unsigned int naz = 0; naz < Nsec; ++naz) {
+	    const double value = grid(nr, naz);
+	    s += value;
+	    lo = std::min(lo, value);
+	    hi = std::max(hi, value);
+	}
+	if (sum != nullptr) {
+	    sum[nr - first] = s;
+	}
+	if (min != nullptr) {
+	    min[nr - first] = lo;
+	}
+	if (max != nullptr) {
+	    max[nr - first] = hi;
+	}
+    }
+}
+
+static void update_layout()
+{
+    if (layout_global_n_radial == GlobalNRadial) {
+	return;
+    }
+
+    const int local[2] = {(int)(Max_or_active - Zero_or_active),
+			  (int)(IMIN + Zero_or_active)};
+    std::vector<int> all(2 * CPU_Number);
+    MPI_Allgather(local, 2, MPI_INT, all.data(), 2, MPI_INT, CPU_Comm);
+
+    counts.resize(CPU_Number);
+    displacements.resize(CPU_Number);
+    for (int rank = 0; rank < CPU_Number; ++rank) {
+	counts[rank] = all[2 * rank];
+	displacements[rank] = all[2 * rank + 1];
+    }
+    layout_global_n_radial = GlobalNRadial;
+}
+
+/**
+	Assemble a global profile (GlobalNRadial values) on all processes.
+	local_profile holds the values of the local rings, indexed by the local
+	ring number; only the active rings are used.
+*/
+void gather(const double *local_profile, double *global_profile)
+{
+    update_layout();
+
+    MPI_Allgatherv(&local_profile[Zero_or_active],
+		   Max_or_active - Zero_or_active, MPI_DOUBLE, global_profile,
+		   counts.data(), displacements.data(), MPI_DOUBLE, CPU_Comm);
+}
+
+/**
+	Global profile of grid on all processes. Collective.
+*/
+std::vector<double> get(const t_polargrid &grid, const t_reduction reduction,
+			const t_polargrid *weight)
+{
+    std::vector<double> local(NRadial);
+    reduce(grid, reduction, Zero_or_active, Max_or_active,
+	   &local[Zero_or_active], weight);
+
+    std::vector<double> values(GlobalNRadial);
+    gather(local.data(), values.data());
+
+    return values;
+}
+
+/**
+	Forget the ring layout of the processes after the domain decomposition
+	was changed.
+*/
+void update_domain() { layout_global_n_radial = 0; }
+
+} // namespace radial_profile
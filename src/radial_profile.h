@@ -0,0 +1,32 @@
+#pragma once
+
+#include "polargrid.h"
+#include <vector>
+
+// Azimuthal reductions of polargrids and their assembly into global radial
+// profiles.
+
+namespace radial_profile
+{
+
+enum t_reduction {
+    reduction_mean, // arithmetic mean over the ring
+    reduction_sum,  // sum over the ring
+    reduction_min,
+    reduction_max,
+    reduction_weighted_mean // mean weighted with a second grid, e.g. Sigma
+};
+
+void reduce(const t_polargrid &grid, const t_reduction reduction,
+	    const unsigned int first, const unsigned int end, double *profile,
+	    const t_polargrid *weight = nullptr);
+void statistics(const t_polargrid &grid, const unsigned int first,
+		const unsigned int end, double *sum, double *min, double *max);
+
+void gather(const double *local_profile, double *global_profile);
+
+std::vector<double> get(const t_polargrid &grid, const t_reduction reduction,
+			const t_polargrid *weight = nullptr);
+void update_domain();
+
+} // namespace radial_profile
@@ -7,6 +7,7 @@
 */
 
 #include "radialarray.h"
+#include "allocation.h"
 #include <stdlib.h>
 
 t_radialarray::t_radialarray()
@@ -19,13 +20,10 @@ t_radialarray::t_radialarray(ptrdiff_t size)
 {
     // assign memory
     m_size = size;
-    array = new double[m_size];
-
-    // set to 0
-    clear();
+    array = allocation::allocate_array(m_size);
 }
 
-t_radialarray::~t_radialarray() { delete[] array; }
+t_radialarray::~t_radialarray() { allocation::deallocate(array); }
 
 /**
 	set all entries to 0
@@ -43,12 +41,9 @@ void t_radialarray::clear()
 void t_radialarray::resize(ptrdiff_t size)
 {
     // delete old data
-    delete[] array;
+    allocation::deallocate(array);
 
-    // assign new memory
+    // assign new memory, set to 0 by the allocator
     m_size = size;
-    array = new double[m_size];
-
-    // set to 0
-    clear();
+    array = allocation::allocate_array(m_size);
 }
@@ -4,6 +4,7 @@
 
 #include <mpi.h>
 #include <sstream>
+#include <vector>
 
 #include "LowTasks.h"
 #include "constants.h"
@@ -14,6 +15,7 @@
 #include "polargrid.h"
 #include "radialarray.h"
 #include "radialgrid.h"
+#include "snapshot_writer.h"
 
 #ifndef DISABLE_GSL
 #include <gsl/gsl_spline.h>
@@ -148,11 +150,7 @@ void t_radialgrid::write1D() const
 
 void t_radialgrid::write1D(std::string filename, bool one_file) const
 {
-    MPI_File fh;
-    MPI_Status status;
-    int error;
     unsigned int count, from, number_of_values = 2;
-    double *buffer;
 
     // use Rmed or Rinf depending if this quantity is scalar or vector
     t_radialarray &radius = is_scalar() ? Rmed : Rinf;
@@ -161,37 +159,7 @@ void t_radialgrid::write1D(std::string filename, bool one_file) const
     if (one_file) {
 	number_of_values = 1;
     }
-    // try to open file
-    if (one_file) {
-	// append to existing file for consecutive output of arrays
-	error = MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-			      MPI_MODE_WRONLY | MPI_MODE_APPEND, MPI_INFO_NULL,
-			      &fh);
-	// if file doesn't exist yet, create it
-	if (error != MPI_SUCCESS) {
-	    error = MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-				  MPI_MODE_WRONLY | MPI_MODE_CREATE,
-				  MPI_INFO_NULL, &fh);
-	}
-
-    } else {
-	// make a new file for each output
-	error = MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
-			      MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL,
-			      &fh);
-    }
-    mpi_error_check_file_write(error, filename);
 
-    // Move file pointer to correct position
-    MPI_File_set_view(fh, 0, MPI_DOUBLE, MPI_DOUBLE,
-		      const_cast<char *>("native"), MPI_INFO_NULL);
-    if (one_file) {
-	MPI_File_seek(fh, (IMIN + Zero_or_active) * number_of_values,
-		      MPI_SEEK_END | MPI_SEEK_SET);
-    } else {
-	MPI_File_seek(fh, (IMIN + Zero_or_active) * number_of_values,
-		      MPI_SEEK_SET);
-    }
     from = 0;
     count = get_size_radial();
 
@@ -213,7 +181,7 @@ void t_radialgrid::write1D(std::string filename, bool one_file) const
 	count -= CPUOVERLAP;
     }
 
-    buffer = new double[number_of_values * count];
+    std::vector<double> buffer(number_of_values * count);
 
     if (one_file) {
 	for (unsigned int n_radial = 0; n_radial < count; ++n_radial) {
@@ -227,10 +195,35 @@ void t_radialgrid::write1D(std::string filename, bool one_file) const
 	}
     }
 
-    MPI_File_write_all(fh, buffer, count * number_of_values, MPI_DOUBLE,
-		       &status);
+    if (!one_file) {
+	// make a new file for each output, queued if inside a batch
+	snapshot_writer::write(filename, std::move(buffer),
+			       (IMIN + Zero_or_active) * number_of_values);
+	return;
+    }
 
-    delete[] buffer;
+    // append to existing file for consecutive output of arrays
+    MPI_File fh;
+    MPI_Status status;
+    int error = MPI_File_open(CPU_Comm, filename.c_str(),
+			      MPI_MODE_WRONLY | MPI_MODE_APPEND,
+			      snapshot_writer::get_info(), &fh);
+    // if file doesn't exist yet, create it
+    if (error != MPI_SUCCESS) {
+	error = MPI_File_open(CPU_Comm, filename.c_str(),
+			      MPI_MODE_WRONLY | MPI_MODE_CREATE,
+			      snapshot_writer::get_info(), &fh);
+    }
+    mpi_error_check_file_write(error, filename);
+
+    // Move file pointer to correct position
+    MPI_File_set_view(fh, 0, MPI_DOUBLE, MPI_DOUBLE,
+		      const_cast<char *>("native"), snapshot_writer::get_info());
+    MPI_File_seek(fh, (IMIN + Zero_or_active) * number_of_values,
+		  MPI_SEEK_END | MPI_SEEK_SET);
+
+    MPI_File_write_all(fh, buffer.data(), count * number_of_values, MPI_DOUBLE,
+		       &status);
 
     // close file
     MPI_File_close(&fh);
@@ -265,7 +258,7 @@ void t_radialgrid::read1D(const char *_filename)
     t_radialarray &radius = is_scalar() ? Rmed : Rinf;
 
     // try to open file
-    mpi_error_check_file_read(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
+    mpi_error_check_file_read(MPI_File_open(CPU_Comm, filename.c_str(),
 					    MPI_MODE_RDONLY, MPI_INFO_NULL,
 					    &fh),
 			      filename);
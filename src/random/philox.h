@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+Philox4x32-10 counter based random number generator.
+
+Salmon et al. 2011, "Parallel random numbers: as easy as 1, 2, 3"
+(DOI:10.1145/2063384.2063405).
+
+The generator has no state: the output is a bijective function of a 128 bit
+counter and a 64 bit key. Numbers drawn for the same (counter, key) pair are
+the same regardless of thread, process or call order.
+*/
+
+namespace philox
+{
+
+static const uint32_t M0 = 0xD2511F53;
+static const uint32_t M1 = 0xCD9E8D57;
+static const uint32_t W0 = 0x9E3779B9;
+static const uint32_t W1 = 0xBB67AE85;
+
+inline void single_round(uint32_t ctr[4], const uint32_t key[2])
+{
+    const uint64_t p0 = (uint64_t)M0 * ctr[0];
+    const uint64_t p1 = (uint64_t)M1 * ctr[2];
+    const uint32_t hi0 = (uint32_t)(p0 >> 32);
+    const uint32_t lo0 = (uint32_t)p0;
+    const uint32_t hi1 = (uint32_t)(p1 >> 32);
+    const uint32_t lo1 = (uint32_t)p1;
+
+    ctr[0] = hi1 ^ ctr[1] ^ key[0];
+    ctr[1] = lo1;
+    ctr[2] = hi0 ^ ctr[3] ^ key[1];
+    ctr[3] = lo0;
+}
+
+/* Encrypt ctr in place with ten rounds. */
+inline void philox4x32(uint32_t ctr[4], const uint32_t key_in[2])
+{
+    uint32_t key[2] = {key_in[0], key_in[1]};
+    for (unsigned int i = 0; i < 9; ++i) {
+	single_round(ctr, key);
+	key[0] += W0;
+	key[1] += W1;
+    }
+    single_round(ctr, key);
+}
+
+/* Map 64 random bits to a double in [0, 1). */
+inline double to_uniform(const uint32_t hi, const uint32_t lo)
+{
+    const uint64_t x = ((uint64_t)hi << 32) | lo;
+    return (double)(x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Map 64 random bits to a double in (0, 1), safe to pass to log(). */
+inline double to_uniform_open(const uint32_t hi, const uint32_t lo)
+{
+    const uint64_t x = ((uint64_t)hi << 32) | lo;
+    return ((double)(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace philox
@@ -2,28 +2,37 @@
 #include "../logging.h"
 #include "../global.h"
 #include "../parameters.h"
+#include "philox.h"
 
 #ifdef _OPENMP
 #include <omp.h>
 #else
 #pragma message "Your compiler does not support OpenMP, at least with the flags you're using."
 #endif
+#include <cmath>
 #include <random>
 #include <vector>
 
 namespace fargo_random
 {
 
-// distribution functions are not necessarily threat safe, so each threat gets their own
-std::vector<cxx::ziggurat_normal_distribution<double>> std_normal_dists;
-std::vector<std::uniform_real_distribution<double>> uniform_one_dists;
-std::vector<std::uniform_real_distribution<double>> uniform_two_pi_dists;
-std::vector<std::uniform_real_distribution<double>> dust_eccentricity_dists;
-std::vector<std::uniform_int_distribution<int>> uniform256_dists;
-
-std::vector<jsf64> gen_jsfs;
+// distribution functions are not necessarily threat safe, so each threat gets their own.
+// The state of each thread lives in its own cache lines to avoid false sharing.
+struct alignas(64) t_thread_rng {
+    jsf64 gen;
+    cxx::ziggurat_normal_distribution<double> std_normal;
+    std::uniform_real_distribution<double> uniform_one;
+    std::uniform_real_distribution<double> uniform_two_pi;
+    std::uniform_real_distribution<double> dust_eccentricity;
+    std::uniform_int_distribution<int> uniform256;
+};
+
+static std::vector<t_thread_rng> thread_rngs;
 uint64_t a_seed[4];
 
+// first key word of the counter based generator, the second one is the stream
+static uint32_t counter_seed = 0;
+
 static unsigned int get_number_required_rngs() {
     /* Return the number of required rngs per mpi process.
     Each openmp threads needs its own rngs because the used ones are not thread safe.
@@ -42,17 +51,19 @@ void init() {
     const unsigned int Nrngs = get_number_required_rngs();
     logging::print_master(LOG_INFO "Initializing %d RNGs per MPI process.\n", Nrngs);
 
+    counter_seed = (uint32_t)parameters::random_seed;
+
     for (unsigned int n=0; n<Nrngs; n++) {
 	seed(n + CPU_Rank * parameters::random_seed);
-	gen_jsfs.emplace_back(jsf64(a_seed[0]));
-	uniform_one_dists.emplace_back(std::uniform_real_distribution<double>(0.0, 1.0));
-	std_normal_dists.emplace_back(cxx::ziggurat_normal_distribution<double>());
-	uniform_two_pi_dists.emplace_back(std::uniform_real_distribution<double>(0.0, 2.0*M_PI));
-
-	 // random number distribution inclusive, returns r in [0,255]
-	uniform256_dists.emplace_back(std::uniform_int_distribution<int>(0, 255));
-	// for generating dust particle eccentricities, same as Marzari & Scholl 2000
-	dust_eccentricity_dists.emplace_back(std::uniform_real_distribution<double> (0.0, parameters::particle_eccentricity));
+	thread_rngs.push_back(t_thread_rng{
+	    jsf64(a_seed[0]),
+	    cxx::ziggurat_normal_distribution<double>(),
+	    std::uniform_real_distribution<double>(0.0, 1.0),
+	    std::uniform_real_distribution<double>(0.0, 2.0*M_PI),
+	    // for generating dust particle eccentricities, same as Marzari & Scholl 2000
+	    std::uniform_real_distribution<double> (0.0, parameters::particle_eccentricity),
+	    // random number distribution inclusive, returns r in [0,255]
+	    std::uniform_int_distribution<int>(0, 255)});
 
     }
 
@@ -83,23 +94,60 @@ static unsigned int thread_num() {
 
 double get_std_normal() {
     const unsigned int n = thread_num();
-    return std_normal_dists[n](gen_jsfs[n]); 
+    return thread_rngs[n].std_normal(thread_rngs[n].gen); 
 }
 double get_uniform_one() {
     const unsigned int n = thread_num();
-    return uniform_one_dists[n](gen_jsfs[n]);
+    return thread_rngs[n].uniform_one(thread_rngs[n].gen);
 }
 double get_uniform_two_pi() {
     const unsigned int n = thread_num();
-    return uniform_two_pi_dists[n](gen_jsfs[n]);
+    return thread_rngs[n].uniform_two_pi(thread_rngs[n].gen);
 }
 int get_uniform256() {
     const unsigned int n = thread_num();
-    return uniform256_dists[n](gen_jsfs[n]);
+    return thread_rngs[n].uniform256(thread_rngs[n].gen);
 }
 double get_uniform_dust_eccentricity() {
     const unsigned int n = thread_num();
-    return dust_eccentricity_dists[n](gen_jsfs[n]);
+    return thread_rngs[n].dust_eccentricity(thread_rngs[n].gen);
+}
+
+static inline void draw(const uint32_t stream, const uint64_t id,
+			const uint64_t counter, uint32_t bits[4])
+{
+    const uint32_t key[2] = {counter_seed, stream};
+    bits[0] = (uint32_t)id;
+    bits[1] = (uint32_t)(id >> 32);
+    bits[2] = (uint32_t)counter;
+    bits[3] = (uint32_t)(counter >> 32);
+    philox::philox4x32(bits, key);
+}
+
+/* Two uniform numbers in [0, 1) from one block of the generator. */
+void get_uniform_pair(const t_stream stream, const uint64_t id,
+		      const uint64_t counter, double &u1, double &u2)
+{
+    uint32_t bits[4];
+    draw(stream, id, counter, bits);
+    u1 = philox::to_uniform(bits[0], bits[1]);
+    u2 = philox::to_uniform(bits[2], bits[3]);
+}
+
+/* Standard normal numbers for a batch of ids with the Box-Muller transform.
+The loop has no dependencies between ids and is vectorized.
+*/
+void get_std_normals(const t_stream stream, const uint64_t counter,
+		     const uint64_t *ids, const unsigned int n, double *normals)
+{
+    #pragma omp simd
+    for (unsigned int i = 0; i < n; ++i) {
+	uint32_t bits[4];
+	draw(stream, ids[i], counter, bits);
+	const double u1 = philox::to_uniform_open(bits[0], bits[1]);
+	const double u2 = philox::to_uniform(bits[2], bits[3]);
+	normals[i] = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+    }
 }
 
 } // namespace fargo_random
@@ -3,6 +3,7 @@
 #include "jsf.hpp"
 #include "randutils.hpp"
 #include "ziggurat.hpp"
+#include <cstdint>
 
 namespace fargo_random
 {
@@ -16,4 +17,18 @@ double get_uniform_two_pi();
 double get_uniform_dust_eccentricity();
 int get_uniform256();
 
+// Counter based numbers: the result only depends on the stream, the id
+// (e.g. a particle id) and the counter (e.g. the step), not on the thread or
+// process that draws it.
+enum t_stream : uint32_t {
+    stream_particle_init = 1,
+    stream_dust_diffusion = 2
+};
+
+void get_uniform_pair(const t_stream stream, const uint64_t id,
+		      const uint64_t counter, double &u1, double &u2);
+void get_std_normals(const t_stream stream, const uint64_t counter,
+		     const uint64_t *ids, const unsigned int n,
+		     double *normals);
+
 } // namespace fargo_random
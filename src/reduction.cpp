@@ -0,0 +1,85 @@
+#include "reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mpi.h>
+
+namespace reduction
+{
+
+/**
+	Neumaier's variant of Kahan summation for one quantity of a strided
+	buffer. Used to combine the ring sums in a fixed order.
+*/
+static double compensated_sum(const double *values, const unsigned int count,
+			      const unsigned int stride)
+{
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    for (unsigned int i = 0; i < count; ++i) {
+	const double value = values[i * stride];
+	const double tmp = sum + value;
+	if (std::fabs(sum) >= std::fabs(value)) {
+	    compensation += (sum - tmp) + value;
+	} else {
+	    compensation += (value - tmp) + sum;
+	}
+	sum = tmp;
+    }
+
+    return sum + compensation;
+}
+
+/**
+	Buffer holding n_quantities ring sums for every global ring. Entries of
+	rings not owned by this process are zero.
+*/
+std::vector<double> &get_ring_buffer(const unsigned int n_quantities)
+{
+    static std::vector<double> ring_sums;
+    ring_sums.assign(GlobalNRadial * n_quantities, 0.0);
+    return ring_sums;
+}
+
+/**
+	Combine the ring sums of all processes. Every ring is owned by exactly
+	one process, all others contribute zero, so the MPI sum is exact and the
+	final summation is done in global radial order.
+*/
+void combine_ring_sums(std::vector<double> &ring_sums,
+		       const unsigned int n_quantities, double *result,
+		       const bool to_all)
+{
+    const int count = GlobalNRadial * n_quantities;
+
+    if (to_all) {
+	MPI_Allreduce(MPI_IN_PLACE, ring_sums.data(), count, MPI_DOUBLE,
+		      MPI_SUM, CPU_Comm);
+    } else {
+	MPI_Reduce(CPU_Master ? MPI_IN_PLACE : ring_sums.data(),
+		   ring_sums.data(), count, MPI_DOUBLE, MPI_SUM, 0,
+		   CPU_Comm);
+    }
+
+    for (unsigned int k = 0; k < n_quantities; ++k) {
+	if (to_all || CPU_Master) {
+	    result[k] = compensated_sum(ring_sums.data() + k, GlobalNRadial,
+					n_quantities);
+	} else {
+	    result[k] = 0.0;
+	}
+    }
+}
+
+void combine_local_ring_sums(const std::vector<double> &ring_sums,
+			     const unsigned int n_quantities, double *result)
+{
+    const unsigned int n_rings = ring_sums.size() / n_quantities;
+    for (unsigned int k = 0; k < n_quantities; ++k) {
+	result[k] =
+	    compensated_sum(ring_sums.data() + k, n_rings, n_quantities);
+    }
+}
+
+} // namespace reduction
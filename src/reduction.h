@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "global.h"
+
+/**
+	Reproducible reductions over the active cells of the grid.
+
+	Each ring is summed by a single thread in azimuthal order. The ring sums
+	are stored at their global ring index and combined in global radial order
+	on every process. The result is bitwise identical for any number of
+	OpenMP threads or MPI processes.
+*/
+namespace reduction
+{
+
+std::vector<double> &get_ring_buffer(const unsigned int n_quantities);
+void combine_ring_sums(std::vector<double> &ring_sums,
+		       const unsigned int n_quantities, double *result,
+		       const bool to_all);
+void combine_local_ring_sums(const std::vector<double> &ring_sums,
+			     const unsigned int n_quantities, double *result);
+
+/**
+	Sum N quantities over all active cells of all processes.
+
+	accumulate(n_radial, n_azimuthal, sums) adds the contribution of one cell
+	to the N entries of sums. If to_all is false, only the master process
+	receives the result (like MPI_Reduce), otherwise all processes do.
+*/
+template <unsigned int N, typename Func>
+std::array<double, N> sum_array(Func &&accumulate, const bool to_all = true)
+{
+    std::vector<double> &ring_sums = get_ring_buffer(N);
+
+	#pragma omp parallel for
+    for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
+	std::array<double, N> ring_sum{};
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    accumulate(nr, naz, ring_sum);
+	}
+	for (unsigned int k = 0; k < N; ++k) {
+	    ring_sums[(IMIN + nr) * N + k] = ring_sum[k];
+	}
+    }
+
+    std::array<double, N> result{};
+    combine_ring_sums(ring_sums, N, result.data(), to_all);
+    return result;
+}
+
+/**
+	Same as sum_array, but for a number of quantities that is only known at
+	run time. accumulate(n_radial, n_azimuthal, sums) gets a pointer to the
+	n_quantities ring sums.
+*/
+template <typename Func>
+std::vector<double> sum_vector(const unsigned int n_quantities,
+			       Func &&accumulate, const bool to_all = true)
+{
+    std::vector<double> &ring_sums = get_ring_buffer(n_quantities);
+
+	#pragma omp parallel
+    {
+	std::vector<double> ring_sum(n_quantities);
+
+	#pragma omp for
+	for (unsigned int nr = radial_first_active; nr < radial_active_size;
+	     ++nr) {
+	    std::fill(ring_sum.begin(), ring_sum.end(), 0.0);
+	    for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+		accumulate(nr, naz, ring_sum.data());
+	    }
+	    for (unsigned int k = 0; k < n_quantities; ++k) {
+		ring_sums[(IMIN + nr) * n_quantities + k] = ring_sum[k];
+	    }
+	}
+    }
+
+    std::vector<double> result(n_quantities);
+    combine_ring_sums(ring_sums, n_quantities, result.data(), to_all);
+    return result;
+}
+
+/**
+	Sum a single quantity over all active cells of all processes.
+
+	cell_value(n_radial, n_azimuthal) returns the contribution of one cell.
+*/
+template <typename Func>
+double sum(Func &&cell_value, const bool to_all = true)
+{
+    return sum_array<1>(
+	[&](const unsigned int nr, const unsigned int naz,
+	    std::array<double, 1> &ring_sum) {
+	    ring_sum[0] += cell_value(nr, naz);
+	},
+	to_all)[0];
+}
+
+/**
+	Same as sum, but only over the active cells of this process. The result
+	does not depend on the number of OpenMP threads.
+*/
+template <typename Func>
+double sum_local(Func &&cell_value)
+{
+    static std::vector<double> ring_sums;
+    ring_sums.assign(radial_active_size, 0.0);
+
+	#pragma omp parallel for
+    for (unsigned int nr = radial_first_active; nr < radial_active_size; ++nr) {
+	double ring_sum = 0.0;
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    ring_sum += cell_value(nr, naz);
+	}
+	ring_sums[nr] = ring_sum;
+    }
+
+    double result;
+    combine_local_ring_sums(ring_sums, 1, &result);
+    return result;
+}
+
+} // namespace reduction
@@ -0,0 +1,456 @@
+/**
+	\file remap.cpp
+
+	Conservative remapping of snapshots onto a grid with a different number
+	of cells or different radial extent.
+
+	Every snapshot stores the radii of its grid in used_rad.dat. If they do
+	not match the current grid, the surface density, the energy and the
+	velocities are remapped instead of read directly.
+
+	The remap is second order and separable: the old rings are first
+	remapped in azimuth, periodically, and then in radius with area weights
+	r dr. Both passes integrate a piecewise linear reconstruction with minmod
+	limited slopes over the overlap of old and new cells, so the total mass
+	and energy in the overlapping region are conserved. The reconstruction
+	is centered on Rmed, the area weighted centroid of a ring, so the old
+	cell averages are reproduced exactly.
+
+	Velocities are remapped as momenta at cell centers and interpolated back
+	to the staggered positions afterwards. For the azimuthal velocity only
+	the deviation from the Keplerian rotation is remapped, the steep radial
+	Keplerian profile is added back analytically.
+
+	New rings outside of the old radial extent get the values of the nearest
+	old ring.
+*/
+
+#include "remap.h"
+#include "LowTasks.h"
+#include "Theo.h"
+#include "checkpoint.h"
+#include "frame_of_reference.h"
+#include "global.h"
+#include "logging.h"
+#include "mpi_utils.h"
+#include "parameters.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <mpi.h>
+
+namespace remap
+{
+
+struct t_old_grid {
+    unsigned int n_radial;
+    unsigned int n_azimuthal;
+    // radial interfaces and centroids of the rings
+    std::vector<double> radii;
+    std::vector<double> rmed;
+};
+
+/**
+	Read the radii the snapshot was written with. Returns false if the
+	snapshot does not contain them.
+*/
+static bool read_radii(const std::string &directory,
+		       std::vector<double> &radii)
+{
+    std::ifstream file(directory + "/used_rad.dat");
+    if (!file.is_open()) {
+	return false;
+    }
+
+    radii.clear();
+    double r;
+    while (file >> r) {
+	radii.push_back(r);
+    }
+    return radii.size() >= 2;
+}
+
+/**
+	Number of cells in azimuthal direction of the snapshot with n_radial
+	rings.
+*/
+static unsigned int read_n_azimuthal(const std::string &directory,
+				     const unsigned int n_radial)
+{
+    if (checkpoint::exists(directory)) {
+	unsigned int n_r, n_az;
+	checkpoint::grid_size(directory, n_r, n_az);
+	return n_az;
+    }
+
+    const std::string file = directory + "/Sigma.dat";
+    if (!std::filesystem::exists(file)) {
+	die("Attempting to load file '%s' that does not exist!\n",
+	    file.c_str());
+    }
+    return std::filesystem::file_size(file) / (n_radial * sizeof(double));
+}
+
+static t_old_grid read_old_grid(const std::string &directory)
+{
+    t_old_grid old;
+    if (!read_radii(directory, old.radii)) {
+	die("Snapshot '%s' contains no used_rad.dat, cannot remap it!\n",
+	    directory.c_str());
+    }
+    old.n_radial = old.radii.size() - 1;
+    old.n_azimuthal = read_n_azimuthal(directory, old.n_radial);
+
+    old.rmed.resize(old.n_radial);
+    for (unsigned int nr = 0; nr < old.n_radial; ++nr) {
+	const double r0 = old.radii[nr];
+	const double r1 = old.radii[nr + 1];
+	old.rmed[nr] = 2.0 / 3.0 * (std::pow(r1, 3) - std::pow(r0, 3)) /
+		       (std::pow(r1, 2) - std::pow(r0, 2));
+    }
+    return old;
+}
+
+/**
+	Check whether the snapshot in directory was written with a grid other
+	than the current one.
+*/
+bool needed(const std::string &directory)
+{
+    std::vector<double> radii;
+    if (!read_radii(directory, radii)) {
+	// older snapshots don't know their grid, they are only loadable if
+	// they have the size of the current grid
+	unsigned int n_radial = GlobalNRadial, n_azimuthal = NAzimuthal;
+	if (checkpoint::exists(directory)) {
+	    checkpoint::grid_size(directory, n_radial, n_azimuthal);
+	}
+	if (n_radial != GlobalNRadial || n_azimuthal != NAzimuthal) {
+	    die("Snapshot '%s' has %u x %u cells instead of %u x %u and contains no used_rad.dat, cannot remap it!\n",
+		directory.c_str(), n_radial, n_azimuthal, GlobalNRadial,
+		NAzimuthal);
+	}
+	return false;
+    }
+
+    if (radii.size() != GlobalNRadial + 1) {
+	return true;
+    }
+    for (unsigned int nr = 0; nr <= GlobalNRadial; ++nr) {
+	if (std::fabs(radii[nr] - Radii[nr]) > 1e-12 * Radii[nr]) {
+	    return true;
+	}
+    }
+
+    return read_n_azimuthal(directory, GlobalNRadial) != NAzimuthal;
+}
+
+/**
+	Read a whole field of the snapshot on all processes.
+*/
+static void read_field(const std::string &directory, const std::string &name,
+		       const t_old_grid &old, const unsigned int n_rings,
+		       std::vector<double> &values)
+{
+    unsigned int n_r = 0, n_az = old.n_azimuthal;
+
+    if (checkpoint::exists(directory)) {
+	checkpoint::read_global(directory, name, values, n_r, n_az);
+    } else {
+	const std::string file = directory + "/" + name + ".dat";
+	if (!std::filesystem::exists(file)) {
+	    die("Attempting to load file '%s' that does not exist!\n",
+		file.c_str());
+	}
+
+	MPI_File fh;
+	MPI_Status status;
+	MPI_Offset size;
+	mpi_error_check_file_read(MPI_File_open(CPU_Comm, file.c_str(),
+						MPI_MODE_RDONLY, MPI_INFO_NULL,
+						&fh),
+				  file);
+	MPI_File_get_size(fh, &size);
+	n_r = size / (n_az * sizeof(double));
+	values.resize((std::size_t)n_r * n_az);
+	MPI_File_read_at_all(fh, 0, values.data(), values.size(), MPI_DOUBLE,
+			     &status);
+	MPI_File_close(&fh);
+    }
+
+    if (n_r != n_rings || n_az != old.n_azimuthal) {
+	die("Field '%s' in snapshot '%s' has %u x %u cells but has to have %u x %u.\n",
+	    name.c_str(), directory.c_str(), n_r, n_az, n_rings,
+	    old.n_azimuthal);
+    }
+}
+
+static inline double minmod(const double a, const double b)
+{
+    if (a * b <= 0.0) {
+	return 0.0;
+    }
+    return std::fabs(a) < std::fabs(b) ? a : b;
+}
+
+/**
+	Remap every ring of in from n_az_old to n_az_new cells.
+*/
+static void remap_azimuthal(const std::vector<double> &in,
+			    const unsigned int n_rings,
+			    const unsigned int n_az_old,
+			    const unsigned int n_az_new,
+			    std::vector<double> &out)
+{
+    if (n_az_old == n_az_new) {
+	out = in;
+	return;
+    }
+    out.resize((std::size_t)n_rings * n_az_new);
+
+    const double dphi_old = 2.0 * M_PI / n_az_old;
+    const double dphi_new = 2.0 * M_PI / n_az_new;
+
+    #pragma omp parallel for
+    for (unsigned int nr = 0; nr < n_rings; ++nr) {
+	const double *q = &in[(std::size_t)nr * n_az_old];
+
+	std::vector<double> slope(n_az_old);
+	for (unsigned int j = 0; j < n_az_old; ++j) {
+	    const unsigned int jm = j == 0 ? n_az_old - 1 : j - 1;
+	    const unsigned int jp = j == n_az_old - 1 ? 0 : j + 1;
+	    slope[j] = minmod(q[jp] - q[j], q[j] - q[jm]) / dphi_old;
+	}
+
+	// cells are shifted by half an old cell, so old cell j covers
+	// [j, j+1) * dphi_old
+	for (unsigned int k = 0; k < n_az_new; ++k) {
+	    const double a = (k - 0.5) * dphi_new + 0.5 * dphi_old;
+	    const double b = a + dphi_new;
+
+	    double sum = 0.0;
+	    for (int m = (int)std::floor(a / dphi_old); m * dphi_old < b; ++m) {
+		const double x0 = std::max(a, m * dphi_old);
+		const double x1 = std::min(b, (m + 1) * dphi_old);
+		if (x1 <= x0) {
+		    continue;
+		}
+		const unsigned int j =
+		    ((m % (int)n_az_old) + (int)n_az_old) % (int)n_az_old;
+		const double center = (m + 0.5) * dphi_old;
+		sum += (x1 - x0) *
+		       (q[j] + slope[j] * (0.5 * (x0 + x1) - center));
+	    }
+	    out[(std::size_t)nr * n_az_new + k] = sum / dphi_new;
+	}
+    }
+}
+
+/**
+	Remap the rings of in, already remapped in azimuth, onto the count
+	global rings starting at first. Rings outside of the grid are clamped to
+	the first or last ring.
+*/
+static void remap_radial(const std::vector<double> &in, const t_old_grid &old,
+			 const int first, const unsigned int count,
+			 std::vector<double> &out)
+{
+    const unsigned int n_old = old.n_radial;
+    const unsigned int n_az = NAzimuthal;
+    out.resize((std::size_t)count * n_az);
+
+    std::vector<double> slope(in.size(), 0.0);
+    #pragma omp parallel for collapse(2)
+    for (unsigned int nr = 1; nr < std::max(n_old, 1u) - 1; ++nr) {
+	for (unsigned int naz = 0; naz < n_az; ++naz) {
+	    const double q = in[nr * n_az + naz];
+	    const double qm = in[(nr - 1) * n_az + naz];
+	    const double qp = in[(nr + 1) * n_az + naz];
+	    slope[nr * n_az + naz] =
+		minmod((qp - q) / (old.rmed[nr + 1] - old.rmed[nr]),
+		       (q - qm) / (old.rmed[nr] - old.rmed[nr - 1]));
+	}
+    }
+
+    #pragma omp parallel for collapse(2)
+    for (unsigned int i = 0; i < count; ++i) {
+	for (unsigned int naz = 0; naz < n_az; ++naz) {
+	    const int g = std::max(
+		0, std::min((int)GlobalNRadial - 1, first + (int)i));
+	    const double c0 = std::max(Radii[g], old.radii[0]);
+	    const double c1 = std::min(Radii[g + 1], old.radii[n_old]);
+
+	    double &value = out[(std::size_t)i * n_az + naz];
+	    if (c1 <= c0) {
+		const unsigned int nearest =
+		    Radii[g + 1] <= old.radii[0] ? 0 : n_old - 1;
+		value = in[nearest * n_az + naz];
+		continue;
+	    }
+
+	    unsigned int m =
+		std::upper_bound(old.radii.begin(), old.radii.end(), c0) -
+		old.radii.begin() - 1;
+	    double sum = 0.0;
+	    for (; m < n_old && old.radii[m] < c1; ++m) {
+		const double x0 = std::max(c0, old.radii[m]);
+		const double x1 = std::min(c1, old.radii[m + 1]);
+		const double q = in[m * n_az + naz];
+		const double s = slope[m * n_az + naz];
+		const double dr2 = 0.5 * (x1 * x1 - x0 * x0);
+		const double dr3 = (x1 * x1 * x1 - x0 * x0 * x0) / 3.0;
+		sum += q * dr2 + s * (dr3 - old.rmed[m] * dr2);
+	    }
+	    value = sum / (0.5 * (c1 * c1 - c0 * c0));
+	}
+    }
+}
+
+/**
+	Remap a cell centered field of the old grid onto the count global rings
+	starting at first.
+*/
+static void remap_field(const std::vector<double> &in, const t_old_grid &old,
+			const int first, const unsigned int count,
+			std::vector<double> &out)
+{
+    std::vector<double> azimuthal;
+    remap_azimuthal(in, old.n_radial, old.n_azimuthal, NAzimuthal,
+		    azimuthal);
+    remap_radial(azimuthal, old, first, count, out);
+}
+
+/**
+	Load surface density, velocities and energy from the snapshot in
+	directory and remap them onto the current grid.
+*/
+void load(const std::string &directory, t_data &data)
+{
+    const t_old_grid old = read_old_grid(directory);
+    const unsigned int n_old = old.n_radial;
+    const unsigned int n_az_old = old.n_azimuthal;
+
+    logging::print_master(
+	LOG_INFO "Remapping snapshot '%s' from %u x %u to %u x %u cells.\n",
+	directory.c_str(), n_old, n_az_old, GlobalNRadial, NAzimuthal);
+    if (Radii[0] < old.radii[0] || Radii[GlobalNRadial] > old.radii[n_old]) {
+	logging::print_master(
+	    LOG_WARNING
+	    "Snapshot covers only %g <= r <= %g, rings outside get the values of the nearest ring.\n",
+	    old.radii[0], old.radii[n_old]);
+    }
+
+    // all local rings plus one on each side to interpolate the radial
+    // velocity at the outermost interfaces
+    const int first = (int)IMIN - 1;
+    const unsigned int count = NRadial + 2;
+
+    std::vector<double> sigma_old, sigma;
+    read_field(directory, data[t_data::SIGMA].get_name(), old, n_old,
+	       sigma_old);
+    remap_field(sigma_old, old, first, count, sigma);
+
+    t_polargrid &Sigma = data[t_data::SIGMA];
+    #pragma omp parallel for collapse(2)
+    for (unsigned int nr = 0; nr < Sigma.get_size_radial(); ++nr) {
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    Sigma(nr, naz) = sigma[(nr + 1) * NAzimuthal + naz];
+	}
+    }
+
+    if (parameters::Adiabatic) {
+	std::vector<double> energy_old, energy;
+	read_field(directory, data[t_data::ENERGY].get_name(), old, n_old,
+		   energy_old);
+	remap_field(energy_old, old, first, count, energy);
+
+	t_polargrid &Energy = data[t_data::ENERGY];
+	#pragma omp parallel for collapse(2)
+	for (unsigned int nr = 0; nr < Energy.get_size_radial(); ++nr) {
+	    for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+		Energy(nr, naz) = energy[(nr + 1) * NAzimuthal + naz];
+	    }
+	}
+    }
+
+    std::vector<double> values, momentum_old(sigma_old.size()), momentum;
+
+    // radial velocity, as momentum at the old cell centers
+    read_field(directory, data[t_data::V_RADIAL].get_name(), old, n_old + 1,
+	       values);
+    #pragma omp parallel for collapse(2)
+    for (unsigned int nr = 0; nr < n_old; ++nr) {
+	for (unsigned int naz = 0; naz < n_az_old; ++naz) {
+	    const unsigned int id = nr * n_az_old + naz;
+	    momentum_old[id] =
+		sigma_old[id] * 0.5 * (values[id] + values[id + n_az_old]);
+	}
+    }
+    remap_field(momentum_old, old, first, count, momentum);
+
+    t_polargrid &v_radial = data[t_data::V_RADIAL];
+    #pragma omp parallel for collapse(2)
+    for (unsigned int nr = 0; nr < v_radial.get_size_radial(); ++nr) {
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    // ring nr - 1 and nr of the local grid are inside and outside
+	    const unsigned int in = nr * NAzimuthal + naz;
+	    const unsigned int out = in + NAzimuthal;
+	    const double v_in = sigma[in] > 0.0 ? momentum[in] / sigma[in] : 0.0;
+	    const double v_out =
+		sigma[out] > 0.0 ? momentum[out] / sigma[out] : 0.0;
+
+	    const unsigned int g = IMIN + nr;
+	    if (g == 0) {
+		v_radial(nr, naz) = v_out;
+	    } else if (g >= GlobalNRadial) {
+		v_radial(nr, naz) = v_in;
+	    } else {
+		const double f = (Radii[g] - GlobalRmed[g - 1]) /
+				 (GlobalRmed[g] - GlobalRmed[g - 1]);
+		v_radial(nr, naz) = (1.0 - f) * v_in + f * v_out;
+	    }
+	}
+    }
+
+    // azimuthal velocity, as momentum of the deviation from Keplerian
+    // rotation at the old cell centers
+    read_field(directory, data[t_data::V_AZIMUTHAL].get_name(), old, n_old,
+	       values);
+    #pragma omp parallel for
+    for (unsigned int nr = 0; nr < n_old; ++nr) {
+	const double r = old.rmed[nr];
+	const double v_background =
+	    r * calculate_omega_kepler(r) - refframe::OmegaFrame * r;
+	for (unsigned int naz = 0; naz < n_az_old; ++naz) {
+	    const unsigned int id = nr * n_az_old + naz;
+	    const unsigned int id_next =
+		nr * n_az_old + (naz == n_az_old - 1 ? 0 : naz + 1);
+	    momentum_old[id] =
+		sigma_old[id] *
+		(0.5 * (values[id] + values[id_next]) - v_background);
+	}
+    }
+    remap_field(momentum_old, old, first, count, momentum);
+
+    t_polargrid &v_azimuthal = data[t_data::V_AZIMUTHAL];
+    #pragma omp parallel for
+    for (unsigned int nr = 0; nr < v_azimuthal.get_size_radial(); ++nr) {
+	const double r = Rmed[nr];
+	const double v_background =
+	    r * calculate_omega_kepler(r) - refframe::OmegaFrame * r;
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    // faces sit between cell naz - 1 and naz
+	    const unsigned int id = (nr + 1) * NAzimuthal + naz;
+	    const unsigned int id_prev =
+		(nr + 1) * NAzimuthal + (naz == 0 ? NAzimuthal - 1 : naz - 1);
+	    const double delta =
+		sigma[id] > 0.0 ? momentum[id] / sigma[id] : 0.0;
+	    const double delta_prev =
+		sigma[id_prev] > 0.0 ? momentum[id_prev] / sigma[id_prev] : 0.0;
+	    v_azimuthal(nr, naz) = 0.5 * (delta + delta_prev) + v_background;
+	}
+    }
+}
+
+} // namespace remap
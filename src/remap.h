@@ -0,0 +1,15 @@
+#pragma once
+
+#include "data.h"
+#include <string>
+
+// Conservative remapping of snapshots written with a different grid onto the
+// current grid, used to restart a simulation at a different resolution.
+
+namespace remap
+{
+
+bool needed(const std::string &directory);
+void load(const std::string &directory, t_data &data);
+
+} // namespace remap
@@ -13,13 +13,109 @@
 #include "particles/particles.h"
 #include "circumplanetary_mass.h"
 #include "LowTasks.h"
+#include "global.h"
 #include "mpi.h"
+#include "checkpoint.h"
+#include "remap.h"
+#include "derived_fields.h"
+#include <algorithm>
+#include <vector>
+
+/**
+	Load polargrids from the current snapshot directory, from the
+	checkpoint container if there is one. All grids of a container are read
+	with a single call.
+*/
+static void load_grids(const std::vector<t_polargrid *> &grids)
+{
+    if (checkpoint::exists(output::snapshot_dir)) {
+	checkpoint::read(output::snapshot_dir, grids);
+    } else {
+	for (t_polargrid *grid : grids) {
+	    grid->read2D();
+	}
+    }
+}
+
+/**
+	Whether grid was written to the current snapshot directory.
+	container_fields lists the fields of the checkpoint container, if the
+	snapshot has one.
+*/
+static bool grid_available(const t_polargrid &grid,
+			   const std::vector<std::string> &container_fields)
+{
+    if (checkpoint::exists(output::snapshot_dir)) {
+	return std::find(container_fields.begin(), container_fields.end(),
+			 grid.get_name()) != container_fields.end();
+    }
+    return std::filesystem::exists(output::snapshot_dir + "/" +
+				   grid.get_name() + ".dat");
+}
 
+static std::vector<double> copy_values(const t_polargrid &grid)
+{
+    return std::vector<double>(
+	grid.Field, grid.Field + grid.get_size_radial() * grid.get_size_azimuthal());
+}
+
+static void restore_values(t_polargrid &grid, const std::vector<double> &values)
+{
+    std::copy(values.begin(), values.end(), grid.Field);
+}
+
+static void check_vazi_file()
+{
+    if (!checkpoint::exists(output::snapshot_dir) &&
+	!std::filesystem::exists(output::snapshot_dir + "/vazi.dat")) {
+	logging::print_master(
+	    LOG_ERROR
+	    "vazi.dat not found in snapshot directory '%s'. Maybe it's from an old version and called 'vtheta.dat'. In that case, rename it to 'vazi.dat'.\n", output::snapshot_dir.c_str());
+    }
+}
+
+/**
+	Surface density, velocities and energy, the grids every snapshot has.
+*/
+static std::vector<t_polargrid *> hydro_grids(t_data &data)
+{
+    std::vector<t_polargrid *> grids = {&data[t_data::SIGMA],
+					&data[t_data::V_RADIAL],
+					&data[t_data::V_AZIMUTHAL]};
+    if (parameters::Adiabatic) {
+	grids.push_back(&data[t_data::ENERGY]);
+    }
+    return grids;
+}
+
+/**
+	Load surface density, velocities and energy from the current snapshot
+	directory. Snapshots written with a different grid are remapped.
+	Returns whether the snapshot was remapped.
+*/
+static bool load_hydro_grids(t_data &data)
+{
+    if (remap::needed(output::snapshot_dir)) {
+	remap::load(output::snapshot_dir, data);
+	return true;
+    }
+
+    check_vazi_file();
+    load_grids(hydro_grids(data));
+    return false;
+}
 
 void restart_load(t_data &data) {
 
 	sim::N_monitor = 0;
-	start_mode::restart_from = output::load_misc();
+	// fields of the checkpoint container of the snapshot to restart from
+	std::vector<std::string> container_fields;
+	if (checkpoint::exists(output::snapshot_dir)) {
+	    start_mode::restart_from =
+		checkpoint::read_misc(output::snapshot_dir, container_fields);
+	} else {
+	    start_mode::restart_from = output::load_misc();
+	}
 
 	if (boundary_conditions::initial_values_needed()) {
 	    // load grids at t = 0
@@ -34,17 +130,7 @@ void restart_load(t_data &data) {
 
 	    logging::print_master(LOG_INFO
 				  "Loading polargrinds for damping...\n");
-	    data[t_data::SIGMA].read2D();
-	    data[t_data::V_RADIAL].read2D();
-		if (!std::filesystem::exists(output::snapshot_dir + "/vazi.dat")) {
-			logging::print_master(
-				LOG_ERROR
-				"vazi.dat not found in snapshot directory '%s'. Maybe it's from an old version and called 'vtheta.dat'. In that case, rename it to 'vazi.dat'.\n", output::snapshot_dir.c_str());
-		}
-	    data[t_data::V_AZIMUTHAL].read2D();
-	    if (parameters::Adiabatic) {
-		data[t_data::ENERGY].read2D();
-	    }
+	    load_hydro_grids(data);
 	    output::snapshot_dir = snapshot_dir_old;
 
 	    // save starting values (needed for damping)
@@ -59,34 +145,75 @@ void restart_load(t_data &data) {
 	// load grids at t = restart_from
 	logging::print_master(LOG_INFO "Loading polargrinds at t = %u...\n",
 			      start_mode::restart_from);
-	data[t_data::SIGMA].read2D();
-	data[t_data::V_RADIAL].read2D();
-	if (!std::filesystem::exists(output::snapshot_dir + "/vazi.dat")) {
-			logging::print_master(
-				LOG_ERROR
-				"vazi.dat not found in snapshot directory '%s'. Maybe it's from an old version and called 'vtheta.dat'. In that case, rename it to 'vazi.dat'.\n", output::snapshot_dir.c_str());
+	// heating, cooling and gamma of a remapped snapshot don't match the
+	// grid, they are recomputed instead
+	const bool remapped = remap::needed(output::snapshot_dir);
+
+	// heating, cooling and gamma are loaded for bitwise identical
+	// restarting if the snapshot has them, together with the hydro grids
+	bool qplus_loaded = false;
+	bool qminus_loaded = false;
+	std::vector<t_polargrid *> gamma_grids;
+	// gamma and mu are overwritten when the derived quantities are
+	// recomputed below, the loaded values are restored afterwards
+	std::vector<std::vector<double>> gamma_values;
+	if (remapped) {
+	    remap::load(output::snapshot_dir, data);
+	} else {
+	    check_vazi_file();
+	    std::vector<t_polargrid *> grids = hydro_grids(data);
+	    if (parameters::Adiabatic) {
+		qplus_loaded =
+		    grid_available(data[t_data::QPLUS], container_fields);
+		qminus_loaded =
+		    grid_available(data[t_data::QMINUS], container_fields);
+		if (qplus_loaded) {
+		    grids.push_back(&data[t_data::QPLUS]);
+		}
+		if (qminus_loaded) {
+		    grids.push_back(&data[t_data::QMINUS]);
+		}
+	    }
+	    if (parameters::variableGamma) {
+		for (t_polargrid *grid :
+		     {&data[t_data::GAMMAEFF], &data[t_data::MU],
+		      &data[t_data::GAMMA1]}) {
+		    if (grid_available(*grid, container_fields)) {
+			gamma_grids.push_back(grid);
+			grids.push_back(grid);
+		    }
+		}
+	    }
+	    load_grids(grids);
+
+	    for (const t_polargrid *grid : gamma_grids) {
+		gamma_values.push_back(copy_values(*grid));
+	    }
 	}
-	data[t_data::V_AZIMUTHAL].read2D();
-	if (parameters::Adiabatic) {
-	    data[t_data::ENERGY].read2D();
 
-	    if (data[t_data::QPLUS].file_exists()) {
-		data[t_data::QPLUS].read2D();
-	    } else {
+	if (parameters::Adiabatic && remapped) {
+	    compute_heating_cooling_for_CFL(data, sim::time);
+	} else if (parameters::Adiabatic && !(qplus_loaded && qminus_loaded)) {
+	    if (!qplus_loaded) {
 		logging::print_master(
 		    LOG_INFO
 		    "Cannot read Qplus, no bitwise identical restarting possible!\n");
-		compute_heating_cooling_for_CFL(data, sim::time);
 	    }
-	    if (data[t_data::QMINUS].file_exists()) {
-		data[t_data::QMINUS].read2D();
-	    } else {
+	    if (!qminus_loaded) {
 		logging::print_master(
 		    LOG_INFO
 		    "Cannot read Qminus, no bitwise identical restarting possible!\n");
-		compute_heating_cooling_for_CFL(data, sim::time);
+	    }
+	    // recomputes both, keep the one read from the snapshot
+	    t_polargrid &loaded =
+		qplus_loaded ? data[t_data::QPLUS] : data[t_data::QMINUS];
+	    const std::vector<double> loaded_values = copy_values(loaded);
+	    compute_heating_cooling_for_CFL(data, sim::time);
+	    if (qplus_loaded || qminus_loaded) {
+		restore_values(loaded, loaded_values);
 	    }
 	}
+
 	if (parameters::integrate_particles) {
 	    particles::restart();
 	}
@@ -101,25 +228,20 @@ void restart_load(t_data &data) {
 
 	ComputeCircumPlanetaryMasses(data);
 
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(CPU_Comm);
 	logging::print_master(LOG_INFO
 			      "Finished restarting planetary system.\n");
 
+	derived_fields::invalidate();
 	recalculate_derived_disk_quantities(data, sim::time);
 
 	if (parameters::variableGamma) {
 
 	    // For bitwise exact restarting with PVTE
-	    if (data[t_data::GAMMAEFF].file_exists()) {
-		data[t_data::GAMMAEFF].read2D();
-	    }
-	    if (data[t_data::MU].file_exists()) {
-		data[t_data::MU].read2D();
-	    }
-
-	    if (data[t_data::GAMMA1].file_exists()) {
-		data[t_data::GAMMA1].read2D();
+	    for (unsigned int i = 0; i < gamma_grids.size(); ++i) {
+		restore_values(*gamma_grids[i], gamma_values[i]);
 	    }
+	    derived_fields::invalidate();
 
 		compute_temperature(data);
 		compute_sound_speed(data, sim::time);
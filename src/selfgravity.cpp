@@ -6,6 +6,12 @@
 
    All references to pages and equations are in "Toward predictive scenarios of
    planetary migration" by C. Baruteau
+
+   Two solvers share the kernels. The polar solver convolves in (log r, phi)
+   with a 2D FFT and needs a logarithmic radial grid. The modal solver works
+   on any radial grid: it transforms the ring masses in azimuth only and sums
+   every azimuthal mode directly over all source rings, using the precomputed
+   transform of the kernel for every pair of rings.
 */
 #ifdef _OPENMP
 #include <omp.h>
@@ -14,7 +20,10 @@
 #ifndef DISABLE_FFTW
 #endif
 
+#include <algorithm>
 #include <math.h>
+#include <unistd.h>
+#include <vector>
 
 #include "LowTasks.h"
 #include "Theo.h"
@@ -105,6 +114,32 @@ fftw_complex *FFT_acc_azimuthal;
 double *g_radial;
 double *g_azimuthal;
 
+/* Modal solver */
+/// number of azimuthal modes, NAzimuthal/2 + 1
+static unsigned int modal_N_modes;
+/// transformed kernels for local ring nr, mode m and global source ring i at
+/// [(nr * modal_N_modes + m) * GlobalNRadial + i]. The radial kernel is even
+/// in phi and its transform real, the azimuthal kernel is odd and its
+/// transform imaginary, so one double per entry is stored for both.
+static std::vector<double> modal_K_radial;
+static std::vector<double> modal_K_azimuthal;
+/// transformed ring masses of all global rings at [m * GlobalNRadial + i]
+static std::vector<double> modal_S_real;
+static std::vector<double> modal_S_imag;
+/// number of doubles and displacements of the active rings of every rank
+static std::vector<int> modal_counts;
+static std::vector<int> modal_displacements;
+
+static double *modal_mass;
+static fftw_complex *modal_FFT_mass;
+static fftw_complex *modal_FFT_mass_global;
+static double *modal_acc;
+static fftw_complex *modal_FFT_acc;
+
+static fftw_plan modal_plan_forward;
+static fftw_plan modal_plan_backward;
+static fftw_plan modal_plan_kernel;
+
 
 
 void mpi_init(void)
@@ -137,6 +172,15 @@ void mpi_finalize(void)
     fftw_free(FFT_acc_radial);
     fftw_free(FFT_acc_azimuthal);
 
+    fftw_destroy_plan(modal_plan_forward);
+    fftw_destroy_plan(modal_plan_backward);
+    fftw_destroy_plan(modal_plan_kernel);
+    fftw_free(modal_mass);
+    fftw_free(modal_FFT_mass);
+    fftw_free(modal_FFT_mass_global);
+    fftw_free(modal_acc);
+    fftw_free(modal_FFT_acc);
+
     // cleanup MPI
 #ifdef _OPENMP
 	fftw_cleanup_threads();
@@ -179,6 +223,18 @@ void update_sg_constants() {
 }
 
 
+static void compute_modal_kernel();
+static void compute_modal(t_polargrid &density);
+
+static void compute_kernel()
+{
+    if (parameters::self_gravity_solver == parameters::sg_solver_modal) {
+	compute_modal_kernel();
+    } else {
+	compute_FFT_kernel();
+    }
+}
+
 /**
  * @brief upate_kernel, update the self-gravity kernel if needed.
  * @param data
@@ -210,7 +266,145 @@ static void update_kernel(t_data &data)
 	last_aspect_ratio = aspect_ratio;
 
 	update_sg_constants();
-	compute_FFT_kernel();
+	compute_kernel();
+}
+
+/**
+   Allocates the arrays and plans of the polar solver on the fftw domain
+   decomposition.
+*/
+static void init_polar()
+{
+    // allocate memory
+    K_radial = fftw_alloc_real(2 * total_local_size);
+    K_azimuthal = fftw_alloc_real(2 * total_local_size);
+    FFT_K_radial = fftw_alloc_complex(total_local_size);
+    FFT_K_azimuthal = fftw_alloc_complex(total_local_size);
+    S_radial = fftw_alloc_real(2 * total_local_size);
+    S_azimuthal = fftw_alloc_real(2 * total_local_size);
+    FFT_S_radial = fftw_alloc_complex(total_local_size);
+    FFT_S_azimuthal = fftw_alloc_complex(total_local_size);
+    acc_radial = fftw_alloc_real(2 * total_local_size);
+    acc_azimuthal = fftw_alloc_real(2 * total_local_size);
+    FFT_acc_radial = fftw_alloc_complex(total_local_size);
+    FFT_acc_azimuthal = fftw_alloc_complex(total_local_size);
+
+    // create FFT plans
+    fftplan_forward_K_radial = fftw_mpi_plan_dft_r2c_2d(
+	2 * GlobalNRadial, NAzimuthal, K_radial, FFT_K_radial, CPU_Comm,
+	FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+    fftplan_forward_K_azimuthal = fftw_mpi_plan_dft_r2c_2d(
+	2 * GlobalNRadial, NAzimuthal, K_azimuthal, FFT_K_azimuthal,
+	CPU_Comm, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+    fftplan_forward_S_radial = fftw_mpi_plan_dft_r2c_2d(
+	2 * GlobalNRadial, NAzimuthal, S_radial, FFT_S_radial, CPU_Comm,
+	FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+    fftplan_forward_S_azimuthal = fftw_mpi_plan_dft_r2c_2d(
+	2 * GlobalNRadial, NAzimuthal, S_azimuthal, FFT_S_azimuthal,
+	CPU_Comm, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
+
+    fftplan_backward_acc_radial = fftw_mpi_plan_dft_c2r_2d(
+	2 * GlobalNRadial, NAzimuthal, FFT_acc_radial, acc_radial,
+	CPU_Comm, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
+    fftplan_backward_acc_azimuthal = fftw_mpi_plan_dft_c2r_2d(
+	2 * GlobalNRadial, NAzimuthal, FFT_acc_azimuthal, acc_azimuthal,
+	CPU_Comm, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
+}
+
+/**
+   Abort if the dense kernels of the modal solver do not fit into the memory
+   of a process. The processes on a node share its physical memory, half of
+   it is left for the grids and the other arrays.
+*/
+static void check_modal_memory(const double kernel_bytes)
+{
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(CPU_Comm, MPI_COMM_TYPE_SHARED, CPU_Rank,
+			MPI_INFO_NULL, &node_comm);
+    int node_size;
+    MPI_Comm_size(node_comm, &node_size);
+    MPI_Comm_free(&node_comm);
+
+    const double node_memory =
+	(double)sysconf(_SC_PHYS_PAGES) * (double)sysconf(_SC_PAGE_SIZE);
+    const double available = 0.5 * node_memory / (double)node_size;
+
+    double max_kernel_bytes;
+    MPI_Allreduce(&kernel_bytes, &max_kernel_bytes, 1, MPI_DOUBLE, MPI_MAX,
+		  CPU_Comm);
+    int too_large = (node_memory > 0.0 && kernel_bytes > available) ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &too_large, 1, MPI_INT, MPI_MAX, CPU_Comm);
+
+    if (too_large) {
+	logging::print_master(
+	    LOG_ERROR
+	    "The modal self-gravity solver needs up to %.2f GB per process for its kernels (Nrad_local * (Nsec/2+1) * Nrad * 16 bytes), which does not fit into the memory available per process. Use more nodes, a smaller grid or SelfGravitySolver = polar on a logarithmic grid.\n",
+	    max_kernel_bytes / 1073741824.0);
+	PersonalExit(1);
+    }
+}
+
+/**
+   Allocates the arrays and plans of the modal solver.
+*/
+static void init_modal()
+{
+    modal_N_modes = NAzimuthal / 2 + 1;
+
+    const double kernel_bytes = 2.0 * (double)NRadial * modal_N_modes *
+				GlobalNRadial * sizeof(double);
+    check_modal_memory(kernel_bytes);
+
+    // active rings of every rank, in global ring order
+    const int local_count =
+	2 * (Max_or_active - Zero_or_active) * modal_N_modes;
+    modal_counts.resize(CPU_Number);
+    modal_displacements.resize(CPU_Number);
+    MPI_Allgather(&local_count, 1, MPI_INT, modal_counts.data(), 1, MPI_INT,
+		  CPU_Comm);
+    const int local_displacement =
+	2 * (IMIN + Zero_or_active) * modal_N_modes;
+    MPI_Allgather(&local_displacement, 1, MPI_INT,
+		  modal_displacements.data(), 1, MPI_INT, CPU_Comm);
+
+    modal_K_radial.resize((size_t)NRadial * modal_N_modes * GlobalNRadial);
+    modal_K_azimuthal.resize((size_t)NRadial * modal_N_modes * GlobalNRadial);
+    modal_S_real.resize(modal_N_modes * GlobalNRadial);
+    modal_S_imag.resize(modal_N_modes * GlobalNRadial);
+
+    modal_mass = fftw_alloc_real(NRadial * NAzimuthal);
+    modal_FFT_mass = fftw_alloc_complex(NRadial * modal_N_modes);
+    modal_FFT_mass_global = fftw_alloc_complex(GlobalNRadial * modal_N_modes);
+    // radial and azimuthal component
+    modal_acc = fftw_alloc_real(2 * NRadial * NAzimuthal);
+    modal_FFT_acc = fftw_alloc_complex(2 * NRadial * modal_N_modes);
+
+    const int n = NAzimuthal;
+    modal_plan_forward = fftw_plan_many_dft_r2c(
+	1, &n, NRadial, modal_mass, NULL, 1, NAzimuthal, modal_FFT_mass, NULL,
+	1, modal_N_modes, FFTW_MEASURE);
+    modal_plan_backward = fftw_plan_many_dft_c2r(
+	1, &n, 2 * NRadial, modal_FFT_acc, NULL, 1, modal_N_modes, modal_acc,
+	NULL, 1, NAzimuthal, FFTW_MEASURE);
+
+    // the kernel plan is executed by all threads at once on their own arrays
+#ifdef _OPENMP
+    fftw_plan_with_nthreads(1);
+#endif
+    double *kernel = fftw_alloc_real(NAzimuthal);
+    fftw_complex *FFT_kernel = fftw_alloc_complex(modal_N_modes);
+    modal_plan_kernel =
+	fftw_plan_dft_r2c_1d(NAzimuthal, kernel, FFT_kernel, FFTW_ESTIMATE);
+    fftw_free(kernel);
+    fftw_free(FFT_kernel);
+#ifdef _OPENMP
+    fftw_plan_with_nthreads(Thread_Number);
+#endif
+
+    logging::print_master(
+	LOG_INFO
+	"Modal self-gravity solver uses %.1f MB per process for the kernels.\n",
+	kernel_bytes / 1048576.0);
 }
 
 /**
@@ -218,11 +412,12 @@ static void update_kernel(t_data &data)
 */
 void init(t_data &data)
 {
-    // Self-gravity must be on a polar logarithmic grid
-    if (parameters::radial_grid_type != parameters::logarithmic_spacing) {
+    // The polar method needs a logarithmic grid
+    if (parameters::self_gravity_solver == parameters::sg_solver_polar &&
+	parameters::radial_grid_type != parameters::logarithmic_spacing) {
 	logging::print_master(
 	    LOG_ERROR
-	    "A logarithmic grid is needed to compute self-gravity with polar method. Try again!\n");
+	    "A logarithmic grid is needed to compute self-gravity with polar method. Use SelfGravitySolver = modal for other grids.\n");
 	PersonalExit(1);
     }
 
@@ -246,49 +441,21 @@ void init(t_data &data)
     r_step = std::log(Radii[GlobalNRadial] / Radii[0]) / (double)GlobalNRadial;
     t_step = 2.0 * M_PI / (double)NAzimuthal;
 
-    // allocate memory
-    K_radial = fftw_alloc_real(2 * total_local_size);
-    K_azimuthal = fftw_alloc_real(2 * total_local_size);
-    FFT_K_radial = fftw_alloc_complex(total_local_size);
-    FFT_K_azimuthal = fftw_alloc_complex(total_local_size);
-    S_radial = fftw_alloc_real(2 * total_local_size);
-    S_azimuthal = fftw_alloc_real(2 * total_local_size);
-    FFT_S_radial = fftw_alloc_complex(total_local_size);
-    FFT_S_azimuthal = fftw_alloc_complex(total_local_size);
-    acc_radial = fftw_alloc_real(2 * total_local_size);
-    acc_azimuthal = fftw_alloc_real(2 * total_local_size);
-    FFT_acc_radial = fftw_alloc_complex(total_local_size);
-    FFT_acc_azimuthal = fftw_alloc_complex(total_local_size);
-
     g_radial = data[t_data::SG_ACCEL_RAD].Field;
     g_azimuthal = data[t_data::SG_ACCEL_AZI].Field;
 
-    // create FFT plans
-    fftplan_forward_K_radial = fftw_mpi_plan_dft_r2c_2d(
-	2 * GlobalNRadial, NAzimuthal, K_radial, FFT_K_radial, MPI_COMM_WORLD,
-	FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
-    fftplan_forward_K_azimuthal = fftw_mpi_plan_dft_r2c_2d(
-	2 * GlobalNRadial, NAzimuthal, K_azimuthal, FFT_K_azimuthal,
-	MPI_COMM_WORLD, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
-    fftplan_forward_S_radial = fftw_mpi_plan_dft_r2c_2d(
-	2 * GlobalNRadial, NAzimuthal, S_radial, FFT_S_radial, MPI_COMM_WORLD,
-	FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
-    fftplan_forward_S_azimuthal = fftw_mpi_plan_dft_r2c_2d(
-	2 * GlobalNRadial, NAzimuthal, S_azimuthal, FFT_S_azimuthal,
-	MPI_COMM_WORLD, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_OUT);
-
-    fftplan_backward_acc_radial = fftw_mpi_plan_dft_c2r_2d(
-	2 * GlobalNRadial, NAzimuthal, FFT_acc_radial, acc_radial,
-	MPI_COMM_WORLD, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
-    fftplan_backward_acc_azimuthal = fftw_mpi_plan_dft_c2r_2d(
-	2 * GlobalNRadial, NAzimuthal, FFT_acc_azimuthal, acc_azimuthal,
-	MPI_COMM_WORLD, FFTW_MEASURE | FFTW_MPI_TRANSPOSED_IN);
+    if (parameters::self_gravity_solver == parameters::sg_solver_modal) {
+	init_modal();
+    } else {
+	init_polar();
+    }
 
 	aspect_ratio = get_aspect_ratio(data);
 	update_sg_constants();
-	compute_FFT_kernel();
+	compute_kernel();
     compute(data, 0, false);
 
+
 	// check that the ratio of outer and inner boundary radius
 	// is compatible with the coefficients for the smoothing length
 	if (parameters::self_gravity_mode == parameters::t_sg::sg_S) {
@@ -305,8 +472,12 @@ void compute(t_data &data, double dt, bool update)
     update_kernel(data);
 
     auto &density = data[t_data::SIGMA];
-    compute_FFT_density(density);
-    compute_acceleration(density);
+    if (parameters::self_gravity_solver == parameters::sg_solver_modal) {
+	compute_modal(density);
+    } else {
+	compute_FFT_density(density);
+	compute_acceleration(density);
+    }
 
     if (update) {
 	// Computes polar components of acceleration and updates values of vrad,
@@ -321,12 +492,13 @@ void compute(t_data &data, double dt, bool update)
 void compute_FFT_density(t_polargrid &density)
 {
 
-    MPI_Request req;
+    MPI_Request req = MPI_REQUEST_NULL;
 	double *dens = density.Field;
     const unsigned int stride = 2 * (NAzimuthal / 2 + 1);
 
     // We communicate the hydro density field to the fftw domain decomposition
-    // (d. d.)
+    // (d. d.). The transfer is only waited for when the data from the friend
+    // is needed, the own rings are copied in the meantime.
     const int one_if_odd = (CPU_Number % 2 == 0 ? 0 : 1);
 
     // every cpu except that one with no 'friend' needs to interchange data
@@ -335,13 +507,12 @@ void compute_FFT_density(t_polargrid &density)
 	    /* all upper cpus send data */
 	    MPI_Isend(&dens[Zero_or_active * NAzimuthal],
 		      active_hydro_totalsize, MPI_DOUBLE, CPU_Friend, 30,
-		      MPI_COMM_WORLD, &req);
+		      CPU_Comm, &req);
 	} else {
 	    /* all lower cpus recieve data */
 	    MPI_Irecv(&dens_friend[0], active_hydro_totalsize_friend,
-		      MPI_DOUBLE, CPU_Friend, 30, MPI_COMM_WORLD, &req);
+		      MPI_DOUBLE, CPU_Friend, 30, CPU_Comm, &req);
 	}
-	MPI_Wait(&req, &global_MPI_Status);
     }
 
     // lower half of cpus
@@ -359,6 +530,8 @@ void compute_FFT_density(t_polargrid &density)
 	    }
 	}
 
+	MPI_Wait(&req, &global_MPI_Status);
+
 	#pragma omp parallel for collapse(2)
 	for (unsigned int i = (unsigned int) ifront + 1; i < (unsigned int)local_Nx; i++) {
 	    for (unsigned int j = 0; j < NAzimuthal; j++) {
@@ -413,34 +586,27 @@ void compute_FFT_density(t_polargrid &density)
     // Now we can compute the in-place ffts of reduced density arrays.
     fftw_execute(fftplan_forward_S_radial);
     fftw_execute(fftplan_forward_S_azimuthal);
+
+    // the density of the upper cpus is not changed by the ffts, so their
+    // send can complete in the background
+    MPI_Wait(&req, &global_MPI_Status);
 }
 
-void compute_FFT_kernel()
+/**
+   Kernels of the radial and azimuthal acceleration for the separation
+   u = log(r/r') and theta = phi - phi' of two cells.
+*/
+static void kernel(const double u, const double theta, double &K_r,
+		   double &K_phi)
 {
-    const unsigned int stride = 2 * (NAzimuthal / 2 + 1);
-
-	#pragma omp parallel for
-    for (unsigned int i = 0; i < (unsigned int)local_Nx; i++) {
-    double u;
-	if (i + local_i_start < GlobalNRadial) {
-	    u = std::log(Radii[i + local_i_start] / Radii[0]);
-	} else {
-	    u = -std::log(Radii[2 * GlobalNRadial - (i + local_i_start)] /
-			  Radii[0]);
-	}
-
-	for (unsigned int j = 0; j < NAzimuthal; j++) {
-	    const unsigned int l = i * stride + j;
-		const double theta = dphi * (double)j;
-
 	if (parameters::self_gravity_mode == parameters::t_sg::sg_B) {
 		const double denominator = std::pow(epsilon*epsilon*std::exp(u)
 									+ 2.0 * (std::cosh(u) - std::cos(theta)),-1.5);
 
-		K_radial[l] = 1.0 + epsilon*epsilon - std::cos(theta) * std::exp(-u);
-		K_radial[l] *= denominator;
-		K_azimuthal[l] = std::sin(theta);
-		K_azimuthal[l] *= denominator;
+		K_r = 1.0 + epsilon*epsilon - std::cos(theta) * std::exp(-u);
+		K_r *= denominator;
+		K_phi = std::sin(theta);
+		K_phi *= denominator;
 	} else if (parameters::self_gravity_mode == parameters::t_sg::sg_BK) {
 
 		/* This Kernel is an anlytical solution in the limit Q->oo
@@ -453,8 +619,8 @@ void compute_FFT_kernel()
 			* use tapering functions (see Sect. 4.1 of 
 			* https://doi.org/10.1051/0004-6361/202346178).
 			*/
-			K_radial[l] = 0.;
-			K_azimuthal[l]  = 0.;
+			K_r = 0.;
+			K_phi  = 0.;
 
 		} else {
 			const double distance_squared = 2. * std::pow(aspect_ratio, -2.) 
@@ -488,12 +654,12 @@ void compute_FFT_kernel()
                        + 45./128.*std::pow(X_aux, -3.5) );
             }
 			
-			K_radial[l] = (L_sg / 2. / M_PI / aspect_ratio)
+			K_r = (L_sg / 2. / M_PI / aspect_ratio)
 						* std::pow(std::cosh(u), -0.5)
 						* std::pow(std::cosh(u)-std::cos(theta), -1.)
 						* (1.0-std::cos(theta)*std::exp(-u));
 
-			K_azimuthal[l] =  (L_sg / 2. / M_PI / aspect_ratio)
+			K_phi =  (L_sg / 2. / M_PI / aspect_ratio)
 							* std::pow(std::cosh(u), -0.5)
 							* std::pow(std::cosh(u)-std::cos(theta), -1.)
 							* std::sin(theta);
@@ -505,11 +671,32 @@ void compute_FFT_kernel()
 		2 * (std::cosh(u) - std::cos(theta)) +
 		    lambda_sq * (std::exp(u) + std::exp(-u) - 2) + chi_sq, -1.5);
 
-		K_radial[l] = 1.0 - std::cos(theta) * std::exp(-u);
-		K_radial[l] *= denominator;
-		K_azimuthal[l] = std::sin(theta);
-		K_azimuthal[l] *= denominator;
+		K_r = 1.0 - std::cos(theta) * std::exp(-u);
+		K_r *= denominator;
+		K_phi = std::sin(theta);
+		K_phi *= denominator;
 	}
+}
+
+void compute_FFT_kernel()
+{
+    const unsigned int stride = 2 * (NAzimuthal / 2 + 1);
+
+	#pragma omp parallel for
+    for (unsigned int i = 0; i < (unsigned int)local_Nx; i++) {
+    double u;
+	if (i + local_i_start < GlobalNRadial) {
+	    u = std::log(Radii[i + local_i_start] / Radii[0]);
+	} else {
+	    u = -std::log(Radii[2 * GlobalNRadial - (i + local_i_start)] /
+			  Radii[0]);
+	}
+
+	for (unsigned int j = 0; j < NAzimuthal; j++) {
+	    const unsigned int l = i * stride + j;
+		const double theta = dphi * (double)j;
+
+	    kernel(u, theta, K_radial[l], K_azimuthal[l]);
 	}
     }
 
@@ -517,13 +704,42 @@ void compute_FFT_kernel()
     fftw_execute(fftplan_forward_K_azimuthal);
 }
 
+/**
+   Normalization of the accelerations of local ring i, see compute_acceleration.
+*/
+static void normalize_acceleration(const unsigned int i)
+{
+	// g_r(u,phi) normalized with exp(-u/2)*Δu*Δphi/(2*N_r*N_phi) (3.43 page
+	// 57) g_phi(u,phi) normalized with exp(-3*u/2)*Δu Δphi/(2*N_r*N_phi)
+	// (3.44 page 57)
+	double normaccr = r_step * t_step /
+		   ((double)(2 * GlobalNRadial) * (double)NAzimuthal);
+	double normacct = normaccr;
+	normaccr /= std::sqrt(Rmed[i] / GlobalRmed[0]);
+	normacct /=
+	    (Rmed[i] / GlobalRmed[0] * std::sqrt(Rmed[i] / GlobalRmed[0]));
+	for (unsigned int j = 0; j < NAzimuthal; j++) {
+	    const unsigned int l = i * NAzimuthal + j;
+	    g_radial[l] *= normaccr;
+	    g_azimuthal[l] *= normacct;
+	}
+}
+
 void compute_acceleration(t_polargrid &density)
 {
-    MPI_Request req1, req3, req4, req5, req6;
+    MPI_Request transfer_req = MPI_REQUEST_NULL;
     const unsigned int nr = density.Nrad;
     const unsigned int stride = 2 * (NAzimuthal / 2 + 1);
     const int one_if_odd = (CPU_Number % 2 == 0 ? 0 : 1);
 
+    // The upper cpus get their accelerations from their friend. The receive
+    // is posted first so the data can arrive while the convolution and the
+    // backward transform are running.
+    if (CPU_Rank != CPU_NoFriend && CPU_Rank >= CPU_Number / 2) {
+	MPI_Irecv(ffttohydro_transfer_friend, transfer_size_friend,
+		  MPI_DOUBLE, CPU_Friend, 40, CPU_Comm, &transfer_req);
+    }
+
     // First we compute sg_acc as a convolution product of reduced density and
     // kernel arrays. In fact, all bufffttabs are transposed arrays, since we
     // used the flag FFTW_TRANSPOSED_ORDER before. However, this is not a
@@ -553,27 +769,21 @@ void compute_acceleration(t_polargrid &density)
     // The use again of argument FFTW_TRANSPOSED_ORDER in these backward fourier
     // transforms ensures that arrays are not transposed anymore. Then we
     // transfer the exact necessary quantity of sg_acceleration arrays from the
-    // fftw d.d. to the hydro mesh
-    if (CPU_Rank != CPU_NoFriend) {
-	if (CPU_Rank < CPU_Number / 2) {
-		#pragma omp parallel for
-	    for (unsigned int i = 0; i < transfer_size; i++) {
-		if (i < transfer_size / 2)
-		    ffttohydro_transfer[i] =
-			acc_radial[((unsigned int) ifront + 1 - CPUOVERLAP) * stride + i];
-		else
-		    ffttohydro_transfer[i] =
-			acc_azimuthal[((unsigned int) ifront + 1 - CPUOVERLAP) * stride + i -
-				      transfer_size / 2];
-	    }
-	    MPI_Isend(ffttohydro_transfer, transfer_size, MPI_DOUBLE,
-		      CPU_Friend, 40, MPI_COMM_WORLD, &req1);
-	    MPI_Wait(&req1, &global_MPI_Status);
-	} else {
-	    MPI_Irecv(ffttohydro_transfer_friend, transfer_size_friend,
-		      MPI_DOUBLE, CPU_Friend, 40, MPI_COMM_WORLD, &req1);
-	    MPI_Wait(&req1, &global_MPI_Status);
+    // fftw d.d. to the hydro mesh. The lower cpus fill their own rings while
+    // the transfer is running.
+    if (CPU_Rank != CPU_NoFriend && CPU_Rank < CPU_Number / 2) {
+	#pragma omp parallel for
+	for (unsigned int i = 0; i < transfer_size; i++) {
+	    if (i < transfer_size / 2)
+		ffttohydro_transfer[i] =
+		    acc_radial[((unsigned int) ifront + 1 - CPUOVERLAP) * stride + i];
+	    else
+		ffttohydro_transfer[i] =
+		    acc_azimuthal[((unsigned int) ifront + 1 - CPUOVERLAP) * stride + i -
+				  transfer_size / 2];
 	}
+	MPI_Isend(ffttohydro_transfer, transfer_size, MPI_DOUBLE,
+		  CPU_Friend, 40, CPU_Comm, &transfer_req);
     }
 
     // We now compute sg_acceleration arrays on the hydro mesh
@@ -600,6 +810,8 @@ void compute_acceleration(t_polargrid &density)
 	}
     }
 
+    MPI_Wait(&transfer_req, &global_MPI_Status);
+
     if (CPU_Rank >= (CPU_Number + one_if_odd) / 2) {
 	if (CPU_Rank == CPU_Highest) {
 		#pragma omp parallel for collapse(2)
@@ -626,66 +838,79 @@ void compute_acceleration(t_polargrid &density)
 	}
     }
 
-    // Now we exchange the correct amount of sg_acceleration between cpus to
-    // fill ghosts.
-
+    // Now we exchange the ghosts of both acceleration components between
+    // neighbouring blocks of the fftw d.d. in a single message. The rings
+    // that are sent are normalized first, the remaining rings are
+    // normalized while the exchange is running. Received ghosts are already
+    // normalized by the sender.
     const unsigned int ghost_size = CPUOVERLAP * NAzimuthal;
-    if (CPU_Number > 1) {
-	if ((CPU_Rank > 0) && (CPU_Rank < (CPU_Number + one_if_odd) / 2)) {
-	    MPI_Isend(&g_azimuthal[Zero_or_active * NAzimuthal], ghost_size,
-		      MPI_DOUBLE, CPU_Prev, 60, MPI_COMM_WORLD, &req3);
-	    MPI_Wait(&req3, &global_MPI_Status);
-	    MPI_Irecv(&g_azimuthal[0], ghost_size, MPI_DOUBLE, CPU_Prev, 61,
-		      MPI_COMM_WORLD, &req4);
-	    MPI_Wait(&req4, &global_MPI_Status);
-	}
-	if ((CPU_Rank >= (CPU_Number + one_if_odd) / 2) &&
-	    (CPU_Rank != CPU_Highest)) {
-	    MPI_Irecv(&g_azimuthal[Max_or_active * NAzimuthal], ghost_size,
-		      MPI_DOUBLE, CPU_Next, 60, MPI_COMM_WORLD, &req3);
-	    MPI_Wait(&req3, &global_MPI_Status);
-	    MPI_Isend(&g_azimuthal[(Max_or_active - CPUOVERLAP) * NAzimuthal],
-		      ghost_size, MPI_DOUBLE, CPU_Next, 61, MPI_COMM_WORLD,
-		      &req4);
-	    MPI_Wait(&req4, &global_MPI_Status);
-	}
-	if ((CPU_Rank > 0) && (CPU_Rank < (CPU_Number + one_if_odd) / 2)) {
-	    MPI_Isend(&g_radial[Zero_or_active * NAzimuthal], ghost_size,
-		      MPI_DOUBLE, CPU_Prev, 50, MPI_COMM_WORLD, &req5);
-	    MPI_Wait(&req5, &global_MPI_Status);
-	    MPI_Irecv(&g_radial[0], ghost_size, MPI_DOUBLE, CPU_Prev, 51,
-		      MPI_COMM_WORLD, &req6);
-	    MPI_Wait(&req6, &global_MPI_Status);
-	}
-	if ((CPU_Rank >= (CPU_Number + one_if_odd) / 2) &&
-	    (CPU_Rank != CPU_Highest)) {
-	    MPI_Irecv(&g_radial[Max_or_active * NAzimuthal], ghost_size,
-		      MPI_DOUBLE, CPU_Next, 50, MPI_COMM_WORLD, &req5);
-	    MPI_Wait(&req5, &global_MPI_Status);
-	    MPI_Isend(&g_radial[(Max_or_active - CPUOVERLAP) * NAzimuthal],
-		      ghost_size, MPI_DOUBLE, CPU_Next, 51, MPI_COMM_WORLD,
-		      &req6);
-	    MPI_Wait(&req6, &global_MPI_Status);
+    const bool exchange_prev = (CPU_Number > 1) && (CPU_Rank > 0) &&
+			       (CPU_Rank < (CPU_Number + one_if_odd) / 2);
+    const bool exchange_next = (CPU_Number > 1) &&
+			       (CPU_Rank >= (CPU_Number + one_if_odd) / 2) &&
+			       (CPU_Rank != CPU_Highest);
+
+    unsigned int send_start = 0;
+    unsigned int recv_start = 0;
+    int neighbour = MPI_PROC_NULL;
+    int send_tag = 0;
+    int recv_tag = 0;
+    if (exchange_prev) {
+	send_start = Zero_or_active;
+	recv_start = 0;
+	neighbour = CPU_Prev;
+	send_tag = 60;
+	recv_tag = 61;
+    } else if (exchange_next) {
+	send_start = Max_or_active - CPUOVERLAP;
+	recv_start = Max_or_active;
+	neighbour = CPU_Next;
+	send_tag = 61;
+	recv_tag = 60;
+    }
+    const bool exchange = exchange_prev || exchange_next;
+
+    static std::vector<double> halo_send;
+    static std::vector<double> halo_recv;
+    MPI_Request halo_req[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+
+    if (exchange) {
+	halo_send.resize(2 * ghost_size);
+	halo_recv.resize(2 * ghost_size);
+
+	MPI_Irecv(halo_recv.data(), 2 * ghost_size, MPI_DOUBLE, neighbour,
+		  recv_tag, CPU_Comm, &halo_req[0]);
+
+	for (unsigned int i = send_start; i < send_start + CPUOVERLAP; i++) {
+	    normalize_acceleration(i);
 	}
+	std::copy(&g_radial[send_start * NAzimuthal],
+		  &g_radial[send_start * NAzimuthal + ghost_size],
+		  halo_send.begin());
+	std::copy(&g_azimuthal[send_start * NAzimuthal],
+		  &g_azimuthal[send_start * NAzimuthal + ghost_size],
+		  halo_send.begin() + ghost_size);
+
+	MPI_Isend(halo_send.data(), 2 * ghost_size, MPI_DOUBLE, neighbour,
+		  send_tag, CPU_Comm, &halo_req[1]);
     }
 
     // We don't forget to renormalize acc arrays!
 	#pragma omp parallel for
     for (unsigned int i = 0; i < nr; i++) {
-	// g_r(u,phi) normalized with exp(-u/2)*Δu*Δphi/(2*N_r*N_phi) (3.43 page
-	// 57) g_phi(u,phi) normalized with exp(-3*u/2)*Δu Δphi/(2*N_r*N_phi)
-	// (3.44 page 57)
-	double normaccr = r_step * t_step /
-		   ((double)(2 * GlobalNRadial) * (double)NAzimuthal);
-	double normacct = normaccr;
-	normaccr /= std::sqrt(Rmed[i] / GlobalRmed[0]);
-	normacct /=
-	    (Rmed[i] / GlobalRmed[0] * std::sqrt(Rmed[i] / GlobalRmed[0]));
-	for (unsigned int j = 0; j < NAzimuthal; j++) {
-	    const unsigned int l = i * NAzimuthal + j;
-	    g_radial[l] *= normaccr;
-	    g_azimuthal[l] *= normacct;
+	if (exchange && ((i >= send_start && i < send_start + CPUOVERLAP) ||
+			 (i >= recv_start && i < recv_start + CPUOVERLAP))) {
+	    continue;
 	}
+	normalize_acceleration(i);
+    }
+
+    if (exchange) {
+	MPI_Waitall(2, halo_req, MPI_STATUSES_IGNORE);
+	std::copy(halo_recv.begin(), halo_recv.begin() + ghost_size,
+		  &g_radial[recv_start * NAzimuthal]);
+	std::copy(halo_recv.begin() + ghost_size, halo_recv.end(),
+		  &g_azimuthal[recv_start * NAzimuthal]);
     }
 #ifdef EPSILON_SMOOTHING_SG
 	// Eventually, we take the compensation from selfforce into account
@@ -702,6 +927,151 @@ void compute_acceleration(t_polargrid &density)
 #endif
 }
 
+/**
+   Transforms the kernels of all pairs of local and global rings in azimuth.
+   The factors r^(-1/2) r'^(-3/2) and r^(-3/2) r'^(-1/2) that turn the kernels
+   in u = log(r/r') into accelerations of unit masses are included, as are
+   -G and the 1/NAzimuthal normalization of the backward transform.
+*/
+static void compute_modal_kernel()
+{
+    const unsigned int N_modes = modal_N_modes;
+    const double norm = -constants::G / (double)NAzimuthal;
+
+	#pragma omp parallel
+    {
+	double *K_r = fftw_alloc_real(NAzimuthal);
+	double *K_phi = fftw_alloc_real(NAzimuthal);
+	fftw_complex *FFT_K_r = fftw_alloc_complex(N_modes);
+	fftw_complex *FFT_K_phi = fftw_alloc_complex(N_modes);
+
+	#pragma omp for collapse(2) schedule(static)
+	for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	    for (unsigned int i = 0; i < GlobalNRadial; ++i) {
+		const double r = Rmed[nr];
+		const double r_source = GlobalRmed[i];
+		const double u = std::log(r / r_source);
+
+		for (unsigned int j = 0; j < NAzimuthal; ++j) {
+		    kernel(u, dphi * (double)j, K_r[j], K_phi[j]);
+		}
+
+		fftw_execute_dft_r2c(modal_plan_kernel, K_r, FFT_K_r);
+		fftw_execute_dft_r2c(modal_plan_kernel, K_phi, FFT_K_phi);
+
+		const double factor_r =
+		    norm / (std::sqrt(r) * r_source * std::sqrt(r_source));
+		const double factor_phi =
+		    norm / (r * std::sqrt(r) * std::sqrt(r_source));
+
+		for (unsigned int m = 0; m < N_modes; ++m) {
+		    const size_t l = ((size_t)nr * N_modes + m) * GlobalNRadial + i;
+		    modal_K_radial[l] = factor_r * FFT_K_r[m][0];
+		    modal_K_azimuthal[l] = factor_phi * FFT_K_phi[m][1];
+		}
+	    }
+	}
+
+	fftw_free(K_r);
+	fftw_free(K_phi);
+	fftw_free(FFT_K_r);
+	fftw_free(FFT_K_phi);
+    }
+}
+
+/**
+   Computes the acceleration with the modal solver. Every process sums over
+   all global source rings for its local rings including the ghosts, so no
+   ghost exchange is needed afterwards.
+*/
+static void compute_modal(t_polargrid &density)
+{
+    const unsigned int N_modes = modal_N_modes;
+
+    // ring masses, transformed in azimuth
+	#pragma omp parallel for collapse(2)
+    for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    modal_mass[nr * NAzimuthal + naz] = density(nr, naz) * Surf[nr];
+	}
+    }
+    fftw_execute(modal_plan_forward);
+
+    // gather the active rings of all processes
+    MPI_Allgatherv(&modal_FFT_mass[Zero_or_active * N_modes],
+		   modal_counts[CPU_Rank], MPI_DOUBLE, modal_FFT_mass_global,
+		   modal_counts.data(), modal_displacements.data(), MPI_DOUBLE,
+		   CPU_Comm);
+
+	#pragma omp parallel for collapse(2)
+    for (unsigned int m = 0; m < N_modes; ++m) {
+	for (unsigned int i = 0; i < GlobalNRadial; ++i) {
+	    modal_S_real[m * GlobalNRadial + i] =
+		modal_FFT_mass_global[i * N_modes + m][0];
+	    modal_S_imag[m * GlobalNRadial + i] =
+		modal_FFT_mass_global[i * N_modes + m][1];
+	}
+    }
+
+    // radial sum for every local ring and mode
+    fftw_complex *FFT_acc_r = modal_FFT_acc;
+    fftw_complex *FFT_acc_phi = &modal_FFT_acc[NRadial * N_modes];
+
+	#pragma omp parallel for collapse(2) schedule(static)
+    for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	for (unsigned int m = 0; m < N_modes; ++m) {
+	    const size_t offset = ((size_t)nr * N_modes + m) * GlobalNRadial;
+	    const double *K_r = &modal_K_radial[offset];
+	    const double *K_phi = &modal_K_azimuthal[offset];
+	    const double *S_real = &modal_S_real[m * GlobalNRadial];
+	    const double *S_imag = &modal_S_imag[m * GlobalNRadial];
+
+	    double acc_r_real = 0.0;
+	    double acc_r_imag = 0.0;
+	    double acc_phi_real = 0.0;
+	    double acc_phi_imag = 0.0;
+	    #pragma omp simd reduction(+ : acc_r_real, acc_r_imag, acc_phi_real, acc_phi_imag)
+	    for (unsigned int i = 0; i < GlobalNRadial; ++i) {
+		acc_r_real += K_r[i] * S_real[i];
+		acc_r_imag += K_r[i] * S_imag[i];
+		acc_phi_real += K_phi[i] * S_real[i];
+		acc_phi_imag += K_phi[i] * S_imag[i];
+	    }
+
+	    FFT_acc_r[nr * N_modes + m][0] = acc_r_real;
+	    FFT_acc_r[nr * N_modes + m][1] = acc_r_imag;
+	    // the transform of the azimuthal kernel is imaginary
+	    FFT_acc_phi[nr * N_modes + m][0] = -acc_phi_imag;
+	    FFT_acc_phi[nr * N_modes + m][1] = acc_phi_real;
+	}
+    }
+
+    fftw_execute(modal_plan_backward);
+
+    const double *acc_r = modal_acc;
+    const double *acc_phi = &modal_acc[NRadial * NAzimuthal];
+	#pragma omp parallel for collapse(2)
+    for (unsigned int nr = 0; nr < NRadial; ++nr) {
+	for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+	    const unsigned int l = nr * NAzimuthal + naz;
+	    g_radial[l] = acc_r[l];
+	    g_azimuthal[l] = acc_phi[l];
+	}
+    }
+#ifdef EPSILON_SMOOTHING_SG
+	// compensation from selfforce as in the polar method, with the
+	// log width of the ring instead of r_step
+	#pragma omp parallel for collapse(2)
+	for (unsigned int nr = 0; nr < NRadial; ++nr) {
+		for (unsigned int naz = 0; naz < NAzimuthal; ++naz) {
+			const unsigned int l = nr * NAzimuthal + naz;
+			g_radial[l] += constants::G * density.Field[l] *
+				std::log(Rsup[nr] / Rinf[nr]) * dphi / epsilon;
+		}
+	}
+#endif
+}
+
 /**
    Update the velocity fields to take into account self-gravity
 
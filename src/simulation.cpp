@@ -16,10 +16,16 @@
 #include "accretion.h"
 #include "cfl.h"
 #include "quantities.h"
+#include "velocity_gradient.h"
+#include "derived_fields.h"
 #include "pvte_law.h"
 #include "fld.h"
 #include "options.h"
 #include "global.h"
+#include "mode_analysis.h"
+#include "output_products.h"
+#include "load_balance.h"
+#include <future>
 
 namespace sim {
 
@@ -63,6 +69,10 @@ void handle_outputs(t_data &data) {
 	if (to_write_snapshot) {
 	    need_update_for_output = false;
 		write_snapshot(data);
+		if (parameters::load_balancing) {
+			load_balance::write_costs();
+			load_balance::rebalance(data);
+		}
 	}
 
 	if (to_write_snapshot && parameters::write_torques) {
@@ -87,6 +97,12 @@ void handle_outputs(t_data &data) {
 			output::write_lightcurves(data, N_snapshot, need_update_for_output);
 		}
 
+		if (parameters::write_mode_analysis) {
+			mode_analysis::write(data);
+		}
+
+		output_products::write(data);
+
 		fld::write_logfile(output::outdir + "/monitor/fld.log");
 	}
 
@@ -176,7 +192,9 @@ static void step_Euler(t_data &data, const double dt) {
 
 	if (parameters::integrate_particles) {
 		particles::update_velocities_from_indirect_term(dt);
+		load_balance::start_timer();
 		particles::integrate(data, time, dt);
+		load_balance::stop_timer();
 	}
 
 	/* Below we correct v_azimuthal, planet's position and velocities if we
@@ -186,6 +204,7 @@ static void step_Euler(t_data &data, const double dt) {
 	/* Now we update gas */
 	if (parameters::calculate_disk) {
 		//HandleCrash(data);
+		load_balance::start_timer();
 
 	    update_with_sourceterms(data, dt);
 
@@ -201,6 +220,7 @@ static void step_Euler(t_data &data, const double dt) {
 	    if (parameters::Adiabatic) {
 			SubStep3(data, time, dt);
 		}
+		load_balance::stop_timer();
 	}
 
 	/* Do radiative transport. This can be done independent of the hydro simulation. */
@@ -208,20 +228,44 @@ static void step_Euler(t_data &data, const double dt) {
 		    fld::radiative_diffusion(data, time, dt);
 	}
 	    
+	/** Planets' positions and velocities are updated from gravitational
+	 * interaction with star and other planets */
+	const double nbody_time = time;
+	auto integrate_nbody = [&data, nbody_time, dt]() {
+		data.get_planetary_system().integrate(nbody_time, dt);
+		data.get_planetary_system().copy_data_from_rebound();
+		data.get_planetary_system().move_to_hydro_center_and_update_orbital_parameters();
+	};
+
 	/* Continue with hydro simulation */
 	if (parameters::calculate_disk) {
 		boundary_conditions::apply_boundary_condition(data, time, 0.0, false);
 
+		// Transport does not use the nbody system (only OmegaFrame, which
+		// is fixed at this point), so both can run at the same time,
+		// except for the Roche lobe overflow boundary and the
+		// eccentricity growth monitor. The nbody thread must not call MPI.
+		std::future<void> nbody_step;
+		if (parameters::integrate_nbody_concurrently &&
+			!boundary_conditions::rochelobe_overflow && !ECC_GROWTH_MONITOR) {
+			nbody_step = std::async(std::launch::async, integrate_nbody);
+		}
+
+		load_balance::start_timer();
 		Transport(data, &data[t_data::SIGMA], &data[t_data::V_RADIAL],
 				&data[t_data::V_AZIMUTHAL], &data[t_data::ENERGY],
 				dt);
-	}
+		load_balance::stop_timer();
 
-	/** Planets' positions and velocities are updated from gravitational
-	 * interaction with star and other planets */
-	data.get_planetary_system().integrate(time, dt);
-	data.get_planetary_system().copy_data_from_rebound();
-	data.get_planetary_system().move_to_hydro_center_and_update_orbital_parameters();
+		if (nbody_step.valid()) {
+			nbody_step.get();
+		} else {
+			integrate_nbody();
+		}
+	} else {
+		integrate_nbody();
+	}
+	derived_fields::changed(derived_fields::input_nbody);
 
 	time += dt;
 	N_hydro_iter = N_hydro_iter + 1;
@@ -248,6 +292,7 @@ static void step_Euler(t_data &data, const double dt) {
 		    quantities::gas_total_mass(data, RMAX);
 		data[t_data::SIGMA] *=
 		    (total_disk_mass_old / total_disk_mass_new);
+		derived_fields::changed(derived_fields::input_hydro);
 	    }
 
 	    quantities::CalculateMonitorQuantitiesAfterHydroStep(data, N_monitor,
@@ -290,6 +335,7 @@ static void step_Euler(t_data &data, const double dt) {
 	data.get_planetary_system().integrate(start_time, frog_dt);
 	data.get_planetary_system().copy_data_from_rebound();
 	data.get_planetary_system().move_to_hydro_center_and_update_orbital_parameters();
+	derived_fields::changed(derived_fields::input_nbody);
 
 	if (parameters::disk_feedback) {
 		ComputeDiskOnNbodyAccel(data);
@@ -414,6 +460,7 @@ static void step_Euler(t_data &data, const double dt) {
 	data.get_planetary_system().integrate(midstep_time, frog_dt);
 	data.get_planetary_system().copy_data_from_rebound();
 	data.get_planetary_system().move_to_hydro_center_and_update_orbital_parameters();
+	derived_fields::changed(derived_fields::input_nbody);
 
 	/* Below we correct v_azimuthal, planet's position and velocities if we
 	 * work in a frame non-centered on the star. Same for dust particles. */
@@ -447,6 +494,7 @@ static void step_Euler(t_data &data, const double dt) {
 			quantities::gas_total_mass(data, RMAX);
 			 data[t_data::SIGMA] *=
 			(total_disk_mass_old / total_disk_mass_new);
+			derived_fields::changed(derived_fields::input_hydro);
 		}
 
 		quantities::CalculateMonitorQuantitiesAfterHydroStep(data, N_monitor,
@@ -483,6 +531,9 @@ void init(t_data &data) {
 }
 
 static void step(t_data &data, const double step_dt) {
+	velocity_gradient::invalidate();
+	// outputs may have overwritten derived grids, e.g. the scale height
+	derived_fields::invalidate();
 	switch (parameters::hydro_integrator) {
 		case EULER_INTEGRATOR:
 			step_Euler(data, step_dt);
@@ -0,0 +1,175 @@
+/**
+	\file snapshot_writer.cpp
+
+	Collective writer for the files of a snapshot.
+
+	Every write gives the data of this process together with its offset in
+	the file, in units of the datatype. All processes have to issue the same
+	writes in the same order, as for the MPI-IO calls they replace.
+
+	Outside of a batch a write opens, writes and closes its file right away.
+	Inside a batch the writes are queued and issued at end_batch: all files
+	are opened first, then all writes are posted with
+	MPI_File_iwrite_at_all and completed together. The total size and the
+	achieved bandwidth of a batch are logged.
+
+	The MPI_Info hints given with MPIIOHints, e.g.
+	"cb_nodes=8 striping_factor=16 striping_unit=4194304
+	romio_cb_write=enable", are passed to every open.
+*/
+
+#include "snapshot_writer.h"
+#include "LowTasks.h"
+#include "global.h"
+#include "logging.h"
+#include "mpi_utils.h"
+#include "parameters.h"
+
+namespace snapshot_writer
+{
+
+struct t_write {
+    std::string filename;
+    const void *buffer;
+    int count;
+    MPI_Datatype type;
+    MPI_Offset offset;
+    // data owned by the writer, buffer points into it
+    std::vector<double> owned;
+};
+
+static MPI_Info info = MPI_INFO_NULL;
+static bool info_initialized = false;
+
+static bool batch_active = false;
+static std::vector<t_write> queue;
+
+/**
+	MPI_Info with the hints from MPIIOHints, MPI_INFO_NULL if none are set.
+*/
+MPI_Info get_info()
+{
+    if (info_initialized) {
+	return info;
+    }
+    info_initialized = true;
+
+    if (parameters::mpi_io_hints.empty()) {
+	return info;
+    }
+
+    MPI_Info_create(&info);
+    for (const std::string &hint : parameters::mpi_io_hints) {
+	const size_t separator = hint.find('=');
+	if (separator == std::string::npos || separator == 0) {
+	    die("Invalid MPI-IO hint '%s', expected key=value!\n",
+		hint.c_str());
+	}
+	const std::string key = hint.substr(0, separator);
+	const std::string value = hint.substr(separator + 1);
+	MPI_Info_set(info, key.c_str(), value.c_str());
+    }
+
+    return info;
+}
+
+void free_info()
+{
+    if (info != MPI_INFO_NULL) {
+	MPI_Info_free(&info);
+    }
+    info_initialized = false;
+}
+
+static void open_file(const t_write &w, MPI_File &fh)
+{
+    mpi_error_check_file_write(MPI_File_open(CPU_Comm, w.filename.c_str(),
+					     MPI_MODE_WRONLY | MPI_MODE_CREATE,
+					     get_info(), &fh),
+			       w.filename);
+    MPI_File_set_view(fh, 0, w.type, w.type, const_cast<char *>("native"),
+		      get_info());
+}
+
+void begin_batch()
+{
+    batch_active = true;
+    queue.clear();
+}
+
+void write(const std::string &filename, const void *buffer, const int count,
+	   MPI_Datatype type, const MPI_Offset offset)
+{
+    if (batch_active) {
+	queue.push_back({filename, buffer, count, type, offset, {}});
+	return;
+    }
+
+    t_write w = {filename, buffer, count, type, offset, {}};
+    MPI_File fh;
+    MPI_Status status;
+    open_file(w, fh);
+    MPI_File_write_at_all(fh, w.offset, w.buffer, w.count, w.type, &status);
+    MPI_File_close(&fh);
+}
+
+void write(const std::string &filename, std::vector<double> &&buffer,
+	   const MPI_Offset offset)
+{
+    if (batch_active) {
+	queue.push_back(
+	    {filename, nullptr, (int)buffer.size(), MPI_DOUBLE, offset, {}});
+	queue.back().owned = std::move(buffer);
+	return;
+    }
+
+    write(filename, buffer.data(), buffer.size(), MPI_DOUBLE, offset);
+}
+
+void end_batch()
+{
+    batch_active = false;
+
+    const double start = MPI_Wtime();
+
+    const unsigned int n = queue.size();
+    std::vector<MPI_File> files(n);
+    std::vector<MPI_Request> requests(n);
+
+    for (unsigned int i = 0; i < n; ++i) {
+	open_file(queue[i], files[i]);
+    }
+
+    double bytes = 0.0;
+    for (unsigned int i = 0; i < n; ++i) {
+	t_write &w = queue[i];
+	const void *buffer = w.buffer != nullptr ? w.buffer : w.owned.data();
+	MPI_File_iwrite_at_all(files[i], w.offset, buffer, w.count, w.type,
+			       &requests[i]);
+
+	int type_size;
+	MPI_Type_size(w.type, &type_size);
+	bytes += (double)w.count * type_size;
+    }
+
+    MPI_Waitall(n, requests.data(), MPI_STATUSES_IGNORE);
+
+    for (unsigned int i = 0; i < n; ++i) {
+	MPI_File_close(&files[i]);
+    }
+
+    double elapsed = MPI_Wtime() - start;
+    MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, CPU_Comm);
+    MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, CPU_Comm);
+
+    if (n > 0) {
+	logging::print_master(
+	    LOG_INFO "Wrote %u files with %.1f MB in %.3f s (%.1f MB/s).\n", n,
+	    bytes / 1048576.0, elapsed,
+	    elapsed > 0.0 ? bytes / 1048576.0 / elapsed : 0.0);
+    }
+
+    queue.clear();
+}
+
+} // namespace snapshot_writer
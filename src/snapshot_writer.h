@@ -0,0 +1,26 @@
+#pragma once
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+// Collective MPI-IO writes of snapshot files. Writes issued between
+// begin_batch and end_batch are collected, all files are opened together and
+// written with nonblocking collective calls, so the MPI library can aggregate
+// them (two-phase I/O) and overlap the fields.
+
+namespace snapshot_writer
+{
+
+MPI_Info get_info();
+void free_info();
+
+void begin_batch();
+void end_batch();
+
+void write(const std::string &filename, const void *buffer, const int count,
+	   MPI_Datatype type, const MPI_Offset offset);
+void write(const std::string &filename, std::vector<double> &&buffer,
+	   const MPI_Offset offset);
+
+} // namespace snapshot_writer
@@ -2,6 +2,7 @@
 #include "LowTasks.h"
 #include "constants.h"
 #include "global.h"
+#include "load_balance.h"
 #include "logging.h"
 #include "parameters.h"
 #include <vector>
@@ -30,8 +31,10 @@ void SplitDomain()
 
     GlobalNRadial = NRadial;
 
-    /* Standard domain decomposition */
-    if (!parameters::self_gravity) {
+    /* Standard domain decomposition, also used by the modal self-gravity
+     * solver */
+    if (!parameters::self_gravity ||
+	parameters::self_gravity_solver == parameters::sg_solver_modal) {
 	logging::print_master(
 	    LOG_DEBUG "SplitDomain: Doing standard domain decomposition.\n");
 
@@ -46,7 +49,11 @@ void SplitDomain()
 	    PersonalExit(1);
 	}
 
-	if (CPU_Rank < remainder) {
+	std::vector<unsigned int> first_ring;
+	if (load_balance::get_partition(first_ring)) {
+	    IMIN = first_ring[CPU_Rank];
+	    IMAX = first_ring[CPU_Rank + 1] - 1;
+	} else if (CPU_Rank < remainder) {
 	    IMIN = size_high * CPU_Rank;
 	    IMAX = IMIN + size_high - 1;
 	} else {
@@ -98,7 +105,7 @@ void SplitDomain()
 	#ifndef DISABLE_FFTW
 	// calculate fft mesh sizes
 	total_local_size = fftw_mpi_local_size_2d_transposed(
-	    2 * GlobalNRadial, NAzimuthal, MPI_COMM_WORLD, &local_Nx,
+	    2 * GlobalNRadial, NAzimuthal, CPU_Comm, &local_Nx,
 	    &local_i_start, &local_Ny_after_transpose,
 	    &local_j_start_after_transpose);
 	#endif
@@ -199,9 +206,9 @@ void SplitDomain()
 	    sg_split[4] = transfer_size;
 
 	    if (CPU_Rank != CPU_NoFriend)
-		MPI_Send(sg_split, 5, MPI_AINT, CPU_Friend, 10, MPI_COMM_WORLD);
+		MPI_Send(sg_split, 5, MPI_AINT, CPU_Friend, 10, CPU_Comm);
 	} else {
-	    MPI_Recv(hydro_split, 5, MPI_AINT, CPU_Friend, 10, MPI_COMM_WORLD,
+	    MPI_Recv(hydro_split, 5, MPI_AINT, CPU_Friend, 10, CPU_Comm,
 		     &global_MPI_Status);
 	    IMAX_friend = hydro_split[0];
 	    local_i_start_friend = hydro_split[1];
@@ -273,14 +280,14 @@ void SplitDomain()
 	if ((CPU_Number % 2 == 0) || (CPU_Rank != CPU_NoFriend)) {
 	    if (CPU_Rank >= (CPU_Number + one_if_odd) / 2) {
 		MPI_Ssend(&active_hydro_totalsize, 1, MPI_INT, CPU_Friend, 20,
-			  MPI_COMM_WORLD);
+			  CPU_Comm);
 		MPI_Ssend(&Zero_or_active, 1, MPI_INT, CPU_Friend, 22,
-			  MPI_COMM_WORLD);
+			  CPU_Comm);
 	    } else {
 		MPI_Recv(&active_hydro_totalsize_friend, 1, MPI_INT, CPU_Friend,
-			 20, MPI_COMM_WORLD, &global_MPI_Status);
+			 20, CPU_Comm, &global_MPI_Status);
 		MPI_Recv(&Zero_or_active_friend, 1, MPI_INT, CPU_Friend, 22,
-			 MPI_COMM_WORLD, &global_MPI_Status);
+			 CPU_Comm, &global_MPI_Status);
 		dens_friend = (double *)malloc(sizeof(double) *
 					       active_hydro_totalsize_friend);
 		if (dens_friend == NULL) {
@@ -311,13 +318,13 @@ void SplitDomain()
 
     const int send_size = local_array_end - local_array_start + 1;
 
-    MPI_Gather(&IMAX, 1, MPI_INT, RootIMAX, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Gather(&IMIN, 1, MPI_INT, RootIMIN, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Gather(&IMAX, 1, MPI_INT, RootIMAX, 1, MPI_INT, 0, CPU_Comm);
+    MPI_Gather(&IMIN, 1, MPI_INT, RootIMIN, 1, MPI_INT, 0, CPU_Comm);
     MPI_Gather(&send_size, 1, MPI_INT, RootNradialLocalSizes, 1, MPI_INT, 0,
-	       MPI_COMM_WORLD);
+	       CPU_Comm);
 
     MPI_Gather(&CPU_Next, 1, MPI_INT, RootRanksOrdered, 1, MPI_INT, 0,
-	       MPI_COMM_WORLD);
+	       CPU_Comm);
 
     if (CPU_Master) {
 
@@ -348,7 +355,8 @@ void SplitDomain()
 
     /* print debugging */
     logging::print(LOG_DEBUG "SplitDomain: DomainSplit Information:\n");
-    if (!parameters::self_gravity)
+    if (!parameters::self_gravity ||
+	parameters::self_gravity_solver == parameters::sg_solver_modal)
 	logging::print_master(LOG_DEBUG "SplitDomain: %d = %d * %d + %d\n",
 			      GlobalNRadial, CPU_Number, size_low, remainder);
     logging::print(LOG_DEBUG "SplitDomain: IMIN: %d\n", IMIN);
@@ -363,7 +371,8 @@ void SplitDomain()
 		   radial_active_size);
     logging::print(LOG_DEBUG "SplitDomain: GLOB: %d\n", GlobalNRadial);
     logging::print(LOG_DEBUG "SplitDomain: CPUOVERLAP: %d\n", CPUOVERLAP);
-    if (parameters::self_gravity) {
+    if (parameters::self_gravity &&
+	parameters::self_gravity_solver == parameters::sg_solver_polar) {
 	logging::print(LOG_DEBUG "SplitDomain: LocalNx: %ld\n", local_Nx);
 	logging::print(LOG_DEBUG "SplitDomain: LocalIStart: %ld\n",
 		       local_i_start);
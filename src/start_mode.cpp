@@ -94,16 +94,16 @@ void configure_start_mode()
 	}
     }
 
-    MPI_Bcast(&restart_debug, 1, MPI_INT32_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&restart_from, 1, MPI_INT32_T, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&mode, 1, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&restart_debug, 1, MPI_INT32_T, 0, CPU_Comm);
+    MPI_Bcast(&restart_from, 1, MPI_INT32_T, 0, CPU_Comm);
+    MPI_Bcast(&mode, 1, MPI_UINT32_T, 0, CPU_Comm);
 
     int line_size = output::snapshot_dir.size();
-    MPI_Bcast(&line_size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&line_size, 1, MPI_INT, 0, CPU_Comm);
     if (!CPU_Master)
 	output::snapshot_dir.resize(line_size);
     MPI_Bcast(const_cast<char *>(output::snapshot_dir.data()), line_size, MPI_CHAR, 0,
-	      MPI_COMM_WORLD);
+	      CPU_Comm);
 }
 
 } // namespace start_mode
@@ -497,7 +497,7 @@ void write_code_units_file()
 
 	of.close();
 	}
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(CPU_Comm);
 }
 
 
@@ -25,6 +25,21 @@ bool is_number(std::string s)
     return true;
 }
 
+/**
+	Split a space or comma separated list into its entries.
+*/
+std::vector<std::string> split_list(const std::string &list)
+{
+    std::vector<std::string> entries;
+    size_t token_start = list.find_first_not_of(" ,");
+    while (token_start != std::string::npos) {
+	const size_t token_end = list.find_first_of(" ,", token_start);
+	entries.push_back(list.substr(token_start, token_end - token_start));
+	token_start = list.find_first_not_of(" ,", token_end);
+    }
+    return entries;
+}
+
 unsigned int get_next_azimuthal_id(const unsigned int id)
 {
     unsigned int id_next = id + 1;
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 bool is_number(std::string s);
+std::vector<std::string> split_list(const std::string &list);
 
 unsigned int get_next_azimuthal_id(const unsigned int id);
 unsigned int get_prev_azimuthal_id(const unsigned int id);
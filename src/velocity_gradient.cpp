@@ -0,0 +1,94 @@
+/**
+	\file velocity_gradient.cpp
+
+	Velocity gradient stage of a hydro (sub)step.
+
+	All components of the strain rate are computed in a single sweep over
+	the grid and stored in contiguous arrays. Consumers get them through
+	get(), which only recomputes them if the velocities were changed since.
+	Every update of V_RADIAL or V_AZIMUTHAL inside a step has to call
+	invalidate(); the stage is also invalidated at the start of every step.
+*/
+
+#include "velocity_gradient.h"
+#include "global.h"
+
+namespace velocity_gradient
+{
+
+static t_strain_rate strain_rate;
+static bool valid = false;
+
+static void compute(t_data &data)
+{
+    const t_polargrid &v_radial = data[t_data::V_RADIAL];
+    const t_polargrid &v_azimuthal = data[t_data::V_AZIMUTHAL];
+
+    const unsigned int Nr = data[t_data::SIGMA].get_size_radial();
+    const unsigned int Nphi = data[t_data::SIGMA].get_size_azimuthal();
+
+    if (strain_rate.Nrad != Nr || strain_rate.Nsec != Nphi) {
+	strain_rate.Nrad = Nr;
+	strain_rate.Nsec = Nphi;
+	strain_rate.div_v.assign(Nr * Nphi, 0.0);
+	strain_rate.eps_rr.assign(Nr * Nphi, 0.0);
+	strain_rate.eps_pp.assign(Nr * Nphi, 0.0);
+	strain_rate.eps_rp.assign(Nr * Nphi, 0.0);
+    }
+
+    double *const div_v = strain_rate.div_v.data();
+    double *const eps_rr = strain_rate.eps_rr.data();
+    double *const eps_pp = strain_rate.eps_pp.data();
+    double *const eps_rp = strain_rate.eps_rp.data();
+
+    #pragma omp parallel for
+    for (unsigned int nr = 0; nr < Nr; ++nr) {
+	for (unsigned int naz = 0; naz < Nphi; ++naz) {
+	    const unsigned int naz_next = (naz == Nphi - 1 ? 0 : naz + 1);
+	    const unsigned int naz_prev = (naz == 0 ? Nphi - 1 : naz - 1);
+	    const unsigned int id = nr * Nphi + naz;
+
+	    const double vr = v_radial(nr, naz);
+	    const double vr_next = v_radial(nr + 1, naz);
+	    const double vphi = v_azimuthal(nr, naz);
+	    const double dvphi = v_azimuthal(nr, naz_next) - vphi;
+
+	    // div(v) = 1/r d(r*v_r)/dr + 1/r d(v_phi)/dphi
+	    div_v[id] = (vr_next * Ra[nr + 1] - vr * Ra[nr]) * InvDiffRsupRb[nr] +
+			dvphi * invdphi * InvRb[nr];
+
+	    // d(v_r)/dr
+	    eps_rr[id] = (vr_next - vr) * InvDiffRsup[nr];
+
+	    // 1/r d(v_phi)/dphi + v_r/r
+	    eps_pp[id] =
+		InvRmed[nr] * (dvphi * invdphi + 0.5 * (vr_next + vr));
+
+	    if (nr > 0) {
+		// r*d(v_phi/r)/dr + 1/r d(v_r)/dphi
+		const double dvazirdr = (vphi * InvRb[nr] -
+					 v_azimuthal(nr - 1, naz) * InvRb[nr - 1]) *
+					InvDiffRmed[nr];
+		const double dvrdphi = (vr - v_radial(nr, naz_prev)) * invdphi;
+		eps_rp[id] = Ra[nr] * dvazirdr + dvrdphi * InvRa[nr];
+	    }
+	}
+    }
+
+    valid = true;
+}
+
+/**
+	Strain rate of the current velocities.
+*/
+const t_strain_rate &get(t_data &data)
+{
+    if (!valid) {
+	compute(data);
+    }
+    return strain_rate;
+}
+
+void invalidate() { valid = false; }
+
+} // namespace velocity_gradient
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "data.h"
+#include <vector>
+
+// Strain rate of the gas velocity, computed once and shared by compression
+// heating, artificial viscosity and the viscous stress tensor.
+
+namespace velocity_gradient
+{
+
+struct t_strain_rate {
+    unsigned int Nrad;
+    unsigned int Nsec;
+
+    // cell centered: div(v), d(v_r)/dr and 1/r d(v_phi)/dphi + v_r/r
+    std::vector<double> div_v;
+    std::vector<double> eps_rr;
+    std::vector<double> eps_pp;
+    // cell corner (Rinf, phi_min): r d(v_phi/r)/dr + 1/r d(v_r)/dphi,
+    // defined for nr >= 1
+    std::vector<double> eps_rp;
+
+    inline unsigned int id(const unsigned int nr, const unsigned int naz) const
+    {
+	return nr * Nsec + naz;
+    }
+};
+
+const t_strain_rate &get(t_data &data);
+void invalidate();
+
+} // namespace velocity_gradient
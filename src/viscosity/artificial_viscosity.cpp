@@ -4,6 +4,7 @@
 #include "../global.h"
 #include "../SourceEuler.h"
 #include "../quantities.h"
+#include "../velocity_gradient.h"
 #include <cassert>
 
 namespace art_visc{
@@ -45,16 +46,17 @@ void update_with_artificial_viscosity_TW(t_data &data, const double dt)
 	const unsigned int Nr = density.get_size_radial();
 	const unsigned int Nphi = density.get_size_azimuthal();
 
+	const velocity_gradient::t_strain_rate &strain_rate =
+		velocity_gradient::get(data);
+
 	// calculate div(v)
 	#pragma omp parallel for collapse(2)
 	for (unsigned int nr = 0; nr < Nr; ++nr) {
 	for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		const double naz_next = naz == vazi.get_max_azimuthal() ? 0 : naz + 1;
-
 		// div(v) = 1/r d(r v_r)/dr + 1/r d(v_phi)/dphi
 		//  	 == d(v_r)/dr + 1/r [ d(v_phi)/dphi + v_r]
-		const double eps_rr = (vr(nr+1, naz) - vr(nr, naz)) * InvDiffRsup[nr];
-		const double eps_pp =  InvRb[nr] * ((vazi(nr, naz_next) - vazi(nr, naz)) * invdphi + 0.5*(vr(nr + 1, naz) + vr(nr, naz)));
+		const double eps_rr = strain_rate.eps_rr[strain_rate.id(nr, naz)];
+		const double eps_pp = strain_rate.eps_pp[strain_rate.id(nr, naz)];
 
 		const double div_V =  std::min(eps_rr + eps_pp, 0.0);
 
@@ -87,34 +89,37 @@ void update_with_artificial_viscosity_TW(t_data &data, const double dt)
 	}
 	}
 
-	#pragma omp parallel for collapse(2)
-	for (unsigned int nr = 1; nr < Nr-1; ++nr) {
-	for (unsigned int naz = 0; naz < Nphi; ++naz) {
+	// d(Q_pp)/dphi vanishes for a single azimuthal cell
+	if (!parameters::axisymmetric) {
+		#pragma omp parallel for collapse(2)
+		for (unsigned int nr = 1; nr < Nr-1; ++nr) {
+		for (unsigned int naz = 0; naz < Nphi; ++naz) {
 
-		const int naz_prev = (naz == 0 ? Nphi-1 : naz - 1);
+			const int naz_prev = (naz == 0 ? Nphi-1 : naz - 1);
 
-		const double sigma_phi_avg = 0.5 * (density(nr, naz) + density(nr, naz_prev));
+			const double sigma_phi_avg = 0.5 * (density(nr, naz) + density(nr, naz_prev));
 
-		// See D'Angelo et al. 2002 Nested-grid calculations of disk-planet
-		// interaction It is important to use the conservative form here and
-		// not the one from Fargo / Baruteau. a_phi = 1/(r*Sigma) ( 1/r
-		// d(r^2 * tau_r_phi)/dr + d(tau_phi_phi)/dphi )
+			// See D'Angelo et al. 2002 Nested-grid calculations of disk-planet
+			// interaction It is important to use the conservative form here and
+			// not the one from Fargo / Baruteau. a_phi = 1/(r*Sigma) ( 1/r
+			// d(r^2 * tau_r_phi)/dr + d(tau_phi_phi)/dphi )
 
 
-		// dVp / dt = 1/rho 1/r w_q
-		// w_q = dQ_pp / d phi
-		/*double dVp =
-		dt / (Rmed[nr] * sigma_phi_avg) *
-		(Q_pp(nr, naz) - Q_pp(nr, naz_prev)) * invdphi;*/
+			// dVp / dt = 1/rho 1/r w_q
+			// w_q = dQ_pp / d phi
+			/*double dVp =
+			dt / (Rmed[nr] * sigma_phi_avg) *
+			(Q_pp(nr, naz) - Q_pp(nr, naz_prev)) * invdphi;*/
 
 
-		// Conservative volume integral formulation
-		double dVp =
-		2.0 * dt / ((Rsup[nr] + Rinf[nr]) * sigma_phi_avg) *
-		(Q_pp(nr, naz) - Q_pp(nr, naz_prev)) * invdphi;
+			// Conservative volume integral formulation
+			double dVp =
+			2.0 * dt / ((Rsup[nr] + Rinf[nr]) * sigma_phi_avg) *
+			(Q_pp(nr, naz) - Q_pp(nr, naz_prev)) * invdphi;
 
-		vazi(nr, naz) += dVp;
-	}}
+			vazi(nr, naz) += dVp;
+		}}
+	}
 
 	#pragma omp parallel for collapse(2)
 	for (unsigned int nr = One_no_ghost_vr; nr < MaxMo_no_ghost_vr; ++nr) {
@@ -137,6 +142,8 @@ void update_with_artificial_viscosity_TW(t_data &data, const double dt)
 		vr(nr, naz) += dVr;
 	}
 	}
+
+	velocity_gradient::invalidate();
 }
 
 /**
@@ -246,6 +253,8 @@ void update_with_artificial_viscosity_SN(t_data &data, const double dt)
 			(Qphi(nr, naz) - Qphi(nr, naz_prev)) * invdxtheta;
 		}
 	}
+
+	velocity_gradient::invalidate();
 	}
 }
 
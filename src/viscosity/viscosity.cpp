@@ -20,6 +20,7 @@
 #include "../util.h"
 #include "../pvte_law.h"
 #include "../quantities.h"
+#include "../velocity_gradient.h"
 #include "../constants.h"
 #include "viscosity.h"
 #include <cassert>
@@ -142,93 +143,43 @@ void compute_viscous_stress_tensor(t_data &data)
 	const unsigned int Nr = data[t_data::DIV_V].get_size_radial();
 	const unsigned int Nphi = data[t_data::DIV_V].get_size_azimuthal();
 
+	const velocity_gradient::t_strain_rate &strain_rate =
+		velocity_gradient::get(data);
+
 	#pragma omp parallel
 	{
-    // calculate div(v)
-	#pragma omp for collapse(2)
-	for (unsigned int nr = 0; nr < Nr ; ++nr) {
+    // calculate div(v), tau_r_r and tau_phi_phi
+	#pragma omp for collapse(2) nowait
+	for (unsigned int nr = 0; nr < Nr; ++nr) {
 	for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		const unsigned int naz_next = (naz == Nphi-1 ? 0 : naz + 1);
+		const unsigned int id = strain_rate.id(nr, naz);
 
 		// div(v) = 1/r d(r*v_r)/dr + 1/r d(v_phi)/dphi
-		data[t_data::DIV_V](nr, naz) =
-		(data[t_data::V_RADIAL](nr+1, naz)*Ra[nr+1] -
-		 data[t_data::V_RADIAL](nr, naz)*Ra[nr])
-				* InvDiffRsupRb[nr] +
-		(data[t_data::V_AZIMUTHAL](nr, naz_next) -
-		 data[t_data::V_AZIMUTHAL](nr, naz)) * invdphi * InvRb[nr];
-	}
-    }
+		const double div_v = strain_rate.div_v[id];
+		data[t_data::DIV_V](nr, naz) = div_v;
 
-    // calculate tau_r_r
-	#pragma omp for collapse(2) nowait
-	for (unsigned int nr = 0; nr < Nr; ++nr) {
-		for (unsigned int naz = 0; naz < Nphi; ++naz) {
-	    // d(v_r)/dr (cell centered)
-	    const double drr =
-		(data[t_data::V_RADIAL](nr + 1, naz) -
-		 data[t_data::V_RADIAL](nr, naz)) *
-		InvDiffRsup[nr];
+		const double nu = data[t_data::VISCOSITY](nr, naz);
+		const double sigma = data[t_data::SIGMA](nr, naz);
 
 		// tau_r_r = 2*nu*Sigma*( d(v_r)/dr - 1/3 div(v))
 		data[t_data::TAU_R_R](nr, naz) =
-		2.0 * data[t_data::VISCOSITY](nr, naz) *
-		data[t_data::SIGMA](nr, naz) *
-		(drr - 1.0 / 3.0 * data[t_data::DIV_V](nr, naz));
-	}
-    }
-
-    // calculate tau_phi_phi
-	#pragma omp for collapse(2) nowait
-	for (unsigned int nr = 0; nr < Nr; ++nr) {
-	for (unsigned int naz = 0; naz < Nphi; ++naz) {
-		const unsigned int naz_next = (naz == Nphi-1 ? 0 : naz + 1);
-
-	    // 1/r d(v_phi)/dphi + v_r/r (cell centered)
-	    const double dpp =
-		(data[t_data::V_AZIMUTHAL](nr, naz_next) -
-		 data[t_data::V_AZIMUTHAL](nr, naz)) *
-			invdphi * InvRmed[nr] +
-		0.5 *
-			(data[t_data::V_RADIAL](nr + 1, naz) +
-			 data[t_data::V_RADIAL](nr, naz)) *
-			InvRmed[nr];
+		2.0 * nu * sigma * (strain_rate.eps_rr[id] - 1.0 / 3.0 * div_v);
 
 	    // tau_phi_phi = 2*nu*Sigma*( 1/r d(v_phi)/dphi + v_r/r - 1/3 div(v)
 	    // )
-		const double nu = data[t_data::VISCOSITY](nr, naz);
-		const double sigma = data[t_data::SIGMA](nr, naz);
 		data[t_data::TAU_PHI_PHI](nr, naz) =
-		2.0 * nu * sigma *
-		(dpp - 1.0 / 3.0 * data[t_data::DIV_V](nr, naz));
+		2.0 * nu * sigma * (strain_rate.eps_pp[id] - 1.0 / 3.0 * div_v);
 
-	    const double correction_helper_value = nu * sigma;
-		data[t_data::VISCOSITY_SIGMA](nr, naz) =
-		correction_helper_value;
+		data[t_data::VISCOSITY_SIGMA](nr, naz) = nu * sigma;
 	}
     }
 
-    // calculate tau_r_phi
-	#pragma omp for collapse(2) nowait
+    // calculate tau_r_phi, the correction factors need all of them
+	#pragma omp for collapse(2)
 	for (unsigned int nr = 1; nr < Nr; ++nr) { // Nr_vec -1 = Nr
 	for (unsigned int naz = 0; naz < Nphi; ++naz) {
 		const double naz_prev = (naz == 0 ? Nphi-1 : naz - 1);
 
-	    // d(v_phi/r)/dr
-	    double dvazirdr =
-		(data[t_data::V_AZIMUTHAL](nr, naz) * InvRb[nr] -
-		 data[t_data::V_AZIMUTHAL](nr - 1, naz) * InvRb[nr - 1]) *
-		InvDiffRmed[nr];
-	    // d(v_r)/dphi
-	    double dvrdphi =
-		(data[t_data::V_RADIAL](nr, naz) -
-		 data[t_data::V_RADIAL](nr, naz_prev)) *
-		invdphi;
-
-	    // r*d(v_phi/r)/dr + 1/r d(v_r)/dphi (edge)
-	    const double drp =
-		Ra[nr] * dvazirdr + dvrdphi * InvRa[nr];
-
 	    // averaged nu over 4 corresponding cells
 	    const double nu =
 		0.25 *
@@ -245,7 +196,8 @@ void compute_viscous_stress_tensor(t_data &data)
 			data[t_data::SIGMA](nr - 1, naz_prev));
 
 	    // tau_r_phi = nu*Sigma*( r*d(v_phi/r)/dr + 1/r d(v_r)/dphi )
-		data[t_data::TAU_R_PHI](nr, naz) = nu * sigma * drp;
+		data[t_data::TAU_R_PHI](nr, naz) =
+		nu * sigma * strain_rate.eps_rp[strain_rate.id(nr, naz)];
 
 	    const double correction_helper_value = nu * sigma;
 		data[t_data::VISCOSITY_SIGMA_RP](nr, naz) =
@@ -420,6 +372,8 @@ void update_velocities_with_viscosity(t_data &data, const double dt)
 	}
     }
 
+	velocity_gradient::invalidate();
+
 	if(ECC_GROWTH_MONITOR){
 		quantities::calculate_disk_delta_ecc_peri(data, delta_ecc_visc, delta_peri_visc);
 	}
@@ -11,7 +11,8 @@ import yaml
 def main():
 
     test_name = "FLD1D"
-    success = calc_deviation("../../output/tests/FLD1D/out")
+    success = calc_deviation("../../output/tests/FLD1D/out",
+                             "../../output/tests/FLD1D/out_axisymmetric")
 
     if success:
         print(f"SUCCESS: {test_name}")
@@ -21,7 +22,7 @@ def main():
 
 
 
-def calc_deviation(outdir):
+def calc_deviation(outdir, outdir_axisymmetric):
 
     data = load_data(outdir)
 
@@ -36,13 +37,27 @@ def calc_deviation(outdir):
     deltaT = data.Tprofiles[Nlast] / theo.T - 1
     dev = np.max(np.abs(deltaT[data.rc < 9.5]))
 
-    success = dev < 0.1
+    # The Naz = 1 run uses the direct tridiagonal solver instead of SOR.
+    # Both must match the analytic profile and each other in every snapshot.
+    # Observed maximum relative difference between the two is 2.6e-8,
+    # limited by the SOR tolerance; the threshold leaves a margin of ~40.
+    data_axi = load_data(outdir_axisymmetric)
+    deltaT_axi = data_axi.Tprofiles[Nlast] / theo.T - 1
+    dev_axi = np.max(np.abs(deltaT_axi[data.rc < 9.5]))
+
+    dev_solvers = max(np.max(np.abs(data_axi.Tprofiles[n] / data.Tprofiles[n] - 1))
+                      for n in data.Ns)
+    threshold_solvers = 1e-6
+
+    success = dev < 0.1 and dev_axi < 0.1 and dev_solvers < threshold_solvers
 
     with open("test.log", "w") as f:
         from datetime import datetime
         current_time = datetime.now().strftime("%Y-%m-%d %H:%M:%S")
         print(f"{current_time}", file=f)
         print(f"max deviation = {dev}, theshold = 0.1", file=f)
+        print(f"max deviation Naz = 1 = {dev_axi}, theshold = 0.1", file=f)
+        print(f"max deviation tridiagonal vs SOR = {dev_solvers}, theshold = {threshold_solvers}", file=f)
 
     return success
 
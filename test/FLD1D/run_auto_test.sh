@@ -4,5 +4,6 @@ FILEDIR="$(dirname $(realpath $0))"
 cd $FILEDIR
 
 ../../run_fargo -nt 2 -np 1 start setup.yml 1> out.log 2>err.log
+../../run_fargo -nt 2 -np 1 start setup_axisymmetric.yml 1>> out.log 2>>err.log
 ./calc_deviation.py
 ./plot_overview.py ../../output/tests/FLD1D/out overview.jpg
@@ -0,0 +1,83 @@
+import os
+import yaml
+import numpy as np
+import matplotlib.pyplot as plt
+from fargocpt import Loader
+
+
+def get_gr(output_dir):
+    """ Azimuthally averaged radial self-gravity acceleration of the first snapshot. """
+    ld = Loader(output_dir)
+    r, gr = ld.gas.vars2D.avg("a_sg_rad", 0)
+    return r.to_value("au"), gr.to_value("cm/s2")
+
+
+def max_deviation(gr, gr_ref):
+    """ Maximum absolute difference relative to the maximum of the reference. """
+    return np.max(np.abs(gr - gr_ref)) / np.max(np.abs(gr_ref))
+
+
+def test(output_dir):
+
+    r_polar, gr_polar = get_gr(os.path.join(output_dir, "polar"))
+    r_modal, gr_modal = get_gr(os.path.join(output_dir, "modal"))
+    r_arith, gr_arith = get_gr(os.path.join(output_dir, "modal_arithmetic"))
+
+    # same logarithmic grid, both solvers use the same kernel
+    diff_same = max_deviation(gr_modal, gr_polar)
+
+    with open("testconfig.yml", "r") as f:
+        testconfig = yaml.safe_load(f)
+
+    # arithmetic grid, compare inside the range covered by both grids and
+    # outside the inner edge, which the arithmetic grid does not resolve
+    rmin_arith = max(r_polar[0], testconfig["rmin_arithmetic"])
+    inside = np.logical_and(r_arith >= rmin_arith, r_arith <= r_polar[-1])
+    gr_polar_interp = np.interp(np.log(r_arith[inside]), np.log(r_polar), gr_polar)
+    diff_arith = max_deviation(gr_arith[inside], gr_polar_interp)
+
+    fig, axs = plt.subplots(2,1,height_ratios=[3,1], sharex=True, figsize=(6,4))
+    fig.subplots_adjust(hspace=0)
+    ax = axs[0]
+    ax.plot(r_polar, gr_polar, label="polar (log grid)", lw=2)
+    ax.plot(r_modal, gr_modal, ls="--", label="modal (log grid)", lw=2)
+    ax.plot(r_arith, gr_arith, ls=":", label="modal (arithmetic grid)", lw=2)
+    ax.set_ylabel("$g_r$ [cm/s2]")
+    ax.legend()
+    ax.axhline(0.0, ls="-", lw=1, color="k", alpha=0.5, zorder=0)
+
+    ax = axs[1]
+    norm = np.max(np.abs(gr_polar))
+    ax.plot(r_modal, np.abs(gr_modal - gr_polar) / norm, label="modal log", ls="-")
+    ax.plot(r_arith[inside], np.abs(gr_arith[inside] - gr_polar_interp) / norm,
+            label="modal arithmetic", ls="-")
+    ax.set_yscale("log")
+    ax.set_xlabel("r [au]")
+    ax.set_ylabel("difference")
+    ax.legend()
+
+    fig.savefig("plot.jpg", dpi=150, bbox_inches="tight")
+
+    testname = testconfig["testname"]
+    threshold_same = testconfig["threshold_same_grid"]
+    threshold_arith = testconfig["threshold_arithmetic"]
+
+    pass_test = diff_same < threshold_same and diff_arith < threshold_arith
+
+    with open("test.log", "w") as f:
+        print(f"Test name: {testname}", file=f)
+        print(f"Max diff modal - polar, logarithmic grid = {diff_same:.2e}", file=f)
+        print(f"Threshold: {threshold_same}", file=f)
+        print(f"Max diff modal arithmetic grid - polar = {diff_arith:.2e}", file=f)
+        print(f"Threshold: {threshold_arith}", file=f)
+        print(f"Pass test: {pass_test}", file=f)
+
+    if pass_test:
+        print(f"SUCCESS: {testname}")
+    else:
+        print(f"FAIL: {testname}")
+
+
+if __name__=="__main__":
+    output_dir = "../../output/tests/self_gravity_modal/out"
+    test(output_dir)
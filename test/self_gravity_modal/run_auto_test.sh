@@ -0,0 +1,3 @@
+#!/usr/bin/env bash
+cd $(dirname $0)
+python3 ../run_test.py --silent
\ No newline at end of file
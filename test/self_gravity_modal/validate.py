@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+""" Standalone validation of the modal self-gravity solver.
+
+Runs the three setups of this test and prints the deviations of the modal
+solver from the polar FFT solver, using the same definitions as
+check_results.py. Only needs numpy and yaml, so it can be used to
+(re)calibrate the thresholds in testconfig.yml without the fargocpt python
+module. The thresholds there are the observed deviations times a margin.
+"""
+
+import os
+import subprocess
+from argparse import ArgumentParser
+
+import numpy as np
+import yaml
+
+setups = ["polar", "modal", "modal_arithmetic"]
+output_dir = "../../output/tests/self_gravity_modal/out"
+
+
+def run(setup, Nthreads, Nprocs):
+    cmd = ["../../run_fargo", "-nt", str(Nthreads), "-np", str(Nprocs),
+           "start", f"setup_{setup}.yml"]
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+
+
+def get_gr(outdir):
+    """ Azimuthally averaged radial self-gravity acceleration of the first snapshot. """
+    with open(os.path.join(outdir, "info2D.yml"), "r") as f:
+        info = yaml.safe_load(f)["a_sg_rad"]
+    ri = np.genfromtxt(os.path.join(outdir, "used_rad.dat"))
+    # approximate center in polar coords, as in the fargocpt Loader
+    rc = 2/3*(ri[1:]**2/(ri[1:]+ri[:-1]) + ri[:-1])
+    gr = np.fromfile(os.path.join(outdir, "snapshots", "0", info["filename"]),
+                     dtype=np.float64).reshape(info["Nrad"], info["Nazi"])
+    return rc, info["code_to_cgs_factor"]*np.average(gr, axis=1)
+
+
+def max_deviation(gr, gr_ref):
+    """ Maximum absolute difference relative to the maximum of the reference. """
+    return np.max(np.abs(gr - gr_ref)) / np.max(np.abs(gr_ref))
+
+
+def main():
+    parser = ArgumentParser()
+    parser.add_argument("-nt", type=int, default=2, help="Number of OpenMP threads")
+    parser.add_argument("-np", type=int, default=1, help="Number of MPI processes")
+    parser.add_argument("--no-run", action="store_true",
+                        help="Only evaluate existing output")
+    opts = parser.parse_args()
+
+    os.chdir(os.path.dirname(os.path.realpath(__file__)))
+
+    if not opts.no_run:
+        for setup in setups:
+            run(setup, opts.nt, opts.np)
+
+    r_polar, gr_polar = get_gr(os.path.join(output_dir, "polar"))
+    r_modal, gr_modal = get_gr(os.path.join(output_dir, "modal"))
+    r_arith, gr_arith = get_gr(os.path.join(output_dir, "modal_arithmetic"))
+
+    with open("testconfig.yml", "r") as f:
+        testconfig = yaml.safe_load(f)
+
+    diff_same = max_deviation(gr_modal, gr_polar)
+
+    rmin_arith = max(r_polar[0], testconfig["rmin_arithmetic"])
+    inside = np.logical_and(r_arith >= rmin_arith, r_arith <= r_polar[-1])
+    gr_polar_interp = np.interp(np.log(r_arith[inside]), np.log(r_polar), gr_polar)
+    diff_arith = max_deviation(gr_arith[inside], gr_polar_interp)
+
+    threshold_same = testconfig["threshold_same_grid"]
+    threshold_arith = testconfig["threshold_arithmetic"]
+    print(f"Max diff modal - polar, logarithmic grid = {diff_same:.2e}, "
+          f"threshold = {threshold_same}, margin = {threshold_same/diff_same:.1f}")
+    print(f"Max diff modal arithmetic grid - polar = {diff_arith:.2e}, "
+          f"threshold = {threshold_arith}, margin = {threshold_arith/diff_arith:.1f}")
+
+
+if __name__ == "__main__":
+    main()